@@ -0,0 +1,34 @@
+#include <algorithm>    // for std::fill_n, std::max, std::min
+
+#include "AggregateSizeTuner.hpp"
+#include "utility/memory.hpp"
+
+namespace warped {
+
+AggregateSizeTuner::AggregateSizeTuner(unsigned int max_size, bool is_adaptive) :
+    max_size_(std::max(1u, max_size)), is_adaptive_(is_adaptive) {}
+
+void AggregateSizeTuner::initialize(unsigned int num_receivers) {
+    size_by_receiver_ = make_unique<unsigned int []>(num_receivers);
+    std::fill_n(size_by_receiver_.get(), num_receivers, max_size_);
+}
+
+void AggregateSizeTuner::aggregateFilled(unsigned int receiver_id) {
+    if (is_adaptive_ && (size_by_receiver_[receiver_id] < max_size_)) {
+        size_by_receiver_[receiver_id]++;
+    }
+}
+
+void AggregateSizeTuner::aggregateExpired(unsigned int receiver_id, unsigned int num_messages) {
+    if (is_adaptive_) {
+        size_by_receiver_[receiver_id] = std::max(1u, std::min(num_messages, max_size_));
+    }
+}
+
+void AggregateSizeTuner::stragglersReported(unsigned int receiver_id) {
+    if (is_adaptive_) {
+        size_by_receiver_[receiver_id] = std::max(1u, size_by_receiver_[receiver_id] / 2);
+    }
+}
+
+} // namespace warped
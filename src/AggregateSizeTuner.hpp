@@ -0,0 +1,48 @@
+#ifndef AGGREGATE_SIZE_TUNER_HPP
+#define AGGREGATE_SIZE_TUNER_HPP
+
+/* Aggregate Size Tuner
+ *
+ * Number of event messages aggregated for each receiving node before they are sent. With
+ * adaptive aggregation the size is tuned separately for each receiver between 1 and the
+ * largest size. It grows by one whenever an aggregate fills up, is cut to the number of
+ * messages gathered whenever an aggregate is sent because it was held too long, and is halved
+ * whenever the receiver reports rollbacks caused by our events. A static size stays at the
+ * largest size.
+ *
+ * Only used by the thread which sends and receives the messages, so it is not thread safe.
+ */
+
+#include <memory>
+
+namespace warped {
+
+class AggregateSizeTuner {
+public:
+    AggregateSizeTuner(unsigned int max_size = 1, bool is_adaptive = false);
+
+    void initialize(unsigned int num_receivers);
+
+    bool isAdaptive() const { return is_adaptive_; }
+
+    unsigned int size(unsigned int receiver_id) const { return size_by_receiver_[receiver_id]; }
+
+    // An aggregate for the receiver has reached its size
+    void aggregateFilled(unsigned int receiver_id);
+
+    // An aggregate for the receiver with num_messages messages was held for too long
+    void aggregateExpired(unsigned int receiver_id, unsigned int num_messages);
+
+    // The receiver reported rollbacks caused by events in the aggregates sent to it
+    void stragglersReported(unsigned int receiver_id);
+
+private:
+    const unsigned int max_size_;
+    const bool is_adaptive_;
+
+    std::unique_ptr<unsigned int []> size_by_receiver_;
+};
+
+} // namespace warped
+
+#endif
@@ -25,17 +25,23 @@
 #include "ProfileGuidedPartitioner.hpp"
 #include "RoundRobinPartitioner.hpp"
 #include "SequentialEventDispatcher.hpp"
+#include "TimeWarpAllReduceGVTManager.hpp"
 #include "TimeWarpAsynchronousGVTManager.hpp"
 #include "TimeWarpSynchronousGVTManager.hpp"
 #include "TimeWarpEventDispatcher.hpp"
 #include "utility/memory.hpp"
 #include "TimeWarpMPICommunicationManager.hpp"
 #include "TimeWarpPeriodicStateManager.hpp"
+#include "TimeWarpIncrementalStateManager.hpp"
 #include "TimeWarpAggressiveOutputManager.hpp"
+#include "TimeWarpDynamicOutputManager.hpp"
+#include "TimeWarpLazyOutputManager.hpp"
 #include "TimeWarpFileStreamManager.hpp"
 #include "TimeWarpEventSet.hpp"
 #include "TimeWarpTerminationManager.hpp"
 #include "TimeWarpStatistics.hpp"
+#include "ThreadAffinity.hpp"
+#include "OptimismThrottle.hpp"
 
 namespace {
 const static std::string DEFAULT_CONFIG = R"x({
@@ -56,20 +62,69 @@ const static std::string DEFAULT_CONFIG = R"x({
 
 "time-warp" : {
     "gvt-calculation": {
-        // GVT calculation period
+        // GVT calculation period in milliseconds
         "period": 1000,
-        // "synchronous" or "asynchronous"
+        // Tune the period at run time, starting from "period": it is halved after a GVT
+        // calculation under pressure from the limits below, and grows while the events
+        // processed are mostly committed
+        "adaptive": false,
+        // Range of the period in adaptive mode. A calculation is never started early before
+        // "min-period" has elapsed.
+        "min-period": 10,
+        "max-period": 10000,
+        // Start a calculation early once a node has this many processed events which are
+        // not committed, 0 for no limit
+        "max-uncommitted-events": 0,
+        // Start a calculation early once a node has this many MB of heap in use, 0 for no
+        // limit
+        "max-memory": 0,
+        // "synchronous", "asynchronous" or "allreduce". "allreduce" is asynchronous like
+        // "asynchronous", but combines the node values with non-blocking reductions instead
+        // of a token passed around all nodes, which takes less time with many nodes.
         "method": "asynchronous"
     },
 
     "state-saving": {
-        // State saving type, default "periodic"
+        // State saving type, "periodic" (default) or "incremental". "incremental"
+        // saves only the changed bytes of states that provide
+        // LPState::incrementalStateData, and full copies of all other states.
         "type": "periodic",
         // State saving period
-        "period": 10
+        "period": 10,
+        // Tune the period of each LP at run time from its measured rollback,
+        // coast forward and state saving costs, starting from "period"
+        "adaptive": false,
+        // Largest period used in adaptive mode
+        "max-period": 100
     },
 
-    // Cancellation type, default "aggressive"
+    "optimism": {
+        // Largest distance above the GVT of the events the worker threads process, in
+        // simulation time. Events further ahead are held back until the GVT advances. 0 for
+        // no limit.
+        "time-window": 0,
+        // Tune the window of each worker thread at run time, starting from "time-window":
+        // it is halved while most of the events processed are rolled back and doubled while
+        // few are
+        "adaptive": false,
+        // Range of the window in adaptive mode, 0 for no upper limit
+        "min-window": 1,
+        "max-window": 0
+    },
+
+    "fossil-collection": {
+        // "inline" (default) collects the queues of an LP after each of its events once the
+        // GVT has advanced. "batched" has each worker thread collect a batch of its share of
+        // the LPs between events, including LPs which receive no events.
+        "mode": "inline",
+        // Number of LPs collected per batch in "batched" mode
+        "batch-size": 4
+    },
+
+    // Cancellation type, "aggressive" (default), "lazy" or "dynamic". "lazy"
+    // holds back the events sent after a straggler and cancels only those that
+    // are not sent again when the events are processed again. "dynamic"
+    // switches each LP between the two from its measured hit ratio.
     "cancellation": "aggressive",
 
     // Number of Worker Threads
@@ -78,20 +133,51 @@ const static std::string DEFAULT_CONFIG = R"x({
     // Number of Schedule Queues
     "scheduler-count": 1,
 
+    "scheduler": {
+        // Schedule queue type, valid options are "multiset", "ladder-queue",
+        // "partially-sorted-ladder-queue", "splay-tree", "circular-queue" and
+        // "multi-queue". "multi-queue" needs no lock and is meant for a single
+        // scheduler shared by all worker threads.
+        "queue": "multiset",
+        // Where an idle worker thread steals events from when its own schedule
+        // queue is empty: "none", "neighbor" or "random"
+        "work-stealing": "none"
+    },
+
+    // Pinning of worker threads: "none", "core" or "numa-node". Each schedule
+    // queue is mapped to a NUMA node and its worker threads are pinned to one
+    // core ("core") or to any core ("numa-node") of that node. Use at least as
+    // many schedule queues as NUMA nodes to spread the threads over all nodes.
+    "thread-affinity": "none",
+
     // LP Migration valid options are "on" and "off"
     "lp-migration": "off",
 
-    // Name of file to dump stats, "none" to disable
+    // Name of file to dump stats, "none" to disable. With lazy or dynamic cancellation, the
+    // cancellation of each lp is written to this name with ".lps" appended.
     "statistics-file" : "none",
 
     // Name of the config output file
     "config-output-file" : "none",
 
     "communication" : {
-        // Max message size
+        // Expected message size. Send buffers start at this size times the max
+        // aggregation count and grow for larger aggregates.
         "max-msg-size" : 512,
         // Max message aggregation count
-        "max-aggregate" : 5
+        "max-aggregate" : 5,
+        // Valid options are "static" and "adaptive". Adaptive aggregation tunes
+        // the number of messages aggregated for each node between 1 and
+        // max-aggregate from the message rate and the rollbacks they cause.
+        "aggregation" : "static",
+        // Longest time a message is held for aggregation in microseconds, 0
+        // for no limit
+        "max-aggregation-delay" : 1000,
+        // Thread which sends and receives messages: "master" or "dedicated".
+        // A dedicated thread takes the messages of all threads without a
+        // lock and inserts received events itself, leaving the master thread
+        // only the GVT and termination messages.
+        "thread" : "master"
     }
 },
 
@@ -231,8 +317,6 @@ Configuration::makeDispatcher(std::shared_ptr<TimeWarpCommunicationManager> comm
             invalid_string += std::string("\tSimulation type\n");
         }
 
-        std::unique_ptr<TimeWarpEventSet> event_set = make_unique<TimeWarpEventSet>();
-
         // WORKER THREADS
         int num_worker_threads = (*root_)["time-warp"]["worker-threads"].asInt();
         if (!checkTimeWarpConfigs(num_worker_threads, all_config_ids, comm_manager)) {
@@ -245,6 +329,39 @@ Configuration::makeDispatcher(std::shared_ptr<TimeWarpCommunicationManager> comm
             invalid_string += std::string("\tNumber of schedule queues\n");
         }
 
+        // SCHEDULE QUEUE TYPE
+        auto schedule_queue_name = (*root_)["time-warp"]["scheduler"]["queue"].asString();
+        ScheduleQueueType schedule_queue_type = ScheduleQueueType::MultiSet;
+        if (!scheduleQueueTypeFromString(schedule_queue_name, schedule_queue_type)) {
+            invalid_string += std::string("\tInvalid schedule queue type\n");
+        }
+        local_config_id = static_cast<uint64_t>(schedule_queue_type);
+        if (!checkTimeWarpConfigs(local_config_id, all_config_ids, comm_manager)) {
+            invalid_string += std::string("\tSchedule queue type\n");
+        }
+
+        // WORK STEALING
+        auto work_stealing_name =
+            (*root_)["time-warp"]["scheduler"]["work-stealing"].asString();
+        WorkStealingPolicy work_stealing_policy = WorkStealingPolicy::None;
+        if (!workStealingPolicyFromString(work_stealing_name, work_stealing_policy)) {
+            invalid_string += std::string("\tInvalid work stealing policy\n");
+        }
+        local_config_id = static_cast<uint64_t>(work_stealing_policy);
+        if (!checkTimeWarpConfigs(local_config_id, all_config_ids, comm_manager)) {
+            invalid_string += std::string("\tWork stealing policy\n");
+        }
+
+        // THREAD AFFINITY
+        auto thread_affinity_name = (*root_)["time-warp"]["thread-affinity"].asString();
+        ThreadAffinityPolicy thread_affinity_policy = ThreadAffinityPolicy::None;
+        if (!threadAffinityPolicyFromString(thread_affinity_name, thread_affinity_policy)) {
+            invalid_string += std::string("\tInvalid thread affinity\n");
+        }
+
+        std::unique_ptr<TimeWarpEventSet> event_set =
+            make_unique<TimeWarpEventSet>(schedule_queue_type, work_stealing_policy);
+
         // LP MIGRATION
         auto lp_migration_status = (*root_)["time-warp"]["lp-migration"].asString();
         if (lp_migration_status == "off") {
@@ -259,6 +376,18 @@ Configuration::makeDispatcher(std::shared_ptr<TimeWarpCommunicationManager> comm
         std::unique_ptr<TimeWarpStateManager> state_manager;
         int state_period = 0;
         auto state_saving_type = (*root_)["time-warp"]["state-saving"]["type"].asString();
+
+        bool is_state_period_adaptive = (*root_)["time-warp"]["state-saving"]["adaptive"].asBool();
+        local_config_id = is_state_period_adaptive ? 1 : 0;
+        if (!checkTimeWarpConfigs(local_config_id, all_config_ids, comm_manager)) {
+            invalid_string += std::string("\tAdaptive state saving period\n");
+        }
+
+        unsigned int max_state_period =
+            (*root_)["time-warp"]["state-saving"]["max-period"].asUInt();
+        if (is_state_period_adaptive && (max_state_period == 0)) {
+            invalid_string += std::string("\tInvalid maximum state saving period\n");
+        }
         if (state_saving_type == "periodic") {
             // local_config_id == 0 for periodic
             local_config_id = 0;
@@ -271,7 +400,24 @@ Configuration::makeDispatcher(std::shared_ptr<TimeWarpCommunicationManager> comm
                 invalid_string += std::string("\tState saving period\n");
             }
 
-            state_manager = make_unique<TimeWarpPeriodicStateManager>(state_period);
+            state_manager = make_unique<TimeWarpPeriodicStateManager>(state_period,
+                is_state_period_adaptive, max_state_period);
+        } else if (state_saving_type == "incremental") {
+            // local_config_id == 1 for incremental
+            local_config_id = 1;
+            if (!checkTimeWarpConfigs(local_config_id, all_config_ids, comm_manager)) {
+                invalid_string += std::string("\tState-saving type\n");
+            }
+
+            state_period = (*root_)["time-warp"]["state-saving"]["period"].asInt();
+            if (!checkTimeWarpConfigs(state_period, all_config_ids, comm_manager)) {
+                invalid_string += std::string("\tState saving period\n");
+            }
+
+            state_manager = make_unique<TimeWarpIncrementalStateManager>(state_period,
+                is_state_period_adaptive, max_state_period);
+        } else {
+            invalid_string += std::string("\tInvalid state-saving type\n");
         }
 
         // OUTPUT MANAGER
@@ -284,14 +430,45 @@ Configuration::makeDispatcher(std::shared_ptr<TimeWarpCommunicationManager> comm
                 invalid_string += std::string("\tCancellation type\n");
             }
             output_manager = make_unique<TimeWarpAggressiveOutputManager>();
+        } else if (cancellation_type == "lazy") {
+            // local_config_id == 1 for lazy
+            local_config_id = 1;
+            if (!checkTimeWarpConfigs(local_config_id, all_config_ids, comm_manager)) {
+                invalid_string += std::string("\tCancellation type\n");
+            }
+            output_manager = make_unique<TimeWarpLazyOutputManager>();
+        } else if (cancellation_type == "dynamic") {
+            // local_config_id == 2 for dynamic
+            local_config_id = 2;
+            if (!checkTimeWarpConfigs(local_config_id, all_config_ids, comm_manager)) {
+                invalid_string += std::string("\tCancellation type\n");
+            }
+            output_manager = make_unique<TimeWarpDynamicOutputManager>();
+        } else {
+            invalid_string += std::string("\tInvalid cancellation type\n");
         }
 
         // GVT
-        unsigned int gvt_period = (*root_)["time-warp"]["gvt-calculation"]["period"].asUInt();
+        auto& gvt_config = (*root_)["time-warp"]["gvt-calculation"];
+        unsigned int gvt_period = gvt_config["period"].asUInt();
         if (!checkTimeWarpConfigs(gvt_period, all_config_ids, comm_manager)) {
             invalid_string += std::string("\tGVT period\n");
         }
 
+        bool is_gvt_period_adaptive = gvt_config["adaptive"].asBool();
+        local_config_id = is_gvt_period_adaptive ? 1 : 0;
+        if (!checkTimeWarpConfigs(local_config_id, all_config_ids, comm_manager)) {
+            invalid_string += std::string("\tAdaptive GVT period\n");
+        }
+        unsigned int min_gvt_period = gvt_config["min-period"].asUInt();
+        unsigned int max_gvt_period = gvt_config["max-period"].asUInt();
+        if (is_gvt_period_adaptive &&
+                ((min_gvt_period > gvt_period) || (gvt_period > max_gvt_period))) {
+            invalid_string += std::string("\tInvalid GVT period range\n");
+        }
+        uint64_t max_uncommitted_events = gvt_config["max-uncommitted-events"].asUInt64();
+        uint64_t max_memory = gvt_config["max-memory"].asUInt64() * 1024 * 1024;
+
         std::unique_ptr<TimeWarpGVTManager> gvt_manager;
         auto gvt_method = (*root_)["time-warp"]["gvt-calculation"]["method"].asString();
         if (gvt_method == "synchronous") {
@@ -300,9 +477,44 @@ Configuration::makeDispatcher(std::shared_ptr<TimeWarpCommunicationManager> comm
         } else if (gvt_method == "asynchronous") {
             gvt_manager =
                 make_unique<TimeWarpAsynchronousGVTManager>(comm_manager, gvt_period, num_worker_threads);
+        } else if (gvt_method == "allreduce") {
+            gvt_manager =
+                make_unique<TimeWarpAllReduceGVTManager>(comm_manager, gvt_period, num_worker_threads);
         } else {
             invalid_string += std::string("\tInvalid GVT Method\n");
         }
+        if (gvt_manager) {
+            gvt_manager->setPeriodPolicy(is_gvt_period_adaptive, min_gvt_period, max_gvt_period,
+                max_uncommitted_events, max_memory);
+        }
+
+        // OPTIMISM
+        auto& optimism_config = (*root_)["time-warp"]["optimism"];
+        unsigned int time_window = optimism_config["time-window"].asUInt();
+        if (!checkTimeWarpConfigs(time_window, all_config_ids, comm_manager)) {
+            invalid_string += std::string("\tTime window\n");
+        }
+        bool is_time_window_adaptive = optimism_config["adaptive"].asBool();
+        unsigned int min_time_window = optimism_config["min-window"].asUInt();
+        unsigned int max_time_window = optimism_config["max-window"].asUInt();
+        if (is_time_window_adaptive && (time_window != 0) && ((min_time_window > time_window) ||
+                ((max_time_window != 0) && (time_window > max_time_window)))) {
+            invalid_string += std::string("\tInvalid time window range\n");
+        }
+        OptimismThrottle optimism_throttle(time_window, is_time_window_adaptive,
+            min_time_window, max_time_window);
+
+        // FOSSIL COLLECTION
+        auto& fossil_config = (*root_)["time-warp"]["fossil-collection"];
+        auto fossil_collection_mode = fossil_config["mode"].asString();
+        if (fossil_collection_mode != "inline" && fossil_collection_mode != "batched") {
+            invalid_string += std::string("\tInvalid fossil collection mode\n");
+        }
+        bool is_fossil_collection_batched = (fossil_collection_mode == "batched");
+        unsigned int fossil_batch_size = fossil_config["batch-size"].asUInt();
+        if (is_fossil_collection_batched && (fossil_batch_size == 0)) {
+            invalid_string += std::string("\tInvalid fossil collection batch size\n");
+        }
 
         // TERMINATION
         std::unique_ptr<TimeWarpTerminationManager> termination_manager =
@@ -337,18 +549,9 @@ check the following configurations:\n") + invalid_string);
                       << "Number of worker threads:  " << num_worker_threads << "\n"
                       << "Number of Schedule queues: " << num_schedulers << "\n";
 
-            std::cout << "Type of Schedule queue:    ";
-#ifdef SORTED_LADDER_QUEUE
-            std::cout << "Sorted Ladder Queue\n";
-#elif defined(PARTIALLY_SORTED_LADDER_QUEUE)
-            std::cout << "Partially Sorted Ladder Queue\n";
-#elif defined(SPLAY_TREE)
-            std::cout << "Splay Tree\n";
-#elif defined(CIRCULAR_QUEUE)
-            std::cout << "Circular Queue\n";
-#else
-            std::cout << "MultiSet\n";
-#endif
+            std::cout << "Type of Schedule queue:    " << schedule_queue_name << "\n"
+                      << "Work stealing:             " << work_stealing_name << "\n"
+                      << "Thread affinity:           " << thread_affinity_name << "\n";
 
             std::cout << "Type of Scheduler lock:    ";
 #ifdef SCHEDULE_QUEUE_SPINLOCKS
@@ -359,10 +562,30 @@ check the following configurations:\n") + invalid_string);
 
             std::cout << "LP Migration:              " << lp_migration_status << "\n"
                       << "State-saving type:         " << state_saving_type << "\n";
-            if (state_saving_type == "periodic")
-            std::cout << "State-saving period:       " << state_period << " events" << "\n";
+            if (state_saving_type == "periodic" || state_saving_type == "incremental")
+            std::cout << "State-saving period:       " << state_period << " events"
+                      << (is_state_period_adaptive ?
+                            " (adaptive, max " + std::to_string(max_state_period) + ")" : "")
+                      << "\n";
+            auto& communication = (*root_)["time-warp"]["communication"];
+            std::cout << "Message aggregation:       " << communication["aggregation"].asString()
+                      << " (max " << communication["max-aggregate"].asUInt() << " messages, "
+                      << communication["max-aggregation-delay"].asUInt() << " us)\n"
+                      << "Message thread:            " << communication["thread"].asString()
+                      << "\n";
+            std::cout << "Time window:               "
+                      << (time_window ? std::to_string(time_window) : "infinity")
+                      << ((time_window && is_time_window_adaptive) ? " (adaptive)" : "") << "\n";
+            std::cout << "Fossil collection:         " << fossil_collection_mode
+                      << (is_fossil_collection_batched ?
+                            " (" + std::to_string(fossil_batch_size) + " LPs per batch)" : "")
+                      << "\n";
             std::cout << "Cancellation type:         " << cancellation_type << "\n"
-                      << "GVT Period:                " << gvt_period << " ms" << "\n"
+                      << "GVT Period:                " << gvt_period << " ms"
+                      << (is_gvt_period_adaptive ?
+                            " (adaptive, " + std::to_string(min_gvt_period) + "-" +
+                            std::to_string(max_gvt_period) + " ms)" : "")
+                      << "\n"
                       << "Max simulation time:       " \
                         << (max_sim_time_ ? std::to_string(max_sim_time_) : "infinity") << std::endl << std::endl;
 
@@ -375,7 +598,9 @@ check the following configurations:\n") + invalid_string);
         }
 
         return make_unique<TimeWarpEventDispatcher>(max_sim_time_,
-            num_worker_threads, is_lp_migration_on, comm_manager,
+            num_worker_threads, is_lp_migration_on, thread_affinity_policy,
+            std::move(optimism_throttle), is_fossil_collection_batched, fossil_batch_size,
+            comm_manager,
             std::move(event_set), std::move(gvt_manager), std::move(state_manager),
             std::move(output_manager), std::move(twfs_manager),
             std::move(termination_manager), std::move(tw_stats));
@@ -455,8 +680,21 @@ std::unique_ptr<Partitioner> Configuration::makeLocalPartitioner(unsigned int no
 std::shared_ptr<TimeWarpCommunicationManager> Configuration::makeCommunicationManager() {
     unsigned int max_msg_size = (*root_)["time-warp"]["communication"]["max-msg-size"].asUInt();
     unsigned int max_aggregate = (*root_)["time-warp"]["communication"]["max-aggregate"].asUInt();
+    unsigned int max_aggregation_delay =
+        (*root_)["time-warp"]["communication"]["max-aggregation-delay"].asUInt();
+
+    auto aggregation_type = (*root_)["time-warp"]["communication"]["aggregation"].asString();
+    if (aggregation_type != "static" && aggregation_type != "adaptive") {
+        throw std::runtime_error(std::string("Invalid aggregation type: ") + aggregation_type);
+    }
+
+    auto message_thread = (*root_)["time-warp"]["communication"]["thread"].asString();
+    if (message_thread != "master" && message_thread != "dedicated") {
+        throw std::runtime_error(std::string("Invalid message thread: ") + message_thread);
+    }
 
-    return std::make_shared<TimeWarpMPICommunicationManager>(max_msg_size, max_aggregate);
+    return std::make_shared<TimeWarpMPICommunicationManager>(max_msg_size, max_aggregate,
+        aggregation_type == "adaptive", max_aggregation_delay, message_thread == "dedicated");
 }
 
 } // namespace warped
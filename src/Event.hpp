@@ -2,7 +2,9 @@
 #define WARPED_EVENT_HPP
 
 #include <string>
+#include <cstdint>  // for uint64_t
 #include "serialization.hpp"
+#include "EventPool.hpp"
 
 namespace warped {
 
@@ -13,6 +15,21 @@ enum class EventType : bool {
     POSITIVE
 };
 
+// Fixed width key which totally orders events, so that comparing two events never
+// needs a virtual call. It is laid out as
+//
+//      high_ : receive time (32 bits) | send time (32 bits)
+//      low_  : sender id (32 bits) | generation (lower 31 bits) | event type (1 bit)
+//
+// NOTE: Only the lower bits of the generation are kept. Generations only need to
+//       differ between events with the same sender, send time and receive time.
+struct EventKey {
+    uint64_t high_ = 0;
+    uint64_t low_ = 0;
+
+    unsigned int timestamp() const { return high_ >> 32; }
+};
+
 // Events are passed between objects. They may contain data, and must be
 // serializable. See serialization.hpp for info on serializing Events.
 class Event {
@@ -20,34 +37,29 @@ public:
     Event() = default;
     virtual ~Event() {}
 
-    bool operator== (const Event &other) {
-        return ((this->timestamp() == other.timestamp())
-                && (this->send_time_ == other.send_time_)
-                && (this->sender_name_ == other.sender_name_)
-                && (this->generation_ == other.generation_));
+    // NOTE: These comparisons ignore the event type so that a negative event is equal to
+    //       its positive counterpart.
+    bool operator== (const Event &other) const {
+        return ((this->key_.high_ == other.key_.high_)
+                && ((this->key_.low_ >> 1) == (other.key_.low_ >> 1)));
     }
 
-    bool operator< (const Event &other) {
-        return  (this->timestamp() < other.timestamp()) ? true :
-                ((this->timestamp() != other.timestamp()) ? false :
-                  ((this->send_time_ < other.send_time_) ? true :
-                  ((this->send_time_ != other.send_time_) ? false :
-                    ((this->sender_name_ < other.sender_name_) ? true :
-                    ((this->sender_name_ != other.sender_name_) ? false :
-                      ((this->generation_ < other.generation_) ? true :
-                      ((this->generation_ != other.generation_) ? false : false)))))));
+    bool operator< (const Event &other) const {
+        return (this->key_.high_ < other.key_.high_) ||
+                ((this->key_.high_ == other.key_.high_) &&
+                    ((this->key_.low_ >> 1) < (other.key_.low_ >> 1)));
     }
 
-    bool operator<= (const Event &other) {
-        return (*this < other) || (*this == other);
+    bool operator<= (const Event &other) const {
+        return !(other < *this);
     }
 
-    bool operator>= (const Event &other) {
+    bool operator>= (const Event &other) const {
         return !(*this < other);
     }
 
-    bool operator> (const Event &other) {
-        return !(*this <= other);
+    bool operator> (const Event &other) const {
+        return other < *this;
     }
 
     // The name of the SimualtionObject that should receive this event.
@@ -59,9 +71,20 @@ public:
     // Size of the model-specific event parameters
     virtual unsigned int size() const = 0;
 
+    // Build the comparison key. This must be called whenever the receive time, send time,
+    // sender id, generation or type of the event changes.
+    void stampKey() {
+        key_.high_ = ((uint64_t)timestamp() << 32) | send_time_;
+        key_.low_ = ((uint64_t)sender_id_ << 32) |
+                    ((generation_ & 0x7FFFFFFF) << 1) |
+                    (uint64_t)event_type_;
+    }
+
     // Size of the base event parameters
     unsigned int base_size() {
         unsigned int size = sender_name_.length() +
+                            sizeof(sender_id_) +
+                            sizeof(receiver_id_) +
                             sizeof(event_type_) +
                             sizeof(send_time_) +
                             sizeof(generation_);
@@ -69,8 +92,15 @@ public:
     }
 
     // The name of the SimualtionObject that sends this event.
+    // NOTE: This is only kept for the models and for debugging. The kernel identifies
+    //       LPs by the ids below.
     std::string sender_name_;
 
+    // Global ids of the sending and receiving LPs. These are assigned by the kernel
+    // when the event is sent and are used for all lookups and comparisons.
+    unsigned int sender_id_ = 0;
+    unsigned int receiver_id_ = 0;
+
     // Event type - positive or negative
     EventType event_type_ = EventType::POSITIVE;
 
@@ -81,20 +111,27 @@ public:
     //  anti-message + regeneration of event.
     unsigned long long generation_ = 0;
 
-    WARPED_REGISTER_SERIALIZABLE_MEMBERS(sender_name_, event_type_, send_time_, generation_)
+    // Comparison key built by stampKey(). It is not serialized, the receiver restamps it.
+    EventKey key_;
+
+    WARPED_REGISTER_SERIALIZABLE_MEMBERS(sender_name_, sender_id_, receiver_id_, event_type_,
+        send_time_, generation_)
 
 };
 
 class NegativeEvent : public Event {
 public:
     NegativeEvent() = default;
-    NegativeEvent(std::shared_ptr<Event> e) {
+    NegativeEvent(const std::shared_ptr<Event>& e) {
         receiver_name_ = e->receiverName();
         receive_time_ = e->timestamp();
         sender_name_ = e->sender_name_;
+        sender_id_ = e->sender_id_;
+        receiver_id_ = e->receiver_id_;
         send_time_ = e->send_time_;
         event_type_ = EventType::NEGATIVE;
         generation_ = e->generation_;
+        stampKey();
     }
 
     const std::string& receiverName() const {return receiver_name_;}
@@ -113,10 +150,14 @@ public:
 // Initial event used with the initial state save of all objects
 class InitialEvent : public Event {
 public:
+    // NOTE: Generation of all sent events starts from 1, so this is always the
+    //       smallest event of any LP.
     InitialEvent() {
         sender_name_ = "";
+        sender_id_ = 0;
         send_time_ = 0;
         generation_ = 0;
+        stampKey();
    }
 
     const std::string& receiverName() const { return receiver_name_; }
@@ -131,16 +172,9 @@ struct compareEvents {
 public:
     bool operator() (const std::shared_ptr<Event>& first,
                      const std::shared_ptr<Event>& second) const {
-        return  (first->timestamp() < second->timestamp()) ? true :
-                ((first->timestamp() != second->timestamp()) ? false :
-                  ((first->send_time_ < second->send_time_) ? true :
-                  ((first->send_time_ != second->send_time_) ? false :
-                    ((first->sender_name_ < second->sender_name_) ? true :
-                    ((first->sender_name_ != second->sender_name_) ? false :
-                      ((first->generation_ < second->generation_) ? true :
-                      ((first->generation_ != second->generation_) ? false :
-                        ((first->event_type_ < second->event_type_) ? true :
-                        ((first->event_type_ != second->event_type_) ? false : false)))))))));
+        return (first->key_.high_ < second->key_.high_) ||
+                ((first->key_.high_ == second->key_.high_) &&
+                    (first->key_.low_ < second->key_.low_));
     }
 
 };
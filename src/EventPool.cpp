@@ -0,0 +1,168 @@
+#include "EventPool.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+namespace warped {
+
+namespace {
+
+constexpr std::size_t NUM_SIZE_CLASSES = EventPool::MAX_BLOCK_SIZE / EventPool::GRANULARITY;
+
+static_assert(EventPool::TRANSFER_BLOCKS <= EventPool::MAX_FREE_BLOCKS,
+              "A full free list must hold a whole batch");
+
+struct FreeBlock {
+    FreeBlock* next_;
+};
+
+// NOTE: The free lists are plain thread local arrays so that they remain usable after the
+//       thread's destructors have run. Events held in static objects are released after
+//       that point and must then go straight back to operator delete.
+thread_local FreeBlock* free_list_[NUM_SIZE_CLASSES];
+thread_local std::size_t free_count_[NUM_SIZE_CLASSES];
+thread_local bool pool_closed_ = false;
+
+// Returns all free blocks of a thread to the system when the thread exits
+struct PoolDrainer {
+    ~PoolDrainer() {
+        for (std::size_t i = 0; i < NUM_SIZE_CLASSES; i++) {
+            while (free_list_[i] != nullptr) {
+                FreeBlock* block = free_list_[i];
+                free_list_[i] = block->next_;
+                ::operator delete(block);
+            }
+            free_count_[i] = 0;
+        }
+        pool_closed_ = true;
+    }
+};
+
+thread_local PoolDrainer pool_drainer_;
+
+struct SharedFreeList {
+    std::mutex lock_;
+    FreeBlock* head_ = nullptr;
+    std::size_t count_ = 0;
+};
+
+// NOTE: Blocks still in the shared free lists at exit are left to the operating system
+SharedFreeList shared_free_list_[NUM_SIZE_CLASSES];
+
+// Detaches the first num_blocks blocks of a list, which must have at least that many. Returns
+// the head of the detached chain and sets tail to its last block.
+FreeBlock* detachBlocks(FreeBlock*& list, std::size_t num_blocks, FreeBlock*& tail) {
+    FreeBlock* head = list;
+    tail = head;
+    for (std::size_t i = 1; i < num_blocks; i++) {
+        tail = tail->next_;
+    }
+    list = tail->next_;
+    tail->next_ = nullptr;
+    return head;
+}
+
+// Moves a batch of this thread's free blocks to the shared free list, or back to the system
+// if the shared free list is full
+void releaseBlocks(std::size_t size_class) {
+
+    FreeBlock* tail;
+    FreeBlock* head = detachBlocks(free_list_[size_class], EventPool::TRANSFER_BLOCKS, tail);
+    free_count_[size_class] -= EventPool::TRANSFER_BLOCKS;
+
+    auto& shared = shared_free_list_[size_class];
+    {
+        std::lock_guard<std::mutex> lock(shared.lock_);
+        if (shared.count_ + EventPool::TRANSFER_BLOCKS <= EventPool::MAX_SHARED_BLOCKS) {
+            tail->next_ = shared.head_;
+            shared.head_ = head;
+            shared.count_ += EventPool::TRANSFER_BLOCKS;
+            return;
+        }
+    }
+
+    while (head != nullptr) {
+        FreeBlock* block = head;
+        head = block->next_;
+        ::operator delete(block);
+    }
+}
+
+// Refills this thread's empty free list with a batch from the shared free list
+void acquireBlocks(std::size_t size_class) {
+
+    auto& shared = shared_free_list_[size_class];
+    std::lock_guard<std::mutex> lock(shared.lock_);
+    if (shared.count_ == 0) return;
+
+    std::size_t num_blocks = std::min(shared.count_, EventPool::TRANSFER_BLOCKS);
+    FreeBlock* tail;
+    free_list_[size_class] = detachBlocks(shared.head_, num_blocks, tail);
+    free_count_[size_class] = num_blocks;
+    shared.count_ -= num_blocks;
+}
+
+inline std::size_t sizeClass(std::size_t size) {
+    return (size - 1) / EventPool::GRANULARITY;
+}
+
+} // anonymous namespace
+
+void* EventPool::allocate(std::size_t size) {
+
+    if (size == 0 || size > MAX_BLOCK_SIZE) {
+        return ::operator new(size);
+    }
+
+    // NOTE: Always allocate the full block size so that any thread can reuse it, including
+    //       blocks allocated after this thread's pool has been closed
+    std::size_t size_class = sizeClass(size);
+    if (pool_closed_) {
+        return ::operator new((size_class + 1) * GRANULARITY);
+    }
+
+    if (free_list_[size_class] == nullptr) {
+        acquireBlocks(size_class);
+    }
+
+    FreeBlock* block = free_list_[size_class];
+    if (block != nullptr) {
+        free_list_[size_class] = block->next_;
+        free_count_[size_class]--;
+        return block;
+    }
+
+    return ::operator new((size_class + 1) * GRANULARITY);
+}
+
+void EventPool::deallocate(void* block, std::size_t size) noexcept {
+
+    if (block == nullptr) return;
+
+    if (size == 0 || size > MAX_BLOCK_SIZE || pool_closed_) {
+        ::operator delete(block);
+        return;
+    }
+
+    std::size_t size_class = sizeClass(size);
+    if (free_count_[size_class] >= MAX_FREE_BLOCKS) {
+        releaseBlocks(size_class);
+    }
+
+    // Make sure the free lists of this thread are drained when it exits
+    (void)&pool_drainer_;
+
+    auto free_block = static_cast<FreeBlock*>(block);
+    free_block->next_ = free_list_[size_class];
+    free_list_[size_class] = free_block;
+    free_count_[size_class]++;
+}
+
+std::size_t EventPool::numFreeBlocks(std::size_t size) {
+
+    if (size == 0 || size > MAX_BLOCK_SIZE) return 0;
+    return free_count_[sizeClass(size)];
+}
+
+} // namespace warped
@@ -0,0 +1,81 @@
+#ifndef WARPED_EVENT_POOL_HPP
+#define WARPED_EVENT_POOL_HPP
+
+#include <cstddef>      // for std::size_t, std::max_align_t
+#include <memory>
+#include <utility>
+
+namespace warped {
+
+// Per-thread pool of fixed size memory blocks used to allocate events.
+//
+// Block sizes are rounded up to a multiple of GRANULARITY, and each thread keeps its own
+// free list per block size, so allocating and freeing mostly takes no lock. A block freed by
+// a thread is put on that thread's free lists even if it was allocated by another thread.
+// Events are often created by one thread and fossil collected by another, so once a
+// thread's free list is full a batch of its blocks moves to a shared free list, from which
+// threads with an empty free list take a batch again.
+class EventPool {
+public:
+    static void* allocate(std::size_t size);
+
+    static void deallocate(void* block, std::size_t size) noexcept;
+
+    // Blocks larger than this are not pooled
+    static constexpr std::size_t MAX_BLOCK_SIZE = 512;
+
+    static constexpr std::size_t GRANULARITY = 32;
+
+    // Number of free blocks of the calling thread for the block size of size
+    static std::size_t numFreeBlocks(std::size_t size);
+
+    // Maximum number of free blocks a thread keeps for each block size
+    static constexpr std::size_t MAX_FREE_BLOCKS = 8192;
+
+    // Number of blocks moved between a thread's free list and the shared free list at once
+    static constexpr std::size_t TRANSFER_BLOCKS = 256;
+
+    // Maximum number of blocks in the shared free list for each block size
+    static constexpr std::size_t MAX_SHARED_BLOCKS = 4 * MAX_FREE_BLOCKS;
+};
+
+// Allocator which draws from the EventPool, used with std::allocate_shared so that the
+// event and its reference count share a single pooled block.
+template <class T>
+class EventAllocator {
+public:
+    typedef T value_type;
+
+    EventAllocator() noexcept = default;
+
+    template <class U>
+    EventAllocator(const EventAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned event type");
+        return static_cast<T*>(EventPool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        EventPool::deallocate(p, n * sizeof(T));
+    }
+};
+
+template <class T, class U>
+bool operator== (const EventAllocator<T>&, const EventAllocator<U>&) { return true; }
+
+template <class T, class U>
+bool operator!= (const EventAllocator<T>&, const EventAllocator<U>&) { return false; }
+
+// Models should create new events with this in place of std::make_shared, e.g.
+//
+//     events.push_back(warped::makeEvent<MyEvent>(receiver_name, timestamp));
+//
+template <class T, class... Args>
+std::shared_ptr<T> makeEvent(Args&&... args) {
+    return std::allocate_shared<T>(EventAllocator<T>(), std::forward<Args>(args)...);
+}
+
+} // namespace warped
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef LP_STATE_HPP
 #define LP_STATE_HPP
 
+#include <cstddef>
 #include <memory>
 
 namespace warped {
@@ -13,6 +14,15 @@ struct LPState {
     virtual ~LPState() {}
     virtual std::unique_ptr<LPState> clone() const = 0;
     virtual void restoreState(LPState& os) = 0;
+
+    // Opt-in hook for incremental state saving. A state which keeps its mutable data in one
+    // trivially copyable block can return the address and size of that block, and only the
+    // bytes of the block that changed are then saved. The default returns nullptr, so the
+    // whole state is saved with clone().
+    virtual void* incrementalStateData(std::size_t& size) {
+        size = 0;
+        return nullptr;
+    }
 };
 
 // This mixin uses CRTP to define the clone method for any copy-constructable
@@ -36,6 +46,18 @@ struct LPStateMixin : LPState {
 //        int var1;
 //        std::String var2;
 //    };
+//
+// To use incremental state saving, keep the data in a trivially copyable member and
+// return it from incrementalStateData:
+//
+//    WARPED_DEFINE_LP_STATE_STRUCT(MyLPState) {
+//        struct { int counts[1024]; double total; } data;
+//
+//        void* incrementalStateData(std::size_t& size) override {
+//            size = sizeof(data);
+//            return &data;
+//        }
+//    };
 #define WARPED_DEFINE_LP_STATE_STRUCT(Type) struct Type : warped::LPStateMixin<Type>
 
 } // namespace warped
@@ -3,7 +3,7 @@
 
 namespace warped {
 
-LadderQueue::LadderQueue() {
+LadderQueue::LadderQueue(bool partially_sorted) : partially_sorted_(partially_sorted) {
 
     /* Reserve the size of Top */
     top_.buffer_.reserve(2*THRESHOLD);
@@ -22,37 +22,45 @@ LadderQueue::LadderQueue() {
         }
     }
 
-#ifdef PARTIALLY_SORTED_LADDER_QUEUE
     /* Initialize Bottom capacity */
-    bottom_.reserve(THRESHOLD);
-#endif
+    if (partially_sorted_) {
+        unsorted_bottom_.reserve(THRESHOLD);
+    }
+}
+
+std::shared_ptr<Event> LadderQueue::popBottom() {
+
+    if (partially_sorted_) {
+        auto e = unsorted_bottom_.back();
+        unsorted_bottom_.pop_back();
+        return e;
+    }
+
+    auto e = *bottom_.begin();
+    bottom_.erase( bottom_.begin() );
+    return e;
 }
 
 std::shared_ptr<Event> LadderQueue::dequeue() {
 
     // Remove from bottom if not empty
-    if ( !bottom_.empty() ) {
-
-#ifdef PARTIALLY_SORTED_LADDER_QUEUE
-        auto e = bottom_.back();
-        bottom_.pop_back();
-        return e;
-#else
-        auto e = *bottom_.begin();
-        bottom_.erase( bottom_.begin() );
-        return e;
-#endif
+    if ( !bottomEmpty() ) {
+        return popBottom();
     }
 
     // If there are no rungs, pull from Top
     if (!rung_cnt_) {
+        // Nothing to dequeue when Top is empty as well
+        if (top_.buffer_.empty()) return nullptr;
+
         createNewRung();
 
         // Transfer events from Top to 1st rung of Ladder
         rung_[0].first_nonempty_bucket_ts_ = (unsigned int)-1;
         rung_[0].last_nonempty_bucket_ts_ = 0;
         for (auto event : top_.buffer_) {
-            unsigned int index = (event->timestamp()-rung_[0].start_ts_) / rung_[0].bucket_width_;
+            unsigned int index =
+                (event->key_.timestamp()-rung_[0].start_ts_) / rung_[0].bucket_width_;
             rung_[0].buffer_[index].push_back(event);
 
             rung_[0].first_nonempty_bucket_ts_ =  std::min( rung_[0].first_nonempty_bucket_ts_ ,
@@ -74,18 +82,17 @@ std::shared_ptr<Event> LadderQueue::dequeue() {
         (rung_[rung_cnt_-1].first_nonempty_bucket_ts_ - rung_[rung_cnt_-1].start_ts_) /
                                                 rung_[rung_cnt_-1].bucket_width_;
 
-#ifdef PARTIALLY_SORTED_LADDER_QUEUE
-    bottom_start_ = rung_[rung_cnt_-1].first_nonempty_bucket_ts_;
-    for (auto event : rung_[rung_cnt_-1].buffer_[bucket_index]) {
-        bottom_.push_back(event);
-    }
-    rung_[rung_cnt_-1].buffer_[bucket_index].clear();
-#else
-    for (auto event : rung_[rung_cnt_-1].buffer_[bucket_index]) {
-        bottom_.insert(event);
+    if (partially_sorted_) {
+        bottom_start_ = rung_[rung_cnt_-1].first_nonempty_bucket_ts_;
+        for (auto event : rung_[rung_cnt_-1].buffer_[bucket_index]) {
+            unsorted_bottom_.push_back(event);
+        }
+    } else {
+        for (auto event : rung_[rung_cnt_-1].buffer_[bucket_index]) {
+            bottom_.insert(event);
+        }
     }
     rung_[rung_cnt_-1].buffer_[bucket_index].clear();
-#endif
 
     // If last rung is empty now
     if (rung_[rung_cnt_-1].first_nonempty_bucket_ts_ ==
@@ -100,23 +107,15 @@ std::shared_ptr<Event> LadderQueue::dequeue() {
     recurseRung();
 
     // Check and erase from bottom, if present
-    if (bottom_.empty()) return nullptr;
+    if (bottomEmpty()) return nullptr;
 
-#ifdef PARTIALLY_SORTED_LADDER_QUEUE
-    auto e = bottom_.back();
-    bottom_.pop_back();
-    return e;
-#else
-    auto e = *bottom_.begin();
-    bottom_.erase( bottom_.begin() );
-    return e;
-#endif
+    return popBottom();
 }
 
 void LadderQueue::insert(std::shared_ptr<Event> event) {
 
     assert(event);
-    auto ts = event->timestamp();
+    auto ts = event->key_.timestamp();
 
     // Insert into top, if valid
     if (ts >= top_.start_ts_) {
@@ -150,18 +149,18 @@ void LadderQueue::insert(std::shared_ptr<Event> event) {
     }
 
     // Insert into Bottom
-#ifdef PARTIALLY_SORTED_LADDER_QUEUE
-    bottom_.push_back(event);
-    bottom_start_ = std::min(bottom_start_, ts);
-#else
-    bottom_.insert(event);
-#endif
+    if (partially_sorted_) {
+        unsorted_bottom_.push_back(event);
+        bottom_start_ = std::min(bottom_start_, ts);
+    } else {
+        bottom_.insert(event);
+    }
 }
 
 bool LadderQueue::erase(std::shared_ptr<Event> event) {
 
     assert(event);
-    auto ts = event->timestamp();
+    auto ts = event->key_.timestamp();
 
     // Erase from top, if found there
     if (ts >= top_.start_ts_) {
@@ -174,7 +173,7 @@ bool LadderQueue::erase(std::shared_ptr<Event> event) {
                 status = true;
                 it = top_.buffer_.erase(it);
             } else {
-                top_.max_ts_ = std::max( (*it)->timestamp(), top_.max_ts_ );
+                top_.max_ts_ = std::max( (*it)->key_.timestamp(), top_.max_ts_ );
                 it++;
             }
         }
@@ -250,21 +249,21 @@ bool LadderQueue::erase(std::shared_ptr<Event> event) {
     }
 
     // Check and erase from bottom, if present
-    if (bottom_.empty()) return false;
+    if (bottomEmpty()) return false;
 
     bool status = false;
 
-#ifdef PARTIALLY_SORTED_LADDER_QUEUE
-    for (auto it = bottom_.begin(); it != bottom_.end(); it++) {
-        if (*it == event) {
-            (void) bottom_.erase(it);
-            status = true;
-            break;
+    if (partially_sorted_) {
+        for (auto it = unsorted_bottom_.begin(); it != unsorted_bottom_.end(); it++) {
+            if (*it == event) {
+                (void) unsorted_bottom_.erase(it);
+                status = true;
+                break;
+            }
         }
+    } else {
+        status = (bottom_.erase(event) >= 1) ? true : false;
     }
-#else
-    status = (bottom_.erase(event) >= 1) ? true : false;
-#endif
 
     return status;
 }
@@ -317,7 +316,8 @@ void LadderQueue::recurseRung() {
     rung_[rung_cnt_-1].last_nonempty_bucket_ts_ = 0;
     for (auto event : rung_[rung_cnt_-2].buffer_[bucket_index]) {
         unsigned int index = 
-            (event->timestamp() - rung_[rung_cnt_-1].start_ts_) / rung_[rung_cnt_-1].bucket_width_;
+            (event->key_.timestamp() - rung_[rung_cnt_-1].start_ts_) /
+                                                rung_[rung_cnt_-1].bucket_width_;
         rung_[rung_cnt_-1].buffer_[index].push_back(event);
         rung_[rung_cnt_-1].first_nonempty_bucket_ts_ =
                         std::min(   rung_[rung_cnt_-1].first_nonempty_bucket_ts_ ,
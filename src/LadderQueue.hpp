@@ -9,7 +9,6 @@
 #include <set>
 #include <vector>
 
-#include "config.h"
 #include "Event.hpp"
 
 /* Configurable Ladder Queue parameters */
@@ -24,7 +23,9 @@ namespace warped {
 
 class LadderQueue {
 public:
-    LadderQueue();
+    // A partially sorted ladder queue does not sort its bottom. Events are then dequeued
+    // out of order, and lowestTimestamp() gives a lower bound on all events in the queue.
+    LadderQueue(bool partially_sorted = false);
 
     std::shared_ptr<Event> dequeue();
 
@@ -32,15 +33,21 @@ public:
 
     void insert(std::shared_ptr<Event> event);
 
-#if defined(PARTIALLY_SORTED_LADDER_QUEUE)
     unsigned int lowestTimestamp() { return bottom_start_; }
-#endif
+
+    bool isPartiallySorted() { return partially_sorted_; }
 
 private:
     void createNewRung();
 
     void recurseRung();
 
+    bool bottomEmpty() {
+        return partially_sorted_ ? unsorted_bottom_.empty() : bottom_.empty();
+    }
+
+    std::shared_ptr<Event> popBottom();
+
     /* Top variables */
     struct Top {
         bucket buffer_;
@@ -61,12 +68,10 @@ private:
     } rung_[MAX_RUNG_CNT];
 
     /* Bottom */
-#if defined(PARTIALLY_SORTED_LADDER_QUEUE)
-    bucket bottom_;
+    bool partially_sorted_;
+    bucket unsorted_bottom_;
     unsigned int bottom_start_ = 0;
-#else
     std::multiset<std::shared_ptr<Event>, compareEvents> bottom_;
-#endif
 };
 
 } // namespace warped
@@ -54,6 +54,10 @@ public:
 
     const std::string name_;
 
+    // Dense global id of this LP. This is assigned by the kernel before the simulation
+    // starts and is used in place of name_ for all lookups inside the kernel.
+    unsigned int id_ = 0;
+
     unsigned int last_fossil_collect_gvt_ = 0;
 
     unsigned long long generation_ = 0;
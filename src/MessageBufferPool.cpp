@@ -0,0 +1,49 @@
+#include "MessageBufferPool.hpp"
+
+#include <utility>
+
+namespace warped {
+
+std::vector<uint8_t> MessageBufferPool::acquire(std::size_t size) {
+
+    std::size_t size_class = 0;
+    while ((MIN_BUFFER_SIZE << size_class) < size) {
+        size_class++;
+    }
+
+    if (size_class < free_buffers_.size() && !free_buffers_[size_class].empty()) {
+        auto buffer = std::move(free_buffers_[size_class].back());
+        free_buffers_[size_class].pop_back();
+        return buffer;
+    }
+
+    return std::vector<uint8_t>(MIN_BUFFER_SIZE << size_class);
+}
+
+void MessageBufferPool::release(std::vector<uint8_t> buffer) {
+
+    if (buffer.size() < MIN_BUFFER_SIZE) return;
+
+    // A buffer goes to the largest size it can hold, so any buffer from that list fits
+    std::size_t size_class = 0;
+    while ((MIN_BUFFER_SIZE << (size_class + 1)) <= buffer.size()) {
+        size_class++;
+    }
+
+    if (size_class >= free_buffers_.size()) {
+        free_buffers_.resize(size_class + 1);
+    }
+    if (free_buffers_[size_class].size() < MAX_FREE_BUFFERS) {
+        free_buffers_[size_class].push_back(std::move(buffer));
+    }
+}
+
+std::size_t MessageBufferPool::numFree() const {
+    std::size_t count = 0;
+    for (auto& buffers : free_buffers_) {
+        count += buffers.size();
+    }
+    return count;
+}
+
+} // namespace warped
@@ -0,0 +1,37 @@
+#ifndef WARPED_MESSAGE_BUFFER_POOL_HPP
+#define WARPED_MESSAGE_BUFFER_POOL_HPP
+
+#include <cstddef>      // for std::size_t
+#include <cstdint>      // for uint8_t type
+#include <vector>
+
+namespace warped {
+
+// Pool of buffers for MPI messages.
+//
+// Buffer sizes are rounded up to a power of two times MIN_BUFFER_SIZE and free buffers are
+// kept per size, so a buffer is reused by any later message which fits in it. The pool is
+// used only by the thread that makes the MPI calls and is not thread safe.
+class MessageBufferPool {
+public:
+    // Returns a buffer of at least size bytes
+    std::vector<uint8_t> acquire(std::size_t size);
+
+    // Returns a buffer to the pool once the request using it has completed
+    void release(std::vector<uint8_t> buffer);
+
+    // Number of free buffers in the pool
+    std::size_t numFree() const;
+
+    static constexpr std::size_t MIN_BUFFER_SIZE = 256;
+
+    // Maximum number of free buffers kept for each buffer size
+    static constexpr std::size_t MAX_FREE_BUFFERS = 64;
+
+private:
+    std::vector<std::vector<std::vector<uint8_t>>> free_buffers_;
+};
+
+} // namespace warped
+
+#endif
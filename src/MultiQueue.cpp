@@ -0,0 +1,139 @@
+#include "MultiQueue.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "utility/memory.hpp"
+
+namespace warped {
+
+namespace {
+
+// Cheap per-thread random number generator used to sample sub-queues
+inline unsigned int nextRandom() {
+    thread_local unsigned int state = 0;
+    if (!state) {
+        state = (unsigned int)(reinterpret_cast<uintptr_t>(&state) >> 4) | 1;
+    }
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+} // anonymous namespace
+
+MultiQueue::MultiQueue(unsigned int num_subqueues) :
+    num_subqueues_(num_subqueues ? num_subqueues : 1),
+    subqueues_(make_unique<SubQueue []>(num_subqueues_)) {}
+
+void MultiQueue::updateHead(SubQueue& subqueue) {
+
+    subqueue.head_ts_.store(subqueue.events_.empty() ?
+                                (unsigned int)-1 : (*subqueue.events_.begin())->timestamp(),
+                            std::memory_order_release);
+}
+
+std::shared_ptr<Event> MultiQueue::takeHead(SubQueue& subqueue, unsigned int max_timestamp,
+                                            unsigned int& held_timestamp) {
+
+    if (subqueue.events_.empty()) {
+        return nullptr;
+    }
+    auto event = *subqueue.events_.begin();
+    if ((event->timestamp() > max_timestamp) && (event->event_type_ == EventType::POSITIVE)) {
+        held_timestamp = std::min(held_timestamp, event->timestamp());
+        return nullptr;
+    }
+    subqueue.events_.erase(subqueue.events_.begin());
+    updateHead(subqueue);
+    return event;
+}
+
+std::shared_ptr<Event> MultiQueue::dequeue() {
+    unsigned int held_timestamp;
+    return dequeue((unsigned int)-1, held_timestamp);
+}
+
+std::shared_ptr<Event> MultiQueue::dequeue(unsigned int max_timestamp,
+                                           unsigned int& held_timestamp) {
+
+    // Try a few times to take the better of two random sub-queues. A sub-queue which is
+    // locked by another thread or whose head is held back is skipped rather than waited on.
+    for (unsigned int attempt = 0; attempt < 2*num_subqueues_; attempt++) {
+        unsigned int i = nextRandom() % num_subqueues_;
+        unsigned int j = nextRandom() % num_subqueues_;
+
+        unsigned int i_ts = subqueues_[i].head_ts_.load(std::memory_order_relaxed);
+        unsigned int j_ts = subqueues_[j].head_ts_.load(std::memory_order_relaxed);
+        if (j_ts < i_ts) {
+            i = j;
+            i_ts = j_ts;
+        }
+        if (i_ts == (unsigned int)-1) continue;
+
+        auto& subqueue = subqueues_[i];
+        if (!subqueue.lock_.try_lock()) continue;
+
+        auto event = takeHead(subqueue, max_timestamp, held_timestamp);
+        subqueue.lock_.unlock();
+        if (event != nullptr) {
+            return event;
+        }
+    }
+
+    // Sampling failed, the queue is either nearly empty or heavily contended. Walk all
+    // sub-queues so that an event is never missed.
+    for (unsigned int i = 0; i < num_subqueues_; i++) {
+        auto& subqueue = subqueues_[i];
+        if (subqueue.head_ts_.load(std::memory_order_relaxed) == (unsigned int)-1) continue;
+
+        std::lock_guard<std::mutex> lock(subqueue.lock_);
+        auto event = takeHead(subqueue, max_timestamp, held_timestamp);
+        if (event != nullptr) {
+            return event;
+        }
+    }
+
+    return nullptr;
+}
+
+bool MultiQueue::erase(const std::shared_ptr<Event>& event) {
+
+    assert(event);
+    auto& subqueue = subqueues_[subqueueIndex(event)];
+
+    std::lock_guard<std::mutex> lock(subqueue.lock_);
+
+    // Compare addresses, other events may compare equal to this one
+    auto range = subqueue.events_.equal_range(event);
+    for (auto it = range.first; it != range.second; it++) {
+        if (*it == event) {
+            subqueue.events_.erase(it);
+            updateHead(subqueue);
+            return true;
+        }
+    }
+    return false;
+}
+
+void MultiQueue::insert(const std::shared_ptr<Event>& event) {
+
+    assert(event);
+    auto& subqueue = subqueues_[subqueueIndex(event)];
+
+    std::lock_guard<std::mutex> lock(subqueue.lock_);
+    subqueue.events_.insert(event);
+    updateHead(subqueue);
+}
+
+unsigned int MultiQueue::lowestTimestamp() const {
+
+    unsigned int lowest = (unsigned int)-1;
+    for (unsigned int i = 0; i < num_subqueues_; i++) {
+        lowest = std::min(lowest, subqueues_[i].head_ts_.load(std::memory_order_acquire));
+    }
+    return lowest;
+}
+
+} // namespace warped
@@ -0,0 +1,75 @@
+#ifndef MULTI_QUEUE_HPP
+#define MULTI_QUEUE_HPP
+
+/* MultiQueue: a relaxed concurrent priority queue.
+ *
+ * The queue is made of several sorted sub-queues, each with its own lock. A pop samples two
+ * random sub-queues and removes the lowest event of the one with the smaller head, so the
+ * events are dequeued in approximate order. No lock is held across the whole queue, so it is
+ * safe to call all operations concurrently without any external locking.
+ *
+ * An event is always kept in the sub-queue given by its receiver. Only one event per lp is
+ * scheduled at a time, which keeps the sub-queues balanced and lets erase find the event
+ * directly.
+ */
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "Event.hpp"
+
+/* Number of sub-queues per worker thread */
+#define MULTI_QUEUE_FACTOR  2
+
+namespace warped {
+
+class MultiQueue {
+public:
+    MultiQueue(unsigned int num_subqueues);
+
+    std::shared_ptr<Event> dequeue();
+
+    // A positive event above max_timestamp is left in its sub-queue and held_timestamp is
+    // lowered to its timestamp. The check is made under the sub-queue lock, so the event is
+    // never missing from the queue.
+    std::shared_ptr<Event> dequeue(unsigned int max_timestamp, unsigned int& held_timestamp);
+
+    bool erase(const std::shared_ptr<Event>& event);
+
+    void insert(const std::shared_ptr<Event>& event);
+
+    // Lower bound on the timestamps of all events in the queue
+    unsigned int lowestTimestamp() const;
+
+    unsigned int numSubqueues() const { return num_subqueues_; }
+
+private:
+    // Each sub-queue is on its own cache line to avoid false sharing between locks
+    struct alignas(64) SubQueue {
+        std::mutex lock_;
+        std::multiset<std::shared_ptr<Event>, compareEvents> events_;
+
+        // Timestamp of the lowest event, -1 if empty. Read without the lock.
+        std::atomic<unsigned int> head_ts_ {(unsigned int)-1};
+    };
+
+    unsigned int subqueueIndex(const std::shared_ptr<Event>& event) const {
+        return event->receiver_id_ % num_subqueues_;
+    }
+
+    void updateHead(SubQueue& subqueue);
+
+    // NOTE: caller must hold the lock of the sub-queue
+    std::shared_ptr<Event> takeHead(SubQueue& subqueue, unsigned int max_timestamp,
+                                    unsigned int& held_timestamp);
+
+    const unsigned int num_subqueues_;
+    std::unique_ptr<SubQueue []> subqueues_;
+};
+
+} // namespace warped
+
+#endif /* MULTI_QUEUE_HPP */
@@ -0,0 +1,48 @@
+#include <algorithm>    // for std::min, std::max
+#include <limits>
+
+#include "OptimismThrottle.hpp"
+#include "utility/memory.hpp"           // for make_unique
+
+namespace warped {
+
+OptimismThrottle::OptimismThrottle(unsigned int window, bool is_adaptive,
+    unsigned int min_window, unsigned int max_window) :
+    initial_window_(window), is_adaptive_(is_adaptive), min_window_(std::max(min_window, 1u)),
+    max_window_(max_window ? max_window : std::numeric_limits<unsigned int>::max() / 2) {}
+
+void OptimismThrottle::initialize(unsigned int num_worker_threads) {
+    threads_ = make_unique<ThreadWindow []>(num_worker_threads);
+    for (unsigned int i = 0; i < num_worker_threads; i++) {
+        threads_[i].window_ = initial_window_;
+    }
+}
+
+// NOTE: The window is left as it is until enough events have been processed since the last
+//       update to tell how many of them were rolled back
+void OptimismThrottle::update(unsigned int thread_id, unsigned int gvt, uint64_t num_processed,
+    uint64_t num_rolled_back) {
+
+    auto& thread = threads_[thread_id];
+    if (!is_adaptive_ || (gvt == thread.gvt_)) {
+        return;
+    }
+    thread.gvt_ = gvt;
+
+    uint64_t interval_processed = num_processed - thread.num_processed_;
+    if (interval_processed < MIN_UPDATE_EVENTS) {
+        return;
+    }
+    double ratio = static_cast<double>(num_rolled_back - thread.num_rolled_back_) /
+                   static_cast<double>(interval_processed);
+    thread.num_processed_ = num_processed;
+    thread.num_rolled_back_ = num_rolled_back;
+
+    if (ratio > MAX_ROLLBACK_RATIO) {
+        thread.window_ = std::max(min_window_, thread.window_ / 2);
+    } else if (ratio < MIN_ROLLBACK_RATIO) {
+        thread.window_ = std::min(max_window_, 2 * thread.window_);
+    }
+}
+
+} // namespace warped
@@ -0,0 +1,77 @@
+#ifndef OPTIMISM_THROTTLE_HPP
+#define OPTIMISM_THROTTLE_HPP
+
+/* Optimism Throttle
+ *
+ * Bounds how far ahead of the GVT the worker threads execute. A positive event whose timestamp
+ * is more than the time window above the GVT is held back until the GVT has advanced, so
+ * models with poor lookahead do not run far ahead only to be rolled back.
+ *
+ * The window is either static or adapted separately for each worker thread from the events it
+ * processed and rolled back. When the thread sees a new GVT the window is halved if most of
+ * its events since the last update were rolled back, and doubled if few of them were.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace warped {
+
+class OptimismThrottle {
+public:
+    // A window of 0 disables throttling. An adaptive window stays between min_window and
+    // max_window, 0 for no upper limit.
+    OptimismThrottle(unsigned int window = 0, bool is_adaptive = false,
+                     unsigned int min_window = 1, unsigned int max_window = 0);
+
+    void initialize(unsigned int num_worker_threads);
+
+    bool isEnabled() const { return initial_window_ != 0; }
+
+    bool isAdaptive() const { return is_adaptive_; }
+
+    // Largest timestamp of the positive events which the thread may process at the given GVT.
+    // Later events are held back.
+    unsigned int maxTimestamp(unsigned int thread_id, unsigned int gvt) const {
+        return (unsigned int)std::min<uint64_t>((uint64_t)gvt + threads_[thread_id].window_,
+                                                std::numeric_limits<unsigned int>::max());
+    }
+
+    // Adapts the window of a thread on a new GVT from its total counts of processed and rolled
+    // back events. Only called by the thread itself.
+    void update(unsigned int thread_id, unsigned int gvt, uint64_t num_processed,
+                uint64_t num_rolled_back);
+
+    unsigned int window(unsigned int thread_id) const { return threads_[thread_id].window_; }
+
+    // The window is halved when more than this fraction of the events were rolled back...
+    static constexpr double MAX_ROLLBACK_RATIO = 0.5;
+
+    // ...and doubled when less than this fraction were
+    static constexpr double MIN_ROLLBACK_RATIO = 0.1;
+
+    // Fewest events processed since the last update for the window to be adapted
+    static constexpr uint64_t MIN_UPDATE_EVENTS = 64;
+
+private:
+    // State of a worker thread, on a cache line of its own
+    struct alignas(64) ThreadWindow {
+        unsigned int window_;
+        unsigned int gvt_ = 0;
+        uint64_t num_processed_ = 0;
+        uint64_t num_rolled_back_ = 0;
+    };
+
+    unsigned int initial_window_;
+    bool is_adaptive_;
+    unsigned int min_window_;
+    unsigned int max_window_;
+
+    std::unique_ptr<ThreadWindow []> threads_;
+};
+
+} // namespace warped
+
+#endif
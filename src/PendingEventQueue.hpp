@@ -0,0 +1,134 @@
+#ifndef PENDING_EVENT_QUEUE_HPP
+#define PENDING_EVENT_QUEUE_HPP
+
+/* Pending Event Queue
+ *
+ * Holds the unprocessed events of one lp, sorted with compareEvents, in a single flat
+ * vector. The live events are kept in [head_, events_.size()), so removing the lowest
+ * event and reinserting events below it (as a rollback does) take constant time without
+ * moving the rest of the queue. New events are usually the largest and are appended.
+ *
+ * The interface is the subset of std::multiset used by the event set. Iterators are
+ * invalidated by insert and erase.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include "Event.hpp"
+
+namespace warped {
+
+class PendingEventQueue {
+public:
+    using iterator = std::vector<std::shared_ptr<Event>>::iterator;
+
+    bool empty() const { return head_ == events_.size(); }
+
+    std::size_t size() const { return events_.size() - head_; }
+
+    iterator begin() { return events_.begin() + head_; }
+
+    iterator end() { return events_.end(); }
+
+    void insert(const std::shared_ptr<Event>& event) {
+
+        assert(event);
+
+        // Largest event so far
+        if (empty() || !compareEvents()(event, events_.back())) {
+            events_.push_back(event);
+            return;
+        }
+
+        auto it = std::upper_bound(begin(), end(), event, compareEvents());
+
+        // Lowest event, reuse a free slot in front of the head if there is one
+        if ((it == begin()) && head_) {
+            events_[--head_] = event;
+            return;
+        }
+        events_.insert(it, event);
+    }
+
+    // Bulk insert of events which are already in order among themselves, as done by a
+    // rollback. Call append() for each event in order, then mergeAppended() once. The
+    // queue must not be used in between.
+    void append(std::shared_ptr<Event>&& event) {
+        if (!appending_) {
+            merge_from_ = events_.size();
+            appending_ = true;
+        }
+        events_.push_back(std::move(event));
+    }
+
+    void mergeAppended() {
+        if (!appending_) return;
+        appending_ = false;
+
+        auto mid = events_.begin() + merge_from_;
+        if ((mid != begin()) && compareEvents()(*mid, *std::prev(mid))) {
+            std::inplace_merge(begin(), mid, end(), compareEvents());
+        }
+    }
+
+    // First event which is not less than event
+    iterator lower_bound(const std::shared_ptr<Event>& event) {
+        return std::lower_bound(begin(), end(), event, compareEvents());
+    }
+
+    // Finds this exact event, not only an event which compares equal to it
+    iterator find(const std::shared_ptr<Event>& event) {
+
+        auto it = lower_bound(event);
+        for (; (it != end()) && !compareEvents()(event, *it); it++) {
+            if (*it == event) return it;
+        }
+        return end();
+    }
+
+    iterator erase(iterator it) {
+
+        assert(it != end());
+
+        if (it != begin()) {
+            return events_.erase(it);
+        }
+
+        it->reset();
+        head_++;
+        if (empty()) {
+            events_.clear();
+            head_ = 0;
+        } else if (head_ > size()) {
+            // Drop the free slots once they outnumber the events
+            events_.erase(events_.begin(), begin());
+            head_ = 0;
+        }
+        return begin();
+    }
+
+    std::size_t erase(const std::shared_ptr<Event>& event) {
+
+        auto it = find(event);
+        if (it == end()) return 0;
+        erase(it);
+        return 1;
+    }
+
+private:
+    std::vector<std::shared_ptr<Event>> events_;
+
+    // Index of the lowest event
+    std::size_t head_ = 0;
+
+    // Start of the appended events during a bulk insert
+    std::size_t merge_from_ = 0;
+    bool appending_ = false;
+};
+
+} // namespace warped
+
+#endif /* PENDING_EVENT_QUEUE_HPP */
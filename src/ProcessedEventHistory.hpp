@@ -0,0 +1,150 @@
+#ifndef PROCESSED_EVENT_HISTORY_HPP
+#define PROCESSED_EVENT_HISTORY_HPP
+
+/* Processed Event History
+ *
+ * Holds the processed events of one lp in a ring buffer. Events are processed in order,
+ * so the history is always sorted and the position of a straggler is found with a binary
+ * search. Events are added at the back and fossil collected from the front.
+ *
+ * A Range is a view of consecutive events in the history, used to coast forward without
+ * copying any events. It stays valid until the history is modified.
+ */
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include "Event.hpp"
+
+namespace warped {
+
+class ProcessedEventHistory {
+public:
+    class Range {
+    public:
+        Range(const ProcessedEventHistory& history, std::size_t first, std::size_t last) :
+            history_(history), first_(first), last_(last) {}
+
+        std::size_t size() const { return last_ - first_; }
+
+        bool empty() const { return first_ == last_; }
+
+        // Events are in order from SMALLEST to LARGEST
+        const std::shared_ptr<Event>& operator[](std::size_t i) const {
+            return history_[first_ + i];
+        }
+
+    private:
+        const ProcessedEventHistory& history_;
+        std::size_t first_;
+        std::size_t last_;
+    };
+
+    bool empty() const { return size_ == 0; }
+
+    std::size_t size() const { return size_; }
+
+    const std::shared_ptr<Event>& operator[](std::size_t i) const {
+        return buffer_[(head_ + i) & (buffer_.size() - 1)];
+    }
+
+    const std::shared_ptr<Event>& back() const { return (*this)[size_ - 1]; }
+
+    void push_back(const std::shared_ptr<Event>& event) {
+
+        if (size_ == buffer_.size()) {
+            resize(buffer_.empty() ? MIN_CAPACITY : 2 * buffer_.size());
+        }
+        buffer_[(head_ + size_) & (buffer_.size() - 1)] = event;
+        size_++;
+    }
+
+    // Index of the first event which is not less than the given event
+    std::size_t lowerBound(const Event& event) const {
+
+        std::size_t low = 0, high = size_;
+        while (low < high) {
+            std::size_t mid = low + (high - low) / 2;
+            if (*(*this)[mid] < event) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    // Index of the first event with a timestamp not less than the given time
+    std::size_t lowerBound(unsigned int timestamp) const {
+
+        std::size_t low = 0, high = size_;
+        while (low < high) {
+            std::size_t mid = low + (high - low) / 2;
+            if ((*this)[mid]->timestamp() < timestamp) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+
+    Range range(std::size_t first, std::size_t last) const {
+        assert((first <= last) && (last <= size_));
+        return Range(*this, first, last);
+    }
+
+    // Removes all events from index first onwards and passes them in order to func
+    template <class Func>
+    void truncate(std::size_t first, Func func) {
+
+        assert(first <= size_);
+        for (std::size_t i = first; i < size_; i++) {
+            func(std::move(buffer_[(head_ + i) & (buffer_.size() - 1)]));
+        }
+        size_ = first;
+    }
+
+    // Removes the count oldest events
+    void pop_front(std::size_t count) {
+
+        assert(count <= size_);
+        for (std::size_t i = 0; i < count; i++) {
+            buffer_[(head_ + i) & (buffer_.size() - 1)].reset();
+        }
+        head_ = (head_ + count) & (buffer_.size() - 1);
+        size_ -= count;
+
+        // Give back memory once the history has shrunk well below its capacity
+        if ((buffer_.size() > MIN_CAPACITY) && (4 * size_ < buffer_.size())) {
+            resize(buffer_.size() / 2);
+        }
+    }
+
+    void clear() {
+        pop_front(size_);
+    }
+
+private:
+    // Capacity must always be a power of two
+    void resize(std::size_t capacity) {
+
+        std::vector<std::shared_ptr<Event>> buffer(capacity);
+        for (std::size_t i = 0; i < size_; i++) {
+            buffer[i] = std::move(buffer_[(head_ + i) & (buffer_.size() - 1)]);
+        }
+        buffer_.swap(buffer);
+        head_ = 0;
+    }
+
+    static constexpr std::size_t MIN_CAPACITY = 8;
+
+    std::vector<std::shared_ptr<Event>> buffer_;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+};
+
+} // namespace warped
+
+#endif /* PROCESSED_EVENT_HISTORY_HPP */
@@ -1,7 +1,12 @@
 #ifndef RANDOM_NUMBER_GENERATOR_HPP
 #define RANDOM_NUMBER_GENERATOR_HPP
 
+#include <cstring>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 namespace warped {
 
@@ -9,6 +14,28 @@ struct RandomNumberGenerator {
     virtual ~RandomNumberGenerator() {}
     virtual void getState(std::ostream&) = 0;
     virtual void restoreState(std::istream&) = 0;
+
+    // Appends a binary snapshot of the generator state to the buffer. The default goes
+    // through the text state of getState, prefixed with its length.
+    virtual void saveSnapshot(std::vector<unsigned char>& buffer) {
+        std::stringstream ss;
+        getState(ss);
+        std::string text = ss.str();
+        std::size_t length = text.size();
+        auto length_bytes = reinterpret_cast<const unsigned char*>(&length);
+        buffer.insert(buffer.end(), length_bytes, length_bytes + sizeof(length));
+        buffer.insert(buffer.end(), text.begin(), text.end());
+    }
+
+    // Restores the generator state from the snapshot at position and moves position past it
+    virtual void restoreSnapshot(const unsigned char*& position) {
+        std::size_t length;
+        std::memcpy(&length, position, sizeof(length));
+        position += sizeof(length);
+        std::stringstream ss(std::string(reinterpret_cast<const char*>(position), length));
+        position += length;
+        restoreState(ss);
+    }
 };
 
 template<class Derived>
@@ -20,6 +47,32 @@ struct RNGMixin : public RandomNumberGenerator {
     virtual void restoreState(std::istream& is) {
         is >> *static_cast<const Derived&>(*this).gen_;
     }
+
+    // Generators which are trivially copyable, as the standard engines are in practice, are
+    // saved as a fixed size copy of their bytes
+    virtual void saveSnapshot(std::vector<unsigned char>& buffer) {
+        using RNGType = typename std::remove_reference<
+                            decltype(*static_cast<const Derived&>(*this).gen_)>::type;
+        if constexpr (std::is_trivially_copyable<RNGType>::value) {
+            auto bytes = reinterpret_cast<const unsigned char*>(
+                            static_cast<const Derived&>(*this).gen_.get());
+            buffer.insert(buffer.end(), bytes, bytes + sizeof(RNGType));
+        } else {
+            RandomNumberGenerator::saveSnapshot(buffer);
+        }
+    }
+
+    virtual void restoreSnapshot(const unsigned char*& position) {
+        using RNGType = typename std::remove_reference<
+                            decltype(*static_cast<const Derived&>(*this).gen_)>::type;
+        if constexpr (std::is_trivially_copyable<RNGType>::value) {
+            std::memcpy(static_cast<void*>(static_cast<const Derived&>(*this).gen_.get()),
+                        position, sizeof(RNGType));
+            position += sizeof(RNGType);
+        } else {
+            RandomNumberGenerator::restoreSnapshot(position);
+        }
+    }
 };
 
 template<class RNGType>
@@ -0,0 +1,98 @@
+#ifndef WARPED_SPSC_QUEUE_HPP
+#define WARPED_SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>      // for std::size_t
+#include <utility>
+
+namespace warped {
+
+// Unbounded FIFO queue for one producer thread and one consumer thread which never takes a
+// lock.
+//
+// Elements are stored in blocks of BLOCK_SIZE slots, so memory is only allocated once per
+// block. The producer publishes each element by advancing the size of its block, and the
+// consumer frees a block once it has taken all of its elements and the producer has moved on
+// to the next block.
+template <class T>
+class SPSCQueue {
+public:
+    SPSCQueue() : head_(new Block()), tail_(head_) {}
+
+    ~SPSCQueue() {
+        while (head_ != nullptr) {
+            Block* next = head_->next_.load(std::memory_order_relaxed);
+            delete head_;
+            head_ = next;
+        }
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // Producer only
+    void push(T value) {
+        if (tail_index_ == BLOCK_SIZE) {
+            Block* block = new Block();
+            tail_->next_.store(block, std::memory_order_release);
+            tail_ = block;
+            tail_index_ = 0;
+        }
+        tail_->slots_[tail_index_] = std::move(value);
+        tail_->size_.store(++tail_index_, std::memory_order_release);
+    }
+
+    // Consumer only. Returns the oldest element, or nullptr if the queue is empty.
+    T* front() {
+        if (head_index_ == BLOCK_SIZE) {
+            Block* next = head_->next_.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                return nullptr;
+            }
+            delete head_;
+            head_ = next;
+            head_index_ = 0;
+        }
+        if (head_index_ == head_->size_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &head_->slots_[head_index_];
+    }
+
+    // Consumer only. Removes the element returned by front().
+    void pop() {
+        head_->slots_[head_index_++] = T();
+    }
+
+    // Consumer only. Moves the oldest element into value, returns false if the queue is empty.
+    bool pop(T& value) {
+        T* element = front();
+        if (element == nullptr) {
+            return false;
+        }
+        value = std::move(*element);
+        pop();
+        return true;
+    }
+
+    static constexpr std::size_t BLOCK_SIZE = 256;
+
+private:
+    struct Block {
+        T slots_[BLOCK_SIZE];
+        std::atomic<std::size_t> size_ {0};
+        std::atomic<Block*> next_ {nullptr};
+    };
+
+    // Consumer side, on its own cache line
+    alignas(64) Block* head_;
+    std::size_t head_index_ = 0;
+
+    // Producer side, on its own cache line
+    alignas(64) Block* tail_;
+    std::size_t tail_index_ = 0;
+};
+
+} // namespace warped
+
+#endif
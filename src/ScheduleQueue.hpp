@@ -0,0 +1,206 @@
+#ifndef SCHEDULE_QUEUE_HPP
+#define SCHEDULE_QUEUE_HPP
+
+/* Schedule queue used by the event set. The backend is chosen at run time from the
+ * configuration. Each operation switches on the backend type instead of using a virtual
+ * call, the type never changes during a simulation so the branch is always predicted.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <cassert>
+
+#include "Event.hpp"
+#include "LadderQueue.hpp"
+#include "SplayTree.hpp"
+#include "CircularQueue.hpp"
+#include "MultiQueue.hpp"
+#include "utility/memory.hpp"
+
+namespace warped {
+
+enum class ScheduleQueueType {
+    MultiSet,
+    LadderQueue,
+    PartiallySortedLadderQueue,
+    SplayTree,
+    CircularQueue,
+    MultiQueue
+};
+
+class ScheduleQueue {
+public:
+    // NOTE: num_lps is the number of lps which are scheduled through this queue and
+    //       num_threads the number of worker threads which take events from it
+    ScheduleQueue(ScheduleQueueType type, unsigned int num_lps, unsigned int num_threads = 1) :
+        type_(type) {
+
+        switch (type_) {
+            case ScheduleQueueType::LadderQueue:
+                ladder_queue_ = make_unique<LadderQueue>();
+                break;
+            case ScheduleQueueType::PartiallySortedLadderQueue:
+                ladder_queue_ = make_unique<LadderQueue>(true);
+                break;
+            case ScheduleQueueType::SplayTree:
+                splay_tree_ = make_unique<SplayTree>();
+                break;
+            case ScheduleQueueType::CircularQueue:
+                circular_queue_ = make_unique<CircularQueue>(num_lps ? num_lps : 1);
+                break;
+            case ScheduleQueueType::MultiQueue:
+                multi_queue_ = make_unique<MultiQueue>(
+                        std::max(1u, std::min(MULTI_QUEUE_FACTOR*num_threads, num_lps)));
+                break;
+            default:
+                multiset_ = make_unique<std::multiset<std::shared_ptr<Event>, compareEvents>>();
+                break;
+        }
+    }
+
+    void insert(const std::shared_ptr<Event>& event) {
+
+        switch (type_) {
+            case ScheduleQueueType::LadderQueue:
+            case ScheduleQueueType::PartiallySortedLadderQueue:
+                ladder_queue_->insert(event);
+                break;
+            case ScheduleQueueType::SplayTree:
+                splay_tree_->insert(event);
+                break;
+            case ScheduleQueueType::CircularQueue:
+                circular_queue_->insert(event);
+                break;
+            case ScheduleQueueType::MultiQueue:
+                multi_queue_->insert(event);
+                break;
+            default:
+                multiset_->insert(event);
+                break;
+        }
+    }
+
+    // Returns false if the event is not present in the queue
+    bool erase(const std::shared_ptr<Event>& event) {
+
+        switch (type_) {
+            case ScheduleQueueType::LadderQueue:
+            case ScheduleQueueType::PartiallySortedLadderQueue:
+                return ladder_queue_->erase(event);
+            case ScheduleQueueType::SplayTree:
+                return splay_tree_->erase(event);
+            case ScheduleQueueType::CircularQueue:
+                return circular_queue_->deactivate(event);
+            case ScheduleQueueType::MultiQueue:
+                return multi_queue_->erase(event);
+            default:
+                return multiset_->erase(event) != 0;
+        }
+    }
+
+    // Removes and returns the lowest event, nullptr if the queue is empty
+    std::shared_ptr<Event> pop() {
+
+        switch (type_) {
+            case ScheduleQueueType::LadderQueue:
+            case ScheduleQueueType::PartiallySortedLadderQueue:
+                return ladder_queue_->dequeue();
+            case ScheduleQueueType::SplayTree: {
+                auto event = splay_tree_->begin();
+                if (event != nullptr) {
+                    splay_tree_->erase(event);
+                }
+                return event;
+            }
+            case ScheduleQueueType::CircularQueue:
+                return circular_queue_->pop_front();
+            case ScheduleQueueType::MultiQueue:
+                return multi_queue_->dequeue();
+            default: {
+                auto event_iterator = multiset_->begin();
+                if (event_iterator == multiset_->end()) {
+                    return nullptr;
+                }
+                auto event = *event_iterator;
+                multiset_->erase(event_iterator);
+                return event;
+            }
+        }
+    }
+
+    // As pop(), but a positive event above max_timestamp is left in the queue and
+    // held_timestamp is lowered to its timestamp. The multi-queue checks it under its own
+    // locks, the other backends rely on the caller's lock.
+    std::shared_ptr<Event> pop(unsigned int max_timestamp, unsigned int& held_timestamp) {
+
+        if (type_ == ScheduleQueueType::MultiQueue) {
+            return multi_queue_->dequeue(max_timestamp, held_timestamp);
+        }
+        auto event = pop();
+        if ((event != nullptr) && (event->timestamp() > max_timestamp) &&
+                (event->event_type_ == EventType::POSITIVE)) {
+            insert(event);
+            held_timestamp = std::min(held_timestamp, event->timestamp());
+            return nullptr;
+        }
+        return event;
+    }
+
+    // The partially sorted ladder queue and the multi-queue can return events out of order
+    bool isPartiallySorted() const {
+        return (type_ == ScheduleQueueType::PartiallySortedLadderQueue) ||
+               (type_ == ScheduleQueueType::MultiQueue);
+    }
+
+    // A concurrent queue does its own locking, so callers need no lock around it
+    bool isConcurrent() const {
+        return type_ == ScheduleQueueType::MultiQueue;
+    }
+
+    // Lower bound on the timestamps of all events in a partially sorted queue
+    unsigned int lowestTimestamp() {
+        assert(isPartiallySorted());
+        if (type_ == ScheduleQueueType::MultiQueue) {
+            return multi_queue_->lowestTimestamp();
+        }
+        return ladder_queue_->lowestTimestamp();
+    }
+
+    ScheduleQueueType type() const { return type_; }
+
+private:
+    const ScheduleQueueType type_;
+
+    std::unique_ptr<std::multiset<std::shared_ptr<Event>, compareEvents>> multiset_;
+    std::unique_ptr<LadderQueue> ladder_queue_;
+    std::unique_ptr<SplayTree> splay_tree_;
+    std::unique_ptr<CircularQueue> circular_queue_;
+    std::unique_ptr<MultiQueue> multi_queue_;
+};
+
+// Converts the configuration string to the schedule queue type. Returns false if the
+// string is not a valid schedule queue type.
+inline bool scheduleQueueTypeFromString(const std::string& name, ScheduleQueueType& type) {
+    if (name == "multiset") {
+        type = ScheduleQueueType::MultiSet;
+    } else if (name == "ladder-queue") {
+        type = ScheduleQueueType::LadderQueue;
+    } else if (name == "partially-sorted-ladder-queue") {
+        type = ScheduleQueueType::PartiallySortedLadderQueue;
+    } else if (name == "splay-tree") {
+        type = ScheduleQueueType::SplayTree;
+    } else if (name == "circular-queue") {
+        type = ScheduleQueueType::CircularQueue;
+    } else if (name == "multi-queue") {
+        type = ScheduleQueueType::MultiQueue;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace warped
+
+#endif /* SCHEDULE_QUEUE_HPP */
@@ -39,7 +39,9 @@ void SequentialEventDispatcher::startSimulation(
             if (e->timestamp() > max_sim_time_) continue;
             e->send_time_ = 0;
             e->sender_name_ = lp->name_;
-            e->generation_ = lp->generation_++;
+            e->sender_id_ = lp->id_;
+            e->generation_ = ++lp->generation_;
+            e->stampKey();
             events.push(e);
             valid_events.push_back(e);
         }
@@ -59,8 +61,10 @@ void SequentialEventDispatcher::startSimulation(
         for (auto& e : new_events) {
             if (e->timestamp() > max_sim_time_) continue;
             e->sender_name_ = receiver->name_;
+            e->sender_id_   = receiver->id_;
             e->send_time_   = event->timestamp();
-            e->generation_ = receiver->generation_++;
+            e->generation_ = ++receiver->generation_;
+            e->stampKey();
             events.push(e);
             valid_events.push_back(e);
         }
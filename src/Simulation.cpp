@@ -33,6 +33,7 @@ Simulation::Simulation(const std::string& config_file_name, unsigned int max_sim
 
 void Simulation::simulate(const std::vector<LogicalProcess*>& lps) {
     check(lps);
+    assignIDs(lps);
 
     auto comm_manager = config_.makeCommunicationManager();
 
@@ -57,6 +58,8 @@ void Simulation::simulate(const std::vector<LogicalProcess*>& lps,
     std::unique_ptr<Partitioner> partitioner) {
 
     check(lps);
+    assignIDs(lps);
+
     auto comm_manager = config_.makeCommunicationManager();
 
     unsigned int num_partitions = comm_manager->initialize();
@@ -82,6 +85,13 @@ void Simulation::check(const std::vector<LogicalProcess*>& lps) {
       throw std::runtime_error(std::string("Two LogicalProcess with the same name."));
 }
 
+// NOTE: All processes are given the same list of LPs, so the ids agree across all nodes
+void Simulation::assignIDs(const std::vector<LogicalProcess*>& lps) {
+    for (unsigned int i = 0; i < lps.size(); i++) {
+        lps[i]->id_ = i;
+    }
+}
+
 FileStream& Simulation::getFileStream(LogicalProcess* lp, const std::string& filename,
     std::ios_base::openmode mode, std::shared_ptr<Event> this_event) {
 
@@ -52,6 +52,7 @@ public:
 
 private:
     void inline check(const std::vector<LogicalProcess*>& lps);
+    void assignIDs(const std::vector<LogicalProcess*>& lps);
     Configuration config_;
     static std::unique_ptr<EventDispatcher> event_dispatcher_;
 };
@@ -0,0 +1,141 @@
+#include "ThreadAffinity.hpp"
+
+#include <cassert>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace warped {
+
+namespace {
+
+// Parses a sysfs cpu list such as "0-3,8-11"
+std::vector<unsigned int> parseCpuList(const std::string& list) {
+    std::vector<unsigned int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || (range[0] < '0') || (range[0] > '9')) continue;
+        auto dash = range.find('-');
+        unsigned int first = std::stoul(range.substr(0, dash));
+        unsigned int last = (dash == std::string::npos) ?
+                                first : std::stoul(range.substr(dash + 1));
+        for (unsigned int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+} // anonymous namespace
+
+std::vector<std::vector<unsigned int>> ThreadAffinity::readTopology() {
+
+    std::vector<std::vector<unsigned int>> numa_nodes;
+
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return numa_nodes;
+    }
+
+    // Node ids can have gaps, so keep looking a little past the last node found
+    for (unsigned int node = 0, missing = 0; missing < 8; node++) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) {
+            missing++;
+            continue;
+        }
+        missing = 0;
+
+        std::string list;
+        std::getline(file, list);
+        std::vector<unsigned int> cores;
+        for (auto cpu : parseCpuList(list)) {
+            if ((cpu < CPU_SETSIZE) && CPU_ISSET(cpu, &allowed)) {
+                cores.push_back(cpu);
+            }
+        }
+        if (!cores.empty()) {
+            numa_nodes.push_back(std::move(cores));
+        }
+    }
+
+    // No NUMA information, use all allowed cores as one node
+    if (numa_nodes.empty()) {
+        std::vector<unsigned int> cores;
+        for (unsigned int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cores.push_back(cpu);
+            }
+        }
+        numa_nodes.push_back(std::move(cores));
+    }
+#else
+    std::vector<unsigned int> cores;
+    for (unsigned int cpu = 0; cpu < std::thread::hardware_concurrency(); cpu++) {
+        cores.push_back(cpu);
+    }
+    numa_nodes.push_back(std::move(cores));
+#endif
+
+    return numa_nodes;
+}
+
+void ThreadAffinity::initialize(const std::vector<unsigned int>& worker_thread_scheduler_map) {
+
+    if (!isEnabled()) return;
+    initialize(worker_thread_scheduler_map, readTopology());
+}
+
+void ThreadAffinity::initialize(const std::vector<unsigned int>& worker_thread_scheduler_map,
+                                const std::vector<std::vector<unsigned int>>& numa_nodes) {
+
+    thread_cores_.clear();
+    thread_node_.clear();
+    num_numa_nodes_ = numa_nodes.size();
+    if (numa_nodes.empty()) return;
+
+    // Threads already placed on each node, so that threads sharing a node get different cores
+    std::vector<unsigned int> node_load(numa_nodes.size(), 0);
+
+    for (auto scheduler_id : worker_thread_scheduler_map) {
+        unsigned int node = scheduler_id % numa_nodes.size();
+        const auto& node_cores = numa_nodes[node];
+        assert(!node_cores.empty());
+
+        thread_node_.push_back(node);
+        if (policy_ == ThreadAffinityPolicy::Core) {
+            thread_cores_.push_back({node_cores[node_load[node] % node_cores.size()]});
+        } else {
+            thread_cores_.push_back(node_cores);
+        }
+        node_load[node]++;
+    }
+}
+
+bool ThreadAffinity::pinThread(unsigned int thread_id) const {
+
+    if (!isEnabled() || (thread_id >= thread_cores_.size())) return false;
+
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (auto cpu : thread_cores_[thread_id]) {
+        CPU_SET(cpu, &cpus);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace warped
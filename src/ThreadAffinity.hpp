@@ -0,0 +1,81 @@
+#ifndef THREAD_AFFINITY_HPP
+#define THREAD_AFFINITY_HPP
+
+/* Thread Affinity
+ *
+ * Places the worker threads on the cores of the machine. Each schedule queue is mapped to a
+ * NUMA node (round robin over the nodes) and the worker threads of that schedule queue are
+ * pinned to the cores of its node, so that the queue and the lps it serves stay in memory
+ * local to the threads using them.
+ *
+ * The NUMA topology is read from sysfs and restricted to the cores this process is allowed
+ * to run on. Without sysfs (or on other platforms) all cores form a single node, and on
+ * platforms without thread affinity support pinning does nothing.
+ */
+
+#include <string>
+#include <vector>
+
+namespace warped {
+
+enum class ThreadAffinityPolicy {
+    None,       // Let the operating system place the threads
+    Core,       // Pin each thread to a single core of its schedule queue's node
+    NumaNode    // Pin each thread to all cores of its schedule queue's node
+};
+
+// Converts the configuration string to the thread affinity policy. Returns false if the
+// string is not a valid policy.
+inline bool threadAffinityPolicyFromString(const std::string& name,
+                                           ThreadAffinityPolicy& policy) {
+    if (name == "none") {
+        policy = ThreadAffinityPolicy::None;
+    } else if (name == "core") {
+        policy = ThreadAffinityPolicy::Core;
+    } else if (name == "numa-node") {
+        policy = ThreadAffinityPolicy::NumaNode;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+class ThreadAffinity {
+public:
+    ThreadAffinity(ThreadAffinityPolicy policy = ThreadAffinityPolicy::None) :
+        policy_(policy) {}
+
+    // Computes the cores of each worker thread from the schedule queue of each thread
+    void initialize(const std::vector<unsigned int>& worker_thread_scheduler_map);
+
+    // Same as above with a given topology, the cores of each NUMA node
+    void initialize(const std::vector<unsigned int>& worker_thread_scheduler_map,
+                    const std::vector<std::vector<unsigned int>>& numa_nodes);
+
+    bool isEnabled() const { return policy_ != ThreadAffinityPolicy::None; }
+
+    // Pins the calling thread. Returns false if the thread could not be pinned.
+    bool pinThread(unsigned int thread_id) const;
+
+    const std::vector<unsigned int>& cores(unsigned int thread_id) const {
+        return thread_cores_[thread_id];
+    }
+
+    unsigned int numaNode(unsigned int thread_id) const { return thread_node_[thread_id]; }
+
+    unsigned int numNumaNodes() const { return num_numa_nodes_; }
+
+private:
+    // Cores of each NUMA node which this process may run on, empty nodes left out
+    static std::vector<std::vector<unsigned int>> readTopology();
+
+    const ThreadAffinityPolicy policy_;
+
+    std::vector<std::vector<unsigned int>> thread_cores_;
+    std::vector<unsigned int> thread_node_;
+    unsigned int num_numa_nodes_ = 1;
+};
+
+} // namespace warped
+
+#endif /* THREAD_AFFINITY_HPP */
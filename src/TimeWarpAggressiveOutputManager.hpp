@@ -16,7 +16,7 @@ public:
     virtual ~TimeWarpAggressiveOutputManager() = default;
 
     std::unique_ptr<std::vector<std::shared_ptr<Event>>>
-        rollback(std::shared_ptr<Event> straggler_event, unsigned int local_lp_id);
+        rollback(const std::shared_ptr<Event>& straggler_event, unsigned int local_lp_id);
 
 };
 
@@ -0,0 +1,90 @@
+#include <algorithm>    // for std::min()
+#include <cassert>
+
+#include "TimeWarpAllReduceGVTManager.hpp"
+
+namespace warped {
+
+bool TimeWarpAllReduceGVTManager::readyToStart() {
+    return periodElapsed(gvt_start);
+}
+
+void TimeWarpAllReduceGVTManager::progressGVT() {
+
+    if (gvt_state_ == GVTState::LOCAL) {
+        unsigned int local_min;
+
+        // If we need a local gvt calculation and haven't started yet
+        if (!started_local_gvt_) {
+
+            // The first step of a round is the cut
+            if (!started_round_) {
+                resetMinTimestamps();
+
+                assert(color_.load() == initial_color_.load());
+                toggleColor();
+
+                round_msg_count_ = 0;
+                started_round_ = true;
+            }
+
+            // Messages of the initial color received from here on are counted by the next
+            //  step, so the count is taken before the local minimum
+            step_msg_count_ = takeInitialColorCount();
+
+            startLocalReports();
+            started_local_gvt_ = true;
+
+        // If we have finished local gvt calculation
+        } else if (collectLocalReports(local_min)) {
+
+            if (comm_manager_->getNumProcesses() > 1) {
+                startReduction(nodeMinimum(local_min), step_msg_count_);
+                gvt_state_ = GVTState::GLOBAL;
+            } else {
+                finishRound(nodeMinimum(local_min));
+            }
+
+            started_local_gvt_ = false;
+        }
+
+    } else if ((gvt_state_ == GVTState::GLOBAL) && testReduction()) {
+
+        // Messages of the initial color are still in transit, so take another step
+        round_msg_count_ += reduced_msg_count_;
+        if (round_msg_count_ > 0) {
+            gvt_state_ = GVTState::LOCAL;
+        } else {
+            finishRound(reduced_min_);
+        }
+    }
+}
+
+void TimeWarpAllReduceGVTManager::finalize() {
+    if (comm_manager_->getNumProcesses() > 1) {
+        completeReductions();
+    }
+    gvt_state_ = GVTState::IDLE;
+}
+
+unsigned int TimeWarpAllReduceGVTManager::nodeMinimum(unsigned int local_min) {
+    unsigned int min = local_min;
+    for (unsigned int i = 0; i < num_worker_threads_+2; i++) {
+        min = std::min(min, thread_state_[i].min_send_timestamp_.load());
+        min = std::min(min, thread_state_[i].min_recv_timestamp_.load());
+    }
+    return min;
+}
+
+void TimeWarpAllReduceGVTManager::finishRound(unsigned int gvt) {
+    setGVT(gvt);
+    gvt_updated_ = true;
+
+    toggleInitialColor();
+    started_round_ = false;
+
+    gvt_stop = std::chrono::steady_clock::now();
+    gvt_state_ = GVTState::IDLE;
+}
+
+} // namespace warped
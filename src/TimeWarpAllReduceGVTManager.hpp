@@ -0,0 +1,59 @@
+#ifndef ALLREDUCE_GVT_MANAGER_HPP
+#define ALLREDUCE_GVT_MANAGER_HPP
+
+#include <cstdint>
+#include <memory> // for shared_ptr
+
+#include "TimeWarpAsynchronousGVTManager.hpp"
+
+/* Subclass of TimeWarpAsynchronousGVTManager which combines the node values of Mattern's
+ * algorithm with non-blocking all-reduce operations instead of a token passed around a ring,
+ * so a GVT round takes O(log P) instead of O(P) message latencies.
+ *
+ * Each node starts a round on its own GVT period by toggling its color, the first cut. In each
+ * step of the round it takes its count of messages of the initial color, collects the local
+ * minimum of its threads, and starts a reduction of the sum of the counts and the minimum of
+ * the local minimums and the timestamps of the messages sent since the cut. The worker
+ * threads keep processing events while the reduction is pending. Once the sum of all counts
+ * taken in the round is zero, every message of the initial color has been received and the
+ * minimum of the last step is the new GVT, which all nodes get at the same time.
+ */
+
+namespace warped {
+
+class TimeWarpAllReduceGVTManager : public TimeWarpAsynchronousGVTManager {
+public:
+    TimeWarpAllReduceGVTManager(std::shared_ptr<TimeWarpCommunicationManager> comm_manager,
+        unsigned int period, unsigned int num_worker_threads)
+        : TimeWarpAsynchronousGVTManager(comm_manager, period, num_worker_threads) {}
+
+    virtual ~TimeWarpAllReduceGVTManager() = default;
+
+    bool readyToStart() override;
+
+    void progressGVT() override;
+
+    void finalize() override;
+
+    // Every node starts its own calculations
+    void requestEarlyStart() override { TimeWarpGVTManager::requestEarlyStart(); }
+
+protected:
+    // Local minimum of this node for a reduction, including the messages sent since the cut
+    unsigned int nodeMinimum(unsigned int local_min);
+
+    void finishRound(unsigned int gvt);
+
+    // Sum of the message counts reduced so far in this round
+    int64_t round_msg_count_ = 0;
+
+private:
+    bool started_round_ = false;
+
+    // Message count taken in this step
+    int64_t step_msg_count_ = 0;
+};
+
+} // warped namespace
+
+#endif
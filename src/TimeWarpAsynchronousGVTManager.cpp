@@ -1,71 +1,60 @@
 #include <algorithm>    // for std::min()
 #include <cassert>
+#include <thread>       // for std::this_thread::yield()
 
 #include "TimeWarpAsynchronousGVTManager.hpp"
+#include "utility/atomic.hpp"
 #include "utility/warnings.hpp"
 #include "utility/memory.hpp"           // for make_unique
 
 WARPED_REGISTER_POLYMORPHIC_SERIALIZABLE_CLASS(warped::MatternGVTToken)
 WARPED_REGISTER_POLYMORPHIC_SERIALIZABLE_CLASS(warped::GVTUpdateMessage)
+WARPED_REGISTER_POLYMORPHIC_SERIALIZABLE_CLASS(warped::GVTStartRequest)
 
 namespace warped {
 
 void TimeWarpAsynchronousGVTManager::initialize() {
     WARPED_REGISTER_MSG_HANDLER(TimeWarpAsynchronousGVTManager, receiveMatternGVTToken, MatternGVTToken);
     WARPED_REGISTER_MSG_HANDLER(TimeWarpAsynchronousGVTManager, receiveGVTUpdate, GVTUpdateMessage);
+    WARPED_REGISTER_MSG_HANDLER(TimeWarpAsynchronousGVTManager, receiveGVTStartRequest,
+        GVTStartRequest);
 
-    // Prepare local min lvt computation
-    local_min_ = make_unique<unsigned int []>(num_worker_threads_+1);
-    send_min_ = make_unique<unsigned int []>(num_worker_threads_+1);
-    calculated_min_flag_ = make_unique<bool []>(num_worker_threads_+1);
-
-    resetLocalState();
+    // Message counts of the worker threads, the master thread and the message thread
+    thread_state_ = make_unique<MatternThreadState []>(num_worker_threads_+2);
+    recv_slot_ = num_worker_threads_+1;
 
     TimeWarpGVTManager::initialize();
 }
 
 bool TimeWarpAsynchronousGVTManager::readyToStart() {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - gvt_start).count();
-    return ((elapsed >= gvt_period_) && (comm_manager_->getID() == 0));
+    return ((comm_manager_->getID() == 0) && periodElapsed(gvt_start));
 }
 
 void TimeWarpAsynchronousGVTManager::progressGVT() {
 
     if (gvt_state_ == GVTState::LOCAL) {
+        unsigned int min;
 
         // If we need a local gvt calculation and haven't started yet
-        if ((local_gvt_flag_.load() == 0) && !started_local_gvt_) {
+        if (!started_local_gvt_) {
 
             if (!started_global_gvt_ && (comm_manager_->getID() == 0)) {
-                state_.lock_.lock();
-
-                state_.min_send_timestamp_ = (unsigned int)-1;
-                state_.min_recv_timestamp_ = (unsigned int)-1;
+                resetMinTimestamps();
 
-                assert(state_.color_ == state_.initial_color_);
+                assert(color_.load() == initial_color_.load());
                 toggleColor();
 
-                msg_count_ = initialColorCount();
-                initialColorCount() = 0;
-
-                state_.lock_.unlock();
+                msg_count_ = takeInitialColorCount();
 
                 started_global_gvt_ = true;
 
             }
 
-            resetLocalState();
-            local_gvt_flag_.store(num_worker_threads_);
+            startLocalReports();
             started_local_gvt_ = true;
 
         // If we have finished local gvt calculation
-        } else if ((local_gvt_flag_.load() == 0) && started_local_gvt_) {
-
-            unsigned int min = std::numeric_limits<unsigned int>::max();
-            for (unsigned int i = 0; i <= num_worker_threads_; i++) {
-                min = std::min(min, local_min_[i]);
-            }
+        } else if (collectLocalReports(min)) {
 
             if (comm_manager_->getNumProcesses() > 1) {
                 gvt_state_ = GVTState::GLOBAL;
@@ -73,7 +62,7 @@ void TimeWarpAsynchronousGVTManager::progressGVT() {
             } else {
                 gvt_stop = std::chrono::steady_clock::now();
                 gvt_state_ = GVTState::IDLE;
-                gVT_ = min;
+                setGVT(min);
                 gvt_updated_ = true;
             }
 
@@ -82,53 +71,79 @@ void TimeWarpAsynchronousGVTManager::progressGVT() {
     }
 }
 
-Color TimeWarpAsynchronousGVTManager::sendEventUpdate(std::shared_ptr<Event>& event) {
-    state_.lock_.lock();
+// The sending flag and the color are accessed in sequentially consistent order, so either the
+// master thread sees the flag set after toggling the color and waits for the message to be
+// counted, or this thread sees the new color.
+Color TimeWarpAsynchronousGVTManager::sendEventUpdate(const std::shared_ptr<Event>& event,
+    unsigned int thread_id) {
 
-    auto color = state_.color_;
+    auto& state = thread_state_[thread_id];
+    state.sending_.store(true);
 
-    if (color == Color::WHITE) {
-        state_.white_msg_count_++;
-    } else {
-        state_.red_msg_count_++;
-    }
+    auto color = color_.load();
+    state.msg_count_[static_cast<int>(color)].fetch_add(1, std::memory_order_relaxed);
 
-    if (color != state_.initial_color_) {
-        state_.min_send_timestamp_ = std::min(state_.min_send_timestamp_, event->timestamp());
+    if (color != initial_color_.load()) {
+        atomicMin(state.min_send_timestamp_, event->timestamp());
     }
 
-    state_.lock_.unlock();
+    state.sending_.store(false, std::memory_order_release);
 
     return color;
 }
 
-void TimeWarpAsynchronousGVTManager::receiveEventUpdate(std::shared_ptr<Event>& event, Color color) {
-    unused(event);
+void TimeWarpAsynchronousGVTManager::receiveEventUpdate(const std::shared_ptr<Event>& event,
+    Color color) {
 
-    state_.lock_.lock();
-    if (color == Color::WHITE) {
-        state_.white_msg_count_--;
-    } else {
-        state_.red_msg_count_--;
-    }
+    auto& state = thread_state_[recv_slot_];
+    state.msg_count_[static_cast<int>(color)].fetch_sub(1, std::memory_order_relaxed);
 
-    if (color == state_.initial_color_) {
-        state_.min_recv_timestamp_ = std::min(state_.min_recv_timestamp_, event->timestamp());
+    if (color == initial_color_.load()) {
+        atomicMin(state.min_recv_timestamp_, event->timestamp());
     }
-
-    state_.lock_.unlock();
 }
 
 void TimeWarpAsynchronousGVTManager::toggleColor() {
-    state_.color_ = (state_.color_ == Color::WHITE) ? Color::RED : Color::WHITE;
+    color_.store((color_.load() == Color::WHITE) ? Color::RED : Color::WHITE);
 }
 
 void TimeWarpAsynchronousGVTManager::toggleInitialColor() {
-    state_.initial_color_ = (state_.initial_color_ == Color::WHITE) ? Color::RED : Color::WHITE;
+    initial_color_.store((initial_color_.load() == Color::WHITE) ? Color::RED : Color::WHITE);
 }
 
-int& TimeWarpAsynchronousGVTManager::initialColorCount() {
-    return (state_.initial_color_ == Color::RED) ? state_.red_msg_count_ : state_.white_msg_count_;
+int64_t TimeWarpAsynchronousGVTManager::messageCount(Color color) {
+    int c = static_cast<int>(color);
+    int64_t count = -taken_msg_count_[c];
+    for (unsigned int i = 0; i < num_worker_threads_+2; i++) {
+        count += thread_state_[i].msg_count_[c].load(std::memory_order_acquire);
+    }
+    return count;
+}
+
+// Messages of the initial color received later are taken for the next token
+int64_t TimeWarpAsynchronousGVTManager::takeInitialColorCount() {
+    waitForSendUpdates();
+
+    auto color = initial_color_.load();
+    int64_t count = messageCount(color);
+    taken_msg_count_[static_cast<int>(color)] += count;
+    return count;
+}
+
+void TimeWarpAsynchronousGVTManager::resetMinTimestamps() {
+    for (unsigned int i = 0; i < num_worker_threads_+2; i++) {
+        thread_state_[i].min_send_timestamp_.store((unsigned int)-1);
+        thread_state_[i].min_recv_timestamp_.store((unsigned int)-1);
+    }
+    token_min_send_timestamp_ = (unsigned int)-1;
+}
+
+void TimeWarpAsynchronousGVTManager::waitForSendUpdates() {
+    for (unsigned int i = 0; i <= num_worker_threads_; i++) {
+        while (thread_state_[i].sending_.load()) {
+            std::this_thread::yield();
+        }
+    }
 }
 
 void TimeWarpAsynchronousGVTManager::sendMatternGVTToken(unsigned int local_minimum) {
@@ -139,18 +154,20 @@ void TimeWarpAsynchronousGVTManager::sendMatternGVTToken(unsigned int local_mini
         global_min_clock_ = (unsigned int)-1;  // Reset global min clock for another round
     }
 
-    state_.lock_.lock();
-
-    local_minimum = std::min(state_.min_recv_timestamp_, local_minimum);
+    unsigned int min_send_timestamp = token_min_send_timestamp_;
+    for (unsigned int i = 0; i < num_worker_threads_+2; i++) {
+        min_send_timestamp = std::min(min_send_timestamp,
+                                      thread_state_[i].min_send_timestamp_.load());
+        local_minimum = std::min(local_minimum, thread_state_[i].min_recv_timestamp_.load());
+    }
 
     auto msg = make_unique<MatternGVTToken>(
         sender_id,                                      // Sender
         (sender_id + 1) % num_processes,                // Receiver
         std::min(local_minimum, global_min_clock_),     // Accumulated minimum clock nodes
-        state_.min_send_timestamp_,                     // Accumulated Minimum sent "red" timestamp
-        msg_count_);                                    // Accumulated white msg count
-
-    state_.lock_.unlock();
+        min_send_timestamp,                             // Accumulated Minimum sent "red" timestamp
+        msg_count_,                                     // Accumulated white msg count
+        token_pressure_ || isUnderPressure());          // Any node under pressure
 
     comm_manager_->insertMessage(std::move(msg));
     comm_manager_->flushMessages();
@@ -162,8 +179,6 @@ void TimeWarpAsynchronousGVTManager::receiveMatternGVTToken(
     auto msg = unique_cast<TimeWarpKernelMessage, MatternGVTToken>(std::move(kmsg));
     unsigned int process_id = comm_manager_->getID();
 
-    state_.lock_.lock();
-
     if (process_id == 0) {
         // Initiator received the message
         if (msg->count <= 0) {
@@ -171,48 +186,51 @@ void TimeWarpAsynchronousGVTManager::receiveMatternGVTToken(
             // calculate the GVT now
             sendGVTUpdate(std::min(msg->m_clock, msg->m_send));
 
+            if (msg->pressure) {
+                reportRemotePressure();
+            }
+            token_pressure_ = false;
+
             gvt_state_ = GVTState::GLOBAL;
             started_global_gvt_ = false;
 
         } else {
             // Account for minumum red msg timestamp from nodes that the token has visited so far
-            state_.min_send_timestamp_ = std::min(msg->m_send, state_.min_send_timestamp_);
+            token_min_send_timestamp_ = std::min(msg->m_send, token_min_send_timestamp_);
+            token_pressure_ = msg->pressure;
 
             // Hold the white message count so it can be used when the token is sent
-            msg_count_ = initialColorCount() + msg->count;
-            initialColorCount() = 0;
+            msg_count_ = takeInitialColorCount() + msg->count;
 
             gvt_state_ = GVTState::LOCAL;
         }
 
     } else {
         // A node other than the initiator is now receiving a control message
-        if (state_.color_ == state_.initial_color_) {
-            state_.min_send_timestamp_ = (unsigned int)-1;
-            state_.min_recv_timestamp_ = (unsigned int)-1;
+        if (color_.load() == initial_color_.load()) {
+            resetMinTimestamps();
             toggleColor();
         }
 
         // Accumulations
-        state_.min_send_timestamp_ = std::min(msg->m_send, state_.min_send_timestamp_);
+        token_min_send_timestamp_ = std::min(msg->m_send, token_min_send_timestamp_);
         global_min_clock_ = std::min(global_min_clock_, msg->m_clock);
+        token_pressure_ = msg->pressure;
 
         // Hold count from message
-        msg_count_ = initialColorCount() + msg->count;
-        initialColorCount() = 0;
+        msg_count_ = takeInitialColorCount() + msg->count;
 
         gvt_state_ = GVTState::LOCAL;
     }
-
-    state_.lock_.unlock();
 }
 
 void TimeWarpAsynchronousGVTManager::receiveGVTUpdate(std::unique_ptr<TimeWarpKernelMessage> kmsg) {
     auto msg = unique_cast<TimeWarpKernelMessage, GVTUpdateMessage>(std::move(kmsg));
-    gVT_ = msg->new_gvt;
+    setGVT(msg->new_gvt);
 
     global_min_clock_ = (unsigned int)-1;
     toggleInitialColor();
+    is_start_request_sent_.store(false);
 
     if (gvt_state_ == GVTState::GLOBAL) {
         gvt_stop = std::chrono::steady_clock::now();
@@ -222,6 +240,21 @@ void TimeWarpAsynchronousGVTManager::receiveGVTUpdate(std::unique_ptr<TimeWarpKe
     gvt_updated_ = true;
 }
 
+void TimeWarpAsynchronousGVTManager::requestEarlyStart() {
+    if (comm_manager_->getID() == 0) {
+        TimeWarpGVTManager::requestEarlyStart();
+    } else if (!is_start_request_sent_.exchange(true)) {
+        comm_manager_->insertMessage(make_unique<GVTStartRequest>(comm_manager_->getID(), 0));
+    }
+}
+
+void TimeWarpAsynchronousGVTManager::receiveGVTStartRequest(
+    std::unique_ptr<TimeWarpKernelMessage> kmsg) {
+
+    unused(kmsg);
+    TimeWarpGVTManager::requestEarlyStart();
+}
+
 bool TimeWarpAsynchronousGVTManager::gvtUpdated() {
     if (gvt_updated_) {
         gvt_updated_ = false;
@@ -238,39 +271,4 @@ void TimeWarpAsynchronousGVTManager::sendGVTUpdate(unsigned int gvt) {
     }
 }
 
-void TimeWarpAsynchronousGVTManager::resetLocalState() {
-    for (unsigned int i = 0; i < num_worker_threads_+1; i++) {
-        // Reset send_min back to very large number for next calculation
-        send_min_[i] = std::numeric_limits<unsigned int>::max();
-        calculated_min_flag_[i] = false;
-        local_min_[i] = std::numeric_limits<unsigned int>::max();
-    }
-
-    // Manager thread will not receive any events
-    calculated_min_flag_[num_worker_threads_] = true;
-}
-
-
-void TimeWarpAsynchronousGVTManager::reportThreadMin(unsigned int timestamp, unsigned int thread_id,
-                                                     unsigned int local_gvt_flag) {
-    // If this thread has not yet reported a minimum, then report it.
-    if (local_gvt_flag > 0 && !calculated_min_flag_[thread_id]) {
-        local_min_[thread_id] = std::min(send_min_[thread_id], timestamp);
-        calculated_min_flag_[thread_id] = true;
-        local_gvt_flag_.fetch_sub(1);
-    }
-}
-
-void TimeWarpAsynchronousGVTManager::reportThreadSendMin(unsigned int timestamp, unsigned int thread_id) {
-    // If this thread has not yet reported a minimum, make sure to report
-    //  any sends to avoid the "simultaneous reporting problem"
-    if (local_gvt_flag_.load() > 0 && !calculated_min_flag_[thread_id]) {
-        send_min_[thread_id] = std::min(send_min_[thread_id], timestamp);
-    }
-}
-
-unsigned int TimeWarpAsynchronousGVTManager::getLocalGVTFlag() {
-    return local_gvt_flag_.load();
-}
-
 } // namespace warped
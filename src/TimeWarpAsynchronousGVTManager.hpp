@@ -1,8 +1,9 @@
 #ifndef ASYNCHRONOUS_GVT_MANAGER_HPP
 #define ASYNCHRONOUS_GVT_MANAGER_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <memory> // for unique_ptr
-#include <mutex>
 
 #include "TimeWarpEventDispatcher.hpp"
 #include "TimeWarpGVTManager.hpp"
@@ -26,22 +27,18 @@ public:
 
     void progressGVT() override;
 
-    void receiveEventUpdate(std::shared_ptr<Event>& event, Color color) override;
+    void receiveEventUpdate(const std::shared_ptr<Event>& event, Color color) override;
 
-    Color sendEventUpdate(std::shared_ptr<Event>& event) override;
+    Color sendEventUpdate(const std::shared_ptr<Event>& event, unsigned int thread_id) override;
 
     bool gvtUpdated() override;
 
     inline int64_t getMessageCount() override {
-        return initialColorCount();
+        return messageCount(initial_color_.load());
     }
 
-    void reportThreadMin(unsigned int timestamp, unsigned int thread_id,
-                                 unsigned int local_gvt_flag) override;
-
-    void reportThreadSendMin(unsigned int timestamp, unsigned int thread_id)  override;
-
-    unsigned int getLocalGVTFlag() override;
+    // Only node 0 starts calculations, so the other nodes send it a request once per GVT
+    void requestEarlyStart() override;
 
 protected:
     // Message handler for a Mattern token
@@ -50,6 +47,9 @@ protected:
     // Message handler for GVT update message
     void receiveGVTUpdate(std::unique_ptr<TimeWarpKernelMessage> kmsg);
 
+    // Message handler for a request of another node to start a calculation
+    void receiveGVTStartRequest(std::unique_ptr<TimeWarpKernelMessage> kmsg);
+
     void sendMatternGVTToken(unsigned int local_min);
 
     void sendGVTUpdate(unsigned int gvt);
@@ -58,26 +58,51 @@ protected:
 
     void toggleInitialColor();
 
-    int& initialColorCount();
+    // Messages of the given color sent minus those received which have not been taken for a
+    // token yet
+    int64_t messageCount(Color color);
+
+    // Takes the count of the messages of the initial color for a token
+    int64_t takeInitialColorCount();
+
+    // Starts a new minimum of the red messages sent and white messages received
+    void resetMinTimestamps();
 
+    // Waits until no thread is between reading the color and counting the message it sends
+    void waitForSendUpdates();
 
-    void resetLocalState();
+    // Message counts and minimum timestamps of one thread, on a cache line of its own. A slot
+    // is only updated by its own thread (the receiving thread has one slot for all receives),
+    // so sending and receiving events takes no lock. The slots are reduced when the master
+    // thread processes a token.
+    struct alignas(64) MatternThreadState {
+        // Set while a sending thread reads the color and counts the message
+        std::atomic<bool> sending_ {false};
+        // Messages of each color sent minus those received
+        std::atomic<int64_t> msg_count_[2] {};
+        std::atomic<unsigned int> min_send_timestamp_ {(unsigned int)-1};
+        std::atomic<unsigned int> min_recv_timestamp_ {(unsigned int)-1};
+    };
 
-private:
-    // State variables that must be protected by a lock
-    struct MatternNodeState {
-        Color color_ = Color::WHITE;
-        Color initial_color_ = Color::WHITE;
-        int white_msg_count_ = 0;
-        int red_msg_count_ = 0;
-        unsigned int min_send_timestamp_ = (unsigned int)-1;
-        unsigned int min_recv_timestamp_ = (unsigned int)-1;
-        std::mutex lock_;
-    } state_;
+    // One slot per worker thread and the master thread for sends, and one for receives
+    std::unique_ptr<MatternThreadState []> thread_state_;
+    unsigned int recv_slot_;
+
+    std::atomic<Color> color_ {Color::WHITE};
+    std::atomic<Color> initial_color_ {Color::WHITE};
+
+    // Message counts of each color already taken for a token
+    int64_t taken_msg_count_[2] = {0, 0};
+
+    // Accumulated minimum red msg timestamp from the token received
+    unsigned int token_min_send_timestamp_ = (unsigned int)-1;
 
     // Accumulated clock minimum
     unsigned int global_min_clock_;
 
+    // Set if a node visited by the token in this calculation was under memory pressure
+    bool token_pressure_ = false;
+
     // Used to hold accumulated white msg count from last token received
     unsigned int msg_count_ = 0;
 
@@ -86,29 +111,21 @@ private:
 
     bool started_global_gvt_ = false;
 
-
-    std::atomic<unsigned int> local_gvt_flag_ = ATOMIC_VAR_INIT(0);
-
-    // local minimum of each object including unprocessed events and sent events
-    std::unique_ptr<unsigned int []> local_min_;
-
-    // minimum timestamp of sent events used for minimum local min calculation
-    std::unique_ptr<unsigned int []> send_min_;
-
-    // flag to determine if object has already calculated min
-    std::unique_ptr<bool []> calculated_min_flag_;
-
     bool started_local_gvt_ = false;
+
+    // Set once this node has asked node 0 for a calculation, until the next GVT
+    std::atomic<bool> is_start_request_sent_ {false};
 };
 
 struct MatternGVTToken : public TimeWarpKernelMessage {
     MatternGVTToken() = default;
     MatternGVTToken(unsigned int sender, unsigned int receiver, unsigned int mc, unsigned int ms,
-        unsigned int c) :
+        unsigned int c, bool p) :
         TimeWarpKernelMessage(sender, receiver),
         m_clock(mc),
         m_send(ms),
-        count(c) {}
+        count(c),
+        pressure(p) {}
 
     // Accumulated minimum of all local simulation clocks
     unsigned int m_clock;
@@ -119,10 +136,13 @@ struct MatternGVTToken : public TimeWarpKernelMessage {
     // Accumulated total of white messages in transit
     int count;
 
+    // Set if any node visited was above its limits of uncommitted events or memory
+    bool pressure;
+
     MessageType get_type() { return MessageType::MatternGVTToken; }
 
     WARPED_REGISTER_SERIALIZABLE_MEMBERS(cereal::base_class<TimeWarpKernelMessage>(this), m_clock,
-                                         m_send, count)
+                                         m_send, count, pressure)
 
 };
 
@@ -138,6 +158,16 @@ struct GVTUpdateMessage : public TimeWarpKernelMessage {
     WARPED_REGISTER_SERIALIZABLE_MEMBERS(cereal::base_class<TimeWarpKernelMessage>(this), new_gvt)
 };
 
+struct GVTStartRequest : public TimeWarpKernelMessage {
+    GVTStartRequest() = default;
+    GVTStartRequest(unsigned int sender_id, unsigned int receiver_id) :
+        TimeWarpKernelMessage(sender_id, receiver_id) {}
+
+    MessageType get_type() { return MessageType::GVTStartRequest; }
+
+    WARPED_REGISTER_SERIALIZABLE_MEMBERS(cereal::base_class<TimeWarpKernelMessage>(this))
+};
+
 } // warped namespace
 
 #endif
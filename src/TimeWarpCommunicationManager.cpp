@@ -1,5 +1,7 @@
 #include "TimeWarpCommunicationManager.hpp"
 
+#include <cassert>
+
 namespace warped {
 
 void TimeWarpCommunicationManager::addRecvMessageHandler(MessageType msg_type,
@@ -10,17 +12,27 @@ void TimeWarpCommunicationManager::addRecvMessageHandler(MessageType msg_type,
 }
 
 void TimeWarpCommunicationManager::initializeLPMap(const std::vector<std::vector<LogicalProcess*>>& lps) {
+    unsigned int num_lps = 0;
+    for (auto& partition : lps) {
+        num_lps += partition.size();
+    }
+    node_id_by_lp_id_.assign(num_lps, 0);
+
     unsigned int partition_id = 0;
     for (auto& partition : lps) {
         for (auto& lp : partition) {
-            node_id_by_lp_name_[lp->name_] = partition_id;
+            assert(lp->id_ < num_lps);
+            node_id_by_lp_id_[lp->id_] = partition_id;
+            lp_id_by_name_[lp->name_] = lp->id_;
         }
         partition_id++;
     }
 }
 
-unsigned int TimeWarpCommunicationManager::getNodeID(std::string lp_name) {
-    return node_id_by_lp_name_[lp_name];
+unsigned int TimeWarpCommunicationManager::getLPID(const std::string& lp_name) {
+    auto it = lp_id_by_name_.find(lp_name);
+    assert(it != lp_id_by_name_.end());
+    return it->second;
 }
 
 } // namespace warped
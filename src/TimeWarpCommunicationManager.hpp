@@ -4,6 +4,8 @@
 #include <mutex>
 #include <deque>
 #include <unordered_map>
+#include <vector>
+#include <functional>
 #include <cstdint> // for uint8_t
 
 #include "LogicalProcess.hpp"
@@ -43,6 +45,16 @@ public:
 
     virtual int minAllReduceUint(unsigned int* send_local, unsigned int* recv_global) = 0;
 
+    // Starts a min and a sum reduction over all processes which complete in the background.
+    // They are ordered separately from the other collective operations, and only one may be
+    // pending at a time. The buffers must stay valid until testAllReduce() returns true.
+    virtual void startAllReduce(unsigned int* send_min, unsigned int* recv_min,
+                                int64_t* send_sum, int64_t* recv_sum) = 0;
+
+    // Returns true once the reduction started last has completed
+    virtual bool testAllReduce() = 0;
+
+    // May be called by any thread
     virtual void insertMessage(std::unique_ptr<TimeWarpKernelMessage> msg) = 0;
 
     // Sends all messages inserted into queue
@@ -50,13 +62,33 @@ public:
 
     virtual void flushMessages() = 0;
 
+    // Starts a thread which sends and receives all messages, if the communication manager is
+    // configured to use one, after running thread_init on it. The thread runs the handlers of
+    // event messages itself. Until stopMessageThread() is called, handleMessages() only runs
+    // the handlers of the other messages it received.
+    virtual void startMessageThread(std::function<void()> thread_init) = 0;
+
+    virtual void stopMessageThread() = 0;
+
+    // Reports a rollback caused by an event sent from the given node. May be called by any
+    // thread.
+    virtual void reportStraggler(unsigned int node_id) = 0;
+
+    // Number of aggregate messages sent and number of messages in them
+    virtual uint64_t numAggregatesSent() = 0;
+    virtual uint64_t numAggregatedMessages() = 0;
+
     // Adds a MessageType/Message handler pair for dispatching messages
     void addRecvMessageHandler(MessageType msg_type,
         std::function<void(std::unique_ptr<TimeWarpKernelMessage>)> msg_handler);
 
     void initializeLPMap(const std::vector<std::vector<LogicalProcess*>>& lps);
 
-    unsigned int getNodeID(std::string lp_name);
+    // Node which owns the LP with the given global id
+    unsigned int getNodeID(unsigned int lp_id) { return node_id_by_lp_id_[lp_id]; }
+
+    // Global id of an LP given its name. Only needed where the models identify LPs by name.
+    unsigned int getLPID(const std::string& lp_name);
 
 protected:
     // Map to lookup message handler given a message type
@@ -64,7 +96,8 @@ protected:
         msg_handler_by_msg_type_;
 
 private:
-    std::unordered_map<std::string, unsigned int> node_id_by_lp_name_;
+    std::vector<unsigned int> node_id_by_lp_id_;
+    std::unordered_map<std::string, unsigned int> lp_id_by_name_;
 
 };
 
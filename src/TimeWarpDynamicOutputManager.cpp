@@ -0,0 +1,111 @@
+#include "TimeWarpDynamicOutputManager.hpp"
+
+#include "utility/memory.hpp"
+
+namespace warped {
+
+void TimeWarpDynamicOutputManager::initialize(unsigned int num_local_lps) {
+    mode_ = make_unique<CancellationMode []>(num_local_lps);
+    observed_queue_ = make_unique<std::deque<OutputEvent> []>(num_local_lps);
+    TimeWarpLazyOutputManager::initialize(num_local_lps);
+}
+
+std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+TimeWarpDynamicOutputManager::rollback(const std::shared_ptr<Event>& straggler_event,
+    unsigned int local_lp_id) {
+
+    if (mode_[local_lp_id].is_lazy_) {
+        return TimeWarpLazyOutputManager::rollback(straggler_event, local_lp_id);
+    }
+
+    // Cancel the events right away but keep them to measure the hit ratio
+    auto& observed_queue = observed_queue_[local_lp_id];
+    auto num_moved = moveEventsSentAfter(straggler_event, local_lp_id, observed_queue);
+
+    // Events are returned in order of LARGEST to SMALLEST
+    auto events_to_cancel = make_unique<std::vector<std::shared_ptr<Event>>>();
+    events_to_cancel->reserve(num_moved);
+    for (auto i = num_moved; i > 0; i--) {
+        events_to_cancel->push_back(observed_queue[i-1].output_event_);
+    }
+    return events_to_cancel;
+}
+
+bool TimeWarpDynamicOutputManager::isRegenerated(const std::shared_ptr<Event>& input_event,
+    const std::shared_ptr<Event>& output_event, unsigned int local_lp_id) {
+
+    if (TimeWarpLazyOutputManager::isRegenerated(input_event, output_event, local_lp_id)) {
+        return true;
+    }
+
+    // The event was cancelled already, so it must be sent again anyway
+    if (takeSameEvent(observed_queue_[local_lp_id], input_event, output_event) != nullptr) {
+        countComparisons(local_lp_id, 1, 0);
+    }
+    return false;
+}
+
+std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+TimeWarpDynamicOutputManager::eventsNotRegenerated(const std::shared_ptr<Event>& processed_event,
+    unsigned int local_lp_id) {
+
+    auto observed_events = takeEventsSentUpTo(observed_queue_[local_lp_id], processed_event);
+    if (observed_events != nullptr) {
+        countComparisons(local_lp_id, 0, observed_events->size());
+    }
+
+    return TimeWarpLazyOutputManager::eventsNotRegenerated(processed_event, local_lp_id);
+}
+
+std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+TimeWarpDynamicOutputManager::eventsSentByCancelledEvent(
+    const std::shared_ptr<Event>& cancelled_event, unsigned int local_lp_id) {
+
+    // Cancelled already and never compared, so they do not change the hit ratio
+    takeEventsSentBy(observed_queue_[local_lp_id], cancelled_event);
+
+    return TimeWarpLazyOutputManager::eventsSentByCancelledEvent(cancelled_event, local_lp_id);
+}
+
+bool TimeWarpDynamicOutputManager::isLazy(unsigned int local_lp_id) {
+    return mode_[local_lp_id].is_lazy_;
+}
+
+double TimeWarpDynamicOutputManager::hitRatio(unsigned int local_lp_id) {
+    auto num_compared = numComparedEvents(local_lp_id);
+    if (num_compared == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(numRegeneratedEvents(local_lp_id)) /
+           static_cast<double>(num_compared);
+}
+
+unsigned int TimeWarpDynamicOutputManager::numModeSwitches(unsigned int local_lp_id) {
+    return mode_[local_lp_id].switches_;
+}
+
+void TimeWarpDynamicOutputManager::countComparisons(unsigned int local_lp_id,
+    unsigned int num_hits, unsigned int num_misses) {
+
+    TimeWarpLazyOutputManager::countComparisons(local_lp_id, num_hits, num_misses);
+
+    auto& mode = mode_[local_lp_id];
+    mode.window_hits_ += num_hits;
+    mode.window_compared_ += num_hits + num_misses;
+
+    if (mode.window_compared_ < HIT_RATIO_WINDOW) {
+        return;
+    }
+
+    double hit_ratio = static_cast<double>(mode.window_hits_) / mode.window_compared_;
+    if ((!mode.is_lazy_ && (hit_ratio > LAZY_HIT_RATIO)) ||
+        (mode.is_lazy_ && (hit_ratio < AGGRESSIVE_HIT_RATIO))) {
+        mode.is_lazy_ = !mode.is_lazy_;
+        mode.switches_++;
+    }
+
+    mode.window_hits_ = 0;
+    mode.window_compared_ = 0;
+}
+
+} // namespace warped
@@ -0,0 +1,80 @@
+#ifndef DYNAMIC_OUTPUT_MANAGER_HPP
+#define DYNAMIC_OUTPUT_MANAGER_HPP
+
+#include <cstdint>  // for uint64_t
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "TimeWarpLazyOutputManager.hpp"
+
+/* This class is a subclass of TimeWarpLazyOutputManager that switches each lp between
+ * aggressive and lazy cancellation at run time. Every lp starts with aggressive cancellation.
+ *
+ * The hit ratio of an lp is the fraction of the events sent before a rollback which are
+ * regenerated the same once their input events are processed again. Events of input events
+ * which are cancelled instead are not counted. In lazy mode the ratio is measured on the held
+ * events. In aggressive mode the cancelled events are kept for comparison only, so the ratio
+ * is measured the same way although nothing is saved. After every
+ * HIT_RATIO_WINDOW compared events, an lp switches to lazy cancellation if its hit ratio is
+ * above LAZY_HIT_RATIO and back to aggressive cancellation if it is below AGGRESSIVE_HIT_RATIO.
+ */
+
+namespace warped {
+
+class TimeWarpDynamicOutputManager : public TimeWarpLazyOutputManager {
+public:
+    TimeWarpDynamicOutputManager() = default;
+    virtual ~TimeWarpDynamicOutputManager() = default;
+
+    void initialize(unsigned int num_local_lps) override;
+
+    std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+        rollback(const std::shared_ptr<Event>& straggler_event,
+                 unsigned int local_lp_id) override;
+
+    bool isRegenerated(const std::shared_ptr<Event>& input_event,
+        const std::shared_ptr<Event>& output_event, unsigned int local_lp_id) override;
+
+    std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+        eventsNotRegenerated(const std::shared_ptr<Event>& processed_event,
+                             unsigned int local_lp_id) override;
+
+    std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+        eventsSentByCancelledEvent(const std::shared_ptr<Event>& cancelled_event,
+                                   unsigned int local_lp_id) override;
+
+    bool isLazy(unsigned int local_lp_id) override;
+
+    // Fraction of all the events compared for the specified lp which were regenerated
+    double hitRatio(unsigned int local_lp_id);
+
+    unsigned int numModeSwitches(unsigned int local_lp_id) override;
+
+    static constexpr unsigned int HIT_RATIO_WINDOW = 32;
+    static constexpr double LAZY_HIT_RATIO = 0.5;
+    static constexpr double AGGRESSIVE_HIT_RATIO = 0.2;
+
+protected:
+    // Also switches the mode at the end of a window
+    void countComparisons(unsigned int local_lp_id, unsigned int num_hits,
+                          unsigned int num_misses) override;
+
+private:
+    struct CancellationMode {
+        bool is_lazy_ = false;
+        unsigned int window_hits_ = 0;
+        unsigned int window_compared_ = 0;
+        unsigned int switches_ = 0;
+    };
+
+    std::unique_ptr<CancellationMode []> mode_;
+
+    // Events already cancelled by a rollback in aggressive mode, kept only to be compared with
+    // the events sent again, in order of their input events (per lp)
+    std::unique_ptr<std::deque<OutputEvent> []> observed_queue_;
+};
+
+} // namespace warped
+
+#endif
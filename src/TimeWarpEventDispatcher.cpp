@@ -7,7 +7,7 @@
 #include <vector>
 #include <cmath>
 #include <limits>       // for std::numeric_limits<>::max();
-#include <algorithm>    // for std::min
+#include <algorithm>    // for std::min, std::stable_sort
 #include <chrono>       // for std::chrono::steady_clock
 #include <iostream>
 #include <cassert>
@@ -33,6 +33,7 @@
 #include "utility/warnings.hpp"
 
 WARPED_REGISTER_POLYMORPHIC_SERIALIZABLE_CLASS(warped::EventMessage)
+WARPED_REGISTER_POLYMORPHIC_SERIALIZABLE_CLASS(warped::EventCancelMessage)
 WARPED_REGISTER_POLYMORPHIC_SERIALIZABLE_CLASS(warped::Event)
 WARPED_REGISTER_POLYMORPHIC_SERIALIZABLE_CLASS(warped::NegativeEvent)
 
@@ -43,6 +44,10 @@ THREAD_LOCAL_SPECIFIER unsigned int TimeWarpEventDispatcher::thread_id;
 TimeWarpEventDispatcher::TimeWarpEventDispatcher(unsigned int max_sim_time,
     unsigned int num_worker_threads,
     bool is_lp_migration_on,
+    ThreadAffinityPolicy thread_affinity_policy,
+    OptimismThrottle optimism_throttle,
+    bool is_fossil_collection_batched,
+    unsigned int fossil_batch_size,
     std::shared_ptr<TimeWarpCommunicationManager> comm_manager,
     std::unique_ptr<TimeWarpEventSet> event_set,
     std::unique_ptr<TimeWarpGVTManager> gvt_manager,
@@ -52,7 +57,10 @@ TimeWarpEventDispatcher::TimeWarpEventDispatcher(unsigned int max_sim_time,
     std::unique_ptr<TimeWarpTerminationManager> termination_manager,
     std::unique_ptr<TimeWarpStatistics> tw_stats) :
         EventDispatcher(max_sim_time), num_worker_threads_(num_worker_threads),
-        is_lp_migration_on_(is_lp_migration_on), 
+        is_lp_migration_on_(is_lp_migration_on), thread_affinity_(thread_affinity_policy),
+        optimism_throttle_(std::move(optimism_throttle)),
+        is_fossil_collection_batched_(is_fossil_collection_batched),
+        fossil_batch_size_(fossil_batch_size),
         comm_manager_(comm_manager), event_set_(std::move(event_set)), 
         gvt_manager_(std::move(gvt_manager)), state_manager_(std::move(state_manager)),
         output_manager_(std::move(output_manager)), twfs_manager_(std::move(twfs_manager)),
@@ -62,6 +70,11 @@ void TimeWarpEventDispatcher::startSimulation(const std::vector<std::vector<Logi
                                               lps) {
     initialize(lps);
 
+    if (thread_affinity_.isEnabled()) {
+        thread_affinity_.initialize(event_set_->workerThreadSchedulerMap());
+        placement_barrier_ = make_unique<std::barrier<>>(num_worker_threads_ + 1);
+    }
+
     // Create worker threads
     std::vector<std::thread> threads;
     for (unsigned int i = 0; i < num_worker_threads_; ++i) {
@@ -88,6 +101,14 @@ void TimeWarpEventDispatcher::startSimulation(const std::vector<std::vector<Logi
         threads.push_back(std::move(thread));
     }
 
+    // Wait for the worker threads to place their queues before handling any messages
+    if (placement_barrier_) {
+        placement_barrier_->arrive_and_wait();
+    }
+
+    // Sending and receiving move to the message thread if there is one
+    comm_manager_->startMessageThread([this]() { thread_id = num_worker_threads_ + 1; });
+
     unsigned int gvt = 0;
     auto sim_start = std::chrono::steady_clock::now();
 
@@ -110,6 +131,8 @@ void TimeWarpEventDispatcher::startSimulation(const std::vector<std::vector<Logi
 
     }
 
+    comm_manager_->stopMessageThread();
+    gvt_manager_->finalize();
     comm_manager_->waitForAllProcesses();
     auto sim_stop = std::chrono::steady_clock::now();
 
@@ -128,9 +151,30 @@ void TimeWarpEventDispatcher::startSimulation(const std::vector<std::vector<Logi
     for (unsigned int current_lp_id = 0; current_lp_id < num_local_lps_; current_lp_id++) {
         unsigned int num_committed = event_set_->fossilCollect(gvt, current_lp_id);
         tw_stats_->upCount(EVENTS_COMMITTED, thread_id, num_committed);
+        tw_stats_->upCount(CHECKPOINT_INTERVALS, thread_id,
+            state_manager_->checkpointInterval(current_lp_id));
+        tw_stats_->upCount(LAZY_CANCELLATION_LPS, thread_id,
+            output_manager_->isLazy(current_lp_id));
+        tw_stats_->upCount(CANCELLATION_COMPARISONS, thread_id,
+            output_manager_->numComparedEvents(current_lp_id));
+        tw_stats_->upCount(CANCELLATION_COMPARISON_HITS, thread_id,
+            output_manager_->numRegeneratedEvents(current_lp_id));
+        tw_stats_->upCount(CANCELLATION_MODE_SWITCHES, thread_id,
+            output_manager_->numModeSwitches(current_lp_id));
+        if (output_manager_->canHoldEvents()) {
+            tw_stats_->addLPCancellation(lps_[current_lp_id]->name_,
+                output_manager_->isLazy(current_lp_id),
+                output_manager_->numComparedEvents(current_lp_id),
+                output_manager_->numRegeneratedEvents(current_lp_id),
+                output_manager_->numModeSwitches(current_lp_id));
+        }
     }
+    tw_stats_->upCount(AGGREGATES_SENT, thread_id, comm_manager_->numAggregatesSent());
+    tw_stats_->upCount(AGGREGATED_MESSAGES, thread_id, comm_manager_->numAggregatedMessages());
+    tw_stats_->upCount(EARLY_GVT_STARTS, thread_id, gvt_manager_->numEarlyStarts());
 
     tw_stats_->calculateStats();
+    tw_stats_->writeLPCancellationToFile();
 
     if (comm_manager_->getID() == 0) {
         tw_stats_->writeToFile(num_seconds);
@@ -139,13 +183,8 @@ void TimeWarpEventDispatcher::startSimulation(const std::vector<std::vector<Logi
 }
 
 void TimeWarpEventDispatcher::onGVT(unsigned int gvt) {
-    auto malloc_info = mallinfo2();
-    int m = malloc_info.uordblks;
-
-    uint64_t mem = m;
-    if (m < 0) {
-        mem = (uint64_t)2*1024*1024*1024 + (uint64_t)m;
-    }
+    // The fields of mallinfo2 are size_t, so they do not wrap around at 2 GB like mallinfo's
+    uint64_t mem = mallinfo2().uordblks;
 
     if (comm_manager_->getID() == 0) {
         std::cout << "GVT: " << gvt << std::endl;
@@ -153,26 +192,80 @@ void TimeWarpEventDispatcher::onGVT(unsigned int gvt) {
 
     uint64_t c = tw_stats_->upCount(GVT_CYCLES, num_worker_threads_);
     tw_stats_->updateAverage(AVERAGE_MAX_MEMORY, mem, c);
+
+    // The period which led to this GVT, before it is adapted for the next one
+    tw_stats_->upCount(GVT_PERIODS, num_worker_threads_, gvt_manager_->getPeriod());
+    gvt_manager_->updatePeriod(mem);
+}
+
+/*
+ *  NOTE: The worker thread is pinned first so that the queues it reallocates are first touched
+ *        on its own NUMA node.
+ */
+void TimeWarpEventDispatcher::placeWorkerThread() {
+
+    thread_affinity_.pinThread(thread_id);
+
+    event_set_->placeQueues(thread_id);
+    for (unsigned int lp_id = 0; lp_id < num_local_lps_; lp_id++) {
+        if (event_set_->placementThread(lp_id) == thread_id) {
+            state_manager_->placeStateQueue(lp_id);
+        }
+    }
+
+    placement_barrier_->arrive_and_wait();
 }
 
 void TimeWarpEventDispatcher::processEvents(unsigned int id) {
 
     thread_id = id;
+
+    if (thread_affinity_.isEnabled()) {
+        placeWorkerThread();
+    }
     unsigned int local_gvt_flag;
     unsigned int gvt = 0;
+    unsigned int sweep_gvt = 0;
+    unsigned int next_lp_id = 0;
+    unsigned int held_back_gvt = std::numeric_limits<unsigned int>::max();
+    const bool is_partially_sorted = event_set_->isScheduleQueuePartiallySorted();
+    const bool is_relaxed = event_set_->isScheduleQueueRelaxed();
 
 #ifdef TIMEWARP_EVENT_LOG
     auto epoch = std::chrono::steady_clock::now();
 #endif
 
     while (!termination_manager_->terminationStatus()) {
+        if (is_fossil_collection_batched_) {
+            collectFossilBatch(sweep_gvt, next_lp_id);
+        }
+
         // NOTE: local_gvt_flag must be obtained before getting the next event to avoid the
         //  "simultaneous reporting problem"
         local_gvt_flag = gvt_manager_->getLocalGVTFlag();
 
-        std::shared_ptr<Event> event = event_set_->getEvent(thread_id);
+        // NOTE: This must be read before getting the next event too, so a message received
+        //  after the thread found no event keeps it active
+        auto num_received = termination_manager_->numReceived();
+
+        // A positive event too far ahead of the GVT stays in the schedule queue until the GVT
+        //  has advanced
+        bool is_stolen;
+        unsigned int held_timestamp = std::numeric_limits<unsigned int>::max();
+        std::shared_ptr<Event> event;
+        if (optimism_throttle_.isEnabled()) {
+            event = event_set_->getEvent(thread_id, is_stolen, throttleTimestamp(),
+                                         held_timestamp);
+        } else {
+            event = event_set_->getEvent(thread_id, is_stolen);
+        }
+
         if (event != nullptr) {
 
+            if (is_stolen) {
+                tw_stats_->upCount(EVENTS_STOLEN, thread_id);
+            }
+
 #ifdef TIMEWARP_EVENT_LOG
             // Event stat - start processing time, sender name, receiver name, timestamp
             auto event_stats = std::to_string((std::chrono::steady_clock::now() - epoch).count());
@@ -182,11 +275,13 @@ void TimeWarpEventDispatcher::processEvents(unsigned int id) {
 #endif
 
             // If needed, report event for this thread so GVT can be calculated
+            // NOTE: A partially sorted schedule queue may still hold events lower than this
+            //       one, so report the lower bound of the queue as well
             auto lowest_timestamp = event->timestamp();
-
-#ifdef PARTIALLY_SORTED_LADDER_QUEUE
-            lowest_timestamp = event_set_->lowestTimestamp(thread_id);
-#endif
+            if (is_partially_sorted && local_gvt_flag) {
+                lowest_timestamp =
+                    std::min(lowest_timestamp, event_set_->lowestTimestamp(thread_id));
+            }
 
             gvt_manager_->reportThreadMin(lowest_timestamp, thread_id, local_gvt_flag);
 
@@ -196,9 +291,9 @@ void TimeWarpEventDispatcher::processEvents(unsigned int id) {
                 termination_manager_->setThreadActive(thread_id);
             }
 
-            assert(comm_manager_->getNodeID(event->receiverName()) == comm_manager_->getID());
-            unsigned int current_lp_id = local_lp_id_by_name_[event->receiverName()];
-            LogicalProcess* current_lp = lps_by_name_[event->receiverName()];
+            assert(comm_manager_->getNodeID(event->receiver_id_) == comm_manager_->getID());
+            unsigned int current_lp_id = local_lp_id_by_global_id_[event->receiver_id_];
+            LogicalProcess* current_lp = lps_[current_lp_id];
 
             // Get the last processed event so we can check for a rollback
             auto last_processed_event = event_set_->lastProcessedEvent(current_lp_id);
@@ -224,6 +319,19 @@ void TimeWarpEventDispatcher::processEvents(unsigned int id) {
                     ((*event < *last_processed_event) ||
                         ((*event == *last_processed_event) &&
                          (event->event_type_ == EventType::NEGATIVE)))) {
+                // A straggler sent from this node could have been generated before the
+                // rolled back events had a strictly ordered queue been used. This is an upper
+                // bound on the extra rollbacks caused by a relaxed schedule queue.
+                unsigned int sender_node_id = comm_manager_->getNodeID(event->sender_id_);
+                if (is_relaxed && (event->event_type_ == EventType::POSITIVE) &&
+                        (sender_node_id == comm_manager_->getID())) {
+                    tw_stats_->upCount(RELAXED_QUEUE_ROLLBACKS, thread_id);
+                }
+                // Let the sending node know, so that it holds its messages for us less long
+                if ((event->event_type_ == EventType::POSITIVE) &&
+                        (sender_node_id != comm_manager_->getID())) {
+                    comm_manager_->reportStraggler(sender_node_id);
+                }
                 rollback(event);
 #ifdef TIMEWARP_EVENT_LOG
                 event_stats += ",1"; // Event stats - rollback
@@ -235,11 +343,24 @@ void TimeWarpEventDispatcher::processEvents(unsigned int id) {
 
             // Check to see if event is NEGATIVE and cancel
             if (event->event_type_ == EventType::NEGATIVE) {
+                tw_stats_->upCount(SCHEDULED_ANTI_MESSAGES, thread_id);
+
                 event_set_->acquireInputQueueLock(current_lp_id);
                 bool found = event_set_->cancelEvent(current_lp_id, event);
+
+                // The cancelled event will not be processed again, so nothing it sent before
+                // a rollback can be regenerated
+                // NOTE: This must be done before the lp can be scheduled on another thread
+                auto events_not_regenerated =
+                    output_manager_->eventsSentByCancelledEvent(event, current_lp_id);
+
                 event_set_->startScheduling(current_lp_id);
                 event_set_->releaseInputQueueLock(current_lp_id);
 
+                if (events_not_regenerated != nullptr) {
+                    cancelEvents(std::move(events_not_regenerated));
+                }
+
                 if (found) {
                     tw_stats_->upCount(CANCELLED_EVENTS, thread_id);
 #ifdef TIMEWARP_EVENT_LOG
@@ -270,6 +391,7 @@ void TimeWarpEventDispatcher::processEvents(unsigned int id) {
             auto new_events = current_lp->receiveEvent(*event);
 
             tw_stats_->upCount(EVENTS_PROCESSED, thread_id);
+            gvt_manager_->countProcessedEvent(thread_id);
 
             // Save state
             state_manager_->saveState(event, current_lp_id, current_lp);
@@ -277,6 +399,15 @@ void TimeWarpEventDispatcher::processEvents(unsigned int id) {
             // Send new events
             sendEvents(event, new_events, current_lp_id, current_lp);
 
+            // Cancel the events held back by lazy cancellation which were not sent again
+            auto events_not_regenerated =
+                output_manager_->eventsNotRegenerated(event, current_lp_id);
+            if (events_not_regenerated != nullptr) {
+                tw_stats_->upCount(LAZY_CANCELLATION_MISSES, thread_id,
+                    events_not_regenerated->size());
+                cancelEvents(std::move(events_not_regenerated));
+            }
+
 #ifdef TIMEWARP_EVENT_LOG
             // Event stats - event processing time
             auto end_event = std::chrono::steady_clock::now();
@@ -289,20 +420,8 @@ void TimeWarpEventDispatcher::processEvents(unsigned int id) {
 
             // Check for recent gvt update
             gvt = gvt_manager_->getGVT();
-            if (gvt > current_lp->last_fossil_collect_gvt_) {
-                current_lp->last_fossil_collect_gvt_ = gvt;
-
-                // Fossil collect all queues for this lp
-                twfs_manager_->fossilCollect(gvt, current_lp_id);
-                output_manager_->fossilCollect(gvt, current_lp_id);
-
-                unsigned int event_fossil_collect_time =
-                    state_manager_->fossilCollect(gvt, current_lp_id);
-
-                unsigned int num_committed =
-                    event_set_->fossilCollect(event_fossil_collect_time, current_lp_id);
-
-                tw_stats_->upCount(EVENTS_COMMITTED, thread_id, num_committed);
+            if (!is_fossil_collection_batched_ && (gvt > current_lp->last_fossil_collect_gvt_)) {
+                fossilCollect(gvt, current_lp_id);
 
 #ifdef TIMEWARP_EVENT_LOG
                 // Write event statistics to the log file
@@ -322,10 +441,13 @@ void TimeWarpEventDispatcher::processEvents(unsigned int id) {
             event_set_->replenishScheduler(current_lp_id);
             event_set_->releaseInputQueueLock(current_lp_id);
 
+        } else if (held_timestamp != std::numeric_limits<unsigned int>::max()) {
+            holdBackEvents(held_timestamp, local_gvt_flag, held_back_gvt);
+
         } else {
             // This thread no longer has anything to do because it's schedule queue is empty.
             if (!termination_manager_->threadPassive(thread_id)) {
-                termination_manager_->setThreadPassive(thread_id);
+                termination_manager_->setThreadPassive(thread_id, num_received);
             }
 
 #ifdef TIMEWARP_EVENT_LOG
@@ -351,16 +473,70 @@ void TimeWarpEventDispatcher::receiveEventMessage(std::unique_ptr<TimeWarpKernel
     auto msg = unique_cast<TimeWarpKernelMessage, EventMessage>(std::move(kmsg));
     assert(msg->event != nullptr);
 
+    // The comparison key is not sent, so build it again here
+    msg->event->stampKey();
+
     tw_stats_->upCount(TOTAL_EVENTS_RECEIVED, thread_id);
 
+    // NOTE: The event is inserted before the GVT manager counts it, so a GVT calculation which
+    //       starts in between sees it in the event set.
+    sendLocalEvent(msg->event);
+
     termination_manager_->updateMsgCount(-1);
     gvt_manager_->receiveEventUpdate(msg->event, msg->color_);
+}
 
-    sendLocalEvent(msg->event);
+void TimeWarpEventDispatcher::receiveEventCancelMessage(
+    std::unique_ptr<TimeWarpKernelMessage> kmsg) {
+
+    auto msg = unique_cast<TimeWarpKernelMessage, EventCancelMessage>(std::move(kmsg));
+    assert(!msg->keys_.empty());
+
+    // NOTE: The names of the lps are not sent. The kernel only uses their ids.
+    std::vector<std::shared_ptr<Event>> neg_events;
+    auto key = msg->keys_.begin();
+    while (key != msg->keys_.end()) {
+        unsigned int sender_id = key[0];
+        unsigned int receiver_id = key[1];
+        unsigned int num_events = key[2];
+        key += EventCancelMessage::FIELDS_PER_GROUP;
+
+        for (unsigned int i = 0; i < num_events; i++) {
+            auto neg_event = makeEvent<NegativeEvent>();
+            neg_event->sender_id_ = sender_id;
+            neg_event->receiver_id_ = receiver_id;
+            neg_event->receive_time_ = key[0];
+            neg_event->send_time_ = key[1];
+            neg_event->generation_ = key[2];
+            neg_event->event_type_ = EventType::NEGATIVE;
+            neg_event->stampKey();
+            neg_events.push_back(std::move(neg_event));
+            key += EventCancelMessage::FIELDS_PER_EVENT;
+        }
+    }
+
+    tw_stats_->upCount(TOTAL_EVENTS_RECEIVED, thread_id, neg_events.size());
+
+    auto lowest_event = *std::min_element(neg_events.begin(), neg_events.end(), compareEvents());
+
+    // The sender grouped the events by receiver
+    auto first = neg_events.begin();
+    while (first != neg_events.end()) {
+        auto receiver_id = (*first)->receiver_id_;
+        auto last = std::find_if(first, neg_events.end(),
+            [receiver_id](const std::shared_ptr<Event>& e) {
+                return e->receiver_id_ != receiver_id;
+            });
+        cancelLocalEvents(first, last);
+        first = last;
+    }
+
+    termination_manager_->updateMsgCount(-1);
+    gvt_manager_->receiveEventUpdate(lowest_event, msg->color_);
 }
 
-void TimeWarpEventDispatcher::sendEvents(std::shared_ptr<Event> source_event,
-    std::vector<std::shared_ptr<Event>> new_events, unsigned int sender_lp_id,
+void TimeWarpEventDispatcher::sendEvents(const std::shared_ptr<Event>& source_event,
+    const std::vector<std::shared_ptr<Event>>& new_events, unsigned int sender_lp_id,
     LogicalProcess *sender_lp) {
 
     for (auto& e: new_events) {
@@ -368,13 +544,24 @@ void TimeWarpEventDispatcher::sendEvents(std::shared_ptr<Event> source_event,
         // Make sure not to send any events past max time so we can terminate simulation
         if (e->timestamp() <= max_sim_time_) {
             e->sender_name_ = sender_lp->name_;
+            e->sender_id_ = sender_lp->id_;
+            e->receiver_id_ = comm_manager_->getLPID(e->receiverName());
             e->send_time_ = source_event->timestamp();
-            e->generation_ = sender_lp->generation_++;
+
+            // With lazy cancellation, the receiver may still have this event from before a
+            // rollback, in which case it is not sent again
+            if (output_manager_->isRegenerated(source_event, e, sender_lp_id)) {
+                tw_stats_->upCount(LAZY_CANCELLATION_HITS, thread_id);
+                continue;
+            }
+
+            e->generation_ = ++sender_lp->generation_;
+            e->stampKey();
 
             // Save sent events so that they can be sent as anti-messages in the case of a rollback
             output_manager_->insertEvent(source_event, e, sender_lp_id);
 
-            unsigned int node_id = comm_manager_->getNodeID(e->receiverName());
+            unsigned int node_id = comm_manager_->getNodeID(e->receiver_id_);
             if (node_id == comm_manager_->getID()) {
                 // Local event
                 sendLocalEvent(e);
@@ -388,8 +575,8 @@ void TimeWarpEventDispatcher::sendEvents(std::shared_ptr<Event> source_event,
     }
 }
 
-void TimeWarpEventDispatcher::sendLocalEvent(std::shared_ptr<Event> event) {
-    unsigned int receiver_lp_id = local_lp_id_by_name_[event->receiverName()];
+void TimeWarpEventDispatcher::sendLocalEvent(const std::shared_ptr<Event>& event) {
+    unsigned int receiver_lp_id = local_lp_id_by_global_id_[event->receiver_id_];
 
     // NOTE: Event is assumed to be less than the maximum simulation time.
     event_set_->acquireInputQueueLock(receiver_lp_id);
@@ -399,48 +586,132 @@ void TimeWarpEventDispatcher::sendLocalEvent(std::shared_ptr<Event> event) {
     // Make sure to track sends if we are in the middle of a GVT calculation.
     gvt_manager_->reportThreadSendMin(event->timestamp(), thread_id);
 
+    countInsertStatus(status);
+}
+
+void TimeWarpEventDispatcher::countInsertStatus(InsertStatus status) {
     if (status == InsertStatus::StarvedObject) {
         tw_stats_->upCount(EVENTS_FOR_STARVED_OBJECTS, thread_id);
     } else if (status == InsertStatus::SchedEventSwapSuccess) {
         tw_stats_->upCount(SCHEDULED_EVENT_SWAPS_SUCCESS, thread_id);
     } else if (status == InsertStatus::SchedEventSwapFailure) {
         tw_stats_->upCount(SCHEDULED_EVENT_SWAPS_FAILURE, thread_id);
+    } else if (status == InsertStatus::Annihilated) {
+        tw_stats_->upCount(ANNIHILATED_EVENTS, thread_id);
+        tw_stats_->upCount(CANCELLED_EVENTS, thread_id);
     }
 }
 
 void TimeWarpEventDispatcher::cancelEvents(
             std::unique_ptr<std::vector<std::shared_ptr<Event>>> events_to_cancel) {
 
-    if (events_to_cancel->empty()) return;
+    // Make sure not to send any events past max time so that events can be exhausted and we
+    // can terminate the simulation.
+    auto& events = *events_to_cancel;
+    events.erase(std::remove_if(events.begin(), events.end(),
+        [this](const std::shared_ptr<Event>& e) { return e->timestamp() > max_sim_time_; }),
+        events.end());
+
+    if (events.empty()) return;
+
+    // Group the events by receiver so that the input queue of each local receiver is locked
+    // once, and the anti-messages to each node are batched into few messages
+    std::stable_sort(events.begin(), events.end(),
+        [](const std::shared_ptr<Event>& first, const std::shared_ptr<Event>& second) {
+            return first->receiver_id_ < second->receiver_id_;
+        });
+
+    // Messages being filled for each remote node along with their lowest event
+    std::vector<std::pair<std::unique_ptr<EventCancelMessage>, std::shared_ptr<Event>>>
+        cancel_msgs;
+
+    auto first = events.begin();
+    while (first != events.end()) {
+        auto receiver_id = (*first)->receiver_id_;
+        auto last = std::find_if(first, events.end(),
+            [receiver_id](const std::shared_ptr<Event>& e) {
+                return e->receiver_id_ != receiver_id;
+            });
+
+        unsigned int receiver_node_id = comm_manager_->getNodeID(receiver_id);
+        if (receiver_node_id == comm_manager_->getID()) {
+            cancelLocalEvents(first, last);
+            tw_stats_->upCount(LOCAL_NEGATIVE_EVENTS_SENT, thread_id, last - first);
+            first = last;
+            continue;
+        }
 
-    // NOTE: events to cancel are in order from LARGEST to SMALLEST so we send from the back
-    do {
-        auto event = events_to_cancel->back();
+        auto msg = std::find_if(cancel_msgs.begin(), cancel_msgs.end(),
+            [receiver_node_id](const auto& m) { return m.first->receiver_id == receiver_node_id; });
+        if (msg == cancel_msgs.end()) {
+            cancel_msgs.emplace_back(make_unique<EventCancelMessage>(comm_manager_->getID(),
+                receiver_node_id), nullptr);
+            msg = std::prev(cancel_msgs.end());
+        }
 
-        // NOTE: this is a copy the positive event
-        auto neg_event = std::make_shared<NegativeEvent>(event);
-        events_to_cancel->pop_back();
-
-        // Make sure not to send any events past max time so that events can be exhausted and we
-        // can terminate the simulation.
-        if (event->timestamp() <= max_sim_time_) {
-            unsigned int receiver_node_id = comm_manager_->getNodeID(event->receiverName());
-            if (receiver_node_id == comm_manager_->getID()) {
-                sendLocalEvent(neg_event);
-                tw_stats_->upCount(LOCAL_NEGATIVE_EVENTS_SENT, thread_id);
-            } else {
-                enqueueRemoteEvent(neg_event, receiver_node_id);
-                tw_stats_->upCount(REMOTE_NEGATIVE_EVENTS_SENT, thread_id);
+        for (auto it = first; it != last; it++) {
+            if (msg->first->size() == MAX_CANCEL_MESSAGE_EVENTS) {
+                sendCancelMessage(std::move(msg->first), msg->second);
+                msg->first = make_unique<EventCancelMessage>(comm_manager_->getID(),
+                    receiver_node_id);
+                msg->second = nullptr;
+            }
+            msg->first->addEvent(**it);
+            if (!msg->second || (**it < *msg->second)) {
+                msg->second = *it;
             }
         }
+        tw_stats_->upCount(REMOTE_NEGATIVE_EVENTS_SENT, thread_id, last - first);
+        first = last;
+    }
 
-    } while (!events_to_cancel->empty());
+    for (auto& msg : cancel_msgs) {
+        sendCancelMessage(std::move(msg.first), msg.second);
+    }
 }
 
-void TimeWarpEventDispatcher::rollback(std::shared_ptr<Event> straggler_event) {
+void TimeWarpEventDispatcher::cancelLocalEvents(
+    std::vector<std::shared_ptr<Event>>::iterator first,
+    std::vector<std::shared_ptr<Event>>::iterator last) {
+
+    unsigned int receiver_lp_id = local_lp_id_by_global_id_[(*first)->receiver_id_];
+    unsigned int min_timestamp = std::numeric_limits<unsigned int>::max();
 
-    unsigned int local_lp_id = local_lp_id_by_name_[straggler_event->receiverName()];
-    LogicalProcess* current_lp = lps_by_name_[straggler_event->receiverName()];
+    event_set_->acquireInputQueueLock(receiver_lp_id);
+    for (auto it = first; it != last; it++) {
+        // NOTE: this is a copy the positive event
+        std::shared_ptr<Event> neg_event = ((*it)->event_type_ == EventType::NEGATIVE) ?
+            *it : makeEvent<NegativeEvent>(*it);
+
+        // Anti-messages which annihilate their positive events are never scheduled
+        auto status = event_set_->insertEvent(receiver_lp_id, neg_event);
+        countInsertStatus(status);
+        if (status != InsertStatus::Annihilated) {
+            min_timestamp = std::min(min_timestamp, neg_event->timestamp());
+        }
+    }
+    event_set_->releaseInputQueueLock(receiver_lp_id);
+
+    // Make sure to track sends if we are in the middle of a GVT calculation.
+    if (min_timestamp != std::numeric_limits<unsigned int>::max()) {
+        gvt_manager_->reportThreadSendMin(min_timestamp, thread_id);
+    }
+}
+
+void TimeWarpEventDispatcher::sendCancelMessage(std::unique_ptr<EventCancelMessage> cancel_msg,
+    const std::shared_ptr<Event>& lowest_event) {
+
+    cancel_msg->color_ = gvt_manager_->sendEventUpdate(lowest_event, thread_id);
+    termination_manager_->updateMsgCount(1);
+    comm_manager_->insertMessage(std::move(cancel_msg));
+
+    gvt_manager_->reportThreadSendMin(lowest_event->timestamp(), thread_id);
+}
+
+void TimeWarpEventDispatcher::rollback(const std::shared_ptr<Event>& straggler_event) {
+
+    unsigned int local_lp_id = local_lp_id_by_global_id_[straggler_event->receiver_id_];
+    LogicalProcess* current_lp = lps_[local_lp_id];
 
     // Statistics count
     if (straggler_event->event_type_ == EventType::POSITIVE) {
@@ -457,8 +728,10 @@ void TimeWarpEventDispatcher::rollback(std::shared_ptr<Event> straggler_event) {
 
     // Move processed events larger  than straggler back to input queue.
     event_set_->acquireInputQueueLock(local_lp_id);
-    event_set_->rollback(local_lp_id, straggler_event);
+    unsigned int num_rolled_back = event_set_->rollback(local_lp_id, straggler_event);
     event_set_->releaseInputQueueLock(local_lp_id);
+    tw_stats_->upCount(EVENTS_ROLLEDBACK, thread_id, num_rolled_back);
+    gvt_manager_->countRolledBackEvents(thread_id, num_rolled_back);
 
     // Restore state by getting most recent saved state before the straggler and coast forwarding.
     auto restored_state_event = state_manager_->restoreState(straggler_event, local_lp_id,
@@ -475,29 +748,140 @@ void TimeWarpEventDispatcher::rollback(std::shared_ptr<Event> straggler_event) {
     coastForward(straggler_event, restored_state_event);
 }
 
-void TimeWarpEventDispatcher::coastForward(std::shared_ptr<Event> straggler_event, 
-                                            std::shared_ptr<Event> restored_state_event) {
+unsigned int TimeWarpEventDispatcher::throttleTimestamp() {
 
-    LogicalProcess* lp = lps_by_name_[straggler_event->receiverName()];
-    unsigned int current_lp_id = local_lp_id_by_name_[straggler_event->receiverName()];
+    unsigned int gvt = gvt_manager_->getGVT();
+    optimism_throttle_.update(thread_id, gvt, tw_stats_->localCount(EVENTS_PROCESSED, thread_id),
+        tw_stats_->localCount(EVENTS_ROLLEDBACK, thread_id));
+
+    return optimism_throttle_.maxTimestamp(thread_id, gvt);
+}
+
+/*
+ *  NOTE: The held back events stay in the schedule queue, so the thread reports the lowest of
+ *        them for the GVT as if it had taken it. The GVT therefore cannot pass them, and the
+ *        lowest event of all is inside the window once the GVT has caught up with it.
+ */
+void TimeWarpEventDispatcher::holdBackEvents(unsigned int held_timestamp,
+    unsigned int local_gvt_flag, unsigned int& held_back_gvt) {
+
+    if (event_set_->isScheduleQueuePartiallySorted() && local_gvt_flag) {
+        held_timestamp = std::min(held_timestamp, event_set_->lowestTimestamp(thread_id));
+    }
+    gvt_manager_->reportThreadMin(held_timestamp, thread_id, local_gvt_flag);
+
+    // The thread still has events, so it must not be seen as passive
+    if (termination_manager_->threadPassive(thread_id)) {
+        termination_manager_->setThreadActive(thread_id);
+    }
+
+    // Count the held back events once for each GVT they wait for, and ask for the next GVT
+    //  early
+    unsigned int gvt = gvt_manager_->getGVT();
+    if (gvt != held_back_gvt) {
+        held_back_gvt = gvt;
+        tw_stats_->upCount(EVENTS_HELD_BACK, thread_id);
+        gvt_manager_->requestEarlyStart();
+    }
+
+    // The wait is bounded so that new events inside the window are not left for long
+    gvt_manager_->waitForGVTUpdate(gvt, local_gvt_flag, THROTTLE_WAIT);
+}
+
+void TimeWarpEventDispatcher::fossilCollect(unsigned int gvt, unsigned int local_lp_id) {
+
+    lps_[local_lp_id]->last_fossil_collect_gvt_ = gvt;
+
+    // Fossil collect all queues for this lp
+    twfs_manager_->fossilCollect(gvt, local_lp_id);
+    output_manager_->fossilCollect(gvt, local_lp_id);
+
+    unsigned int event_fossil_collect_time = state_manager_->fossilCollect(gvt, local_lp_id);
+
+    unsigned int num_committed = event_set_->fossilCollect(event_fossil_collect_time, local_lp_id);
+
+    tw_stats_->upCount(EVENTS_COMMITTED, thread_id, num_committed);
+    gvt_manager_->countCommittedEvents(thread_id, num_committed);
+}
+
+/*
+ *  NOTE: Each worker thread sweeps the lps whose local ids are congruent to its id, a batch of
+ *        them per pass of its loop, so the cost of fossil collection is spread over the
+ *        events and lps which receive no events are collected as well.
+ *
+ *  NOTE: An lp is claimed by taking its scheduled event out of the schedule queue under its input
+ *        queue lock. If a worker thread is processing the lp the event is not in the queue, and
+ *        the lp is left for the next sweep. While the event is out of the queue, it is part of
+ *        the GVT report of this thread, so an lp is only claimed before this thread reports in
+ *        a GVT epoch. It is reported again once the lp is scheduled again, for an epoch which
+ *        started in between.
+ */
+void TimeWarpEventDispatcher::collectFossilBatch(unsigned int& sweep_gvt,
+                                                 unsigned int& next_lp_id) {
+
+    unsigned int gvt = gvt_manager_->getGVT();
+    if (gvt != sweep_gvt) {
+        sweep_gvt = gvt;
+        next_lp_id = thread_id;
+    }
+
+    unsigned int num_collected = 0;
+    while ((num_collected < fossil_batch_size_) && (next_lp_id < num_local_lps_)) {
+
+        if (lps_[next_lp_id]->last_fossil_collect_gvt_ < gvt) {
+            event_set_->acquireInputQueueLock(next_lp_id);
+            auto scheduled_event = event_set_->scheduledEvent(next_lp_id);
+            if (scheduled_event == nullptr) {
+                fossilCollect(gvt, next_lp_id);
+
+            } else if (gvt_manager_->reportThreadClaimMin(scheduled_event->timestamp(),
+                                                          thread_id)) {
+                if (event_set_->pauseScheduling(next_lp_id)) {
+                    fossilCollect(gvt, next_lp_id);
+                    event_set_->resumeScheduling(next_lp_id);
+                }
+                gvt_manager_->reportThreadSendMin(scheduled_event->timestamp(), thread_id);
+
+            } else {
+                // Try again once this GVT epoch is over
+                event_set_->releaseInputQueueLock(next_lp_id);
+                return;
+            }
+            event_set_->releaseInputQueueLock(next_lp_id);
+            num_collected++;
+        }
+        next_lp_id += num_worker_threads_;
+    }
+}
+
+void TimeWarpEventDispatcher::coastForward(const std::shared_ptr<Event>& straggler_event,
+                                           const std::shared_ptr<Event>& restored_state_event) {
+
+    unsigned int current_lp_id = local_lp_id_by_global_id_[straggler_event->receiver_id_];
+    LogicalProcess* lp = lps_[current_lp_id];
 
     auto events = event_set_->getEventsForCoastForward(current_lp_id, straggler_event,
         restored_state_event);
 
-    // NOTE: events are in order from LARGEST to SMALLEST, so reprocess backwards
-    for (auto event_riterator = events->rbegin();
-                    event_riterator != events->rend(); event_riterator++) {
+    auto start = std::chrono::steady_clock::now();
 
-        assert(**event_riterator <= *straggler_event);
+    // NOTE: events are in order from SMALLEST to LARGEST
+    for (std::size_t i = 0; i < events.size(); i++) {
 
-        // This just updates state, ignore new events
-        lp->receiveEvent(**event_riterator);
+        assert(*events[i] <= *straggler_event);
 
-        tw_stats_->upCount(COAST_FORWARDED_EVENTS, thread_id);
+        // This just updates state, ignore new events
+        lp->receiveEvent(*events[i]);
 
         // NOTE: Do not send any new events
         // NOTE: All coast forward events are already in processed queue, they were never removed.
     }
+
+    auto stop = std::chrono::steady_clock::now();
+    state_manager_->coastForwardDone(current_lp_id, events.size(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+
+    tw_stats_->upCount(COAST_FORWARDED_EVENTS, thread_id, events.size());
 }
 
 void
@@ -510,17 +894,23 @@ TimeWarpEventDispatcher::initialize(const std::vector<std::vector<LogicalProcess
         num_local_lps_ += p.size();
     }
 
-    event_set_->initialize(lps, num_local_lps_, is_lp_migration_on_, num_worker_threads_);
+    event_set_->initialize(lps, num_local_lps_, is_lp_migration_on_, num_worker_threads_,
+                           output_manager_->canHoldEvents());
+    optimism_throttle_.initialize(num_worker_threads_);
 
-    unsigned int lp_id = 0;
+    unsigned int num_global_ids = 0;
     for (auto& partition : lps) {
         for (auto& lp : partition) {
-            lps_by_name_[lp->name_] = lp;
-            local_lp_id_by_name_[lp->name_] = lp_id;
-            lp_id++;
+            lps_.push_back(lp);
+            num_global_ids = std::max(num_global_ids, lp->id_ + 1);
         }
     }
 
+    local_lp_id_by_global_id_.assign(num_global_ids, (unsigned int)-1);
+    for (unsigned int lp_id = 0; lp_id < num_local_lps_; lp_id++) {
+        local_lp_id_by_global_id_[lps_[lp_id]->id_] = lp_id;
+    }
+
     // Creates the state queues, output queues, and filestream queues for each local lp
     state_manager_->initialize(num_local_lps_);
     output_manager_->initialize(num_local_lps_);
@@ -530,6 +920,8 @@ TimeWarpEventDispatcher::initialize(const std::vector<std::vector<LogicalProcess
     gvt_manager_->initialize();
     termination_manager_->initialize(num_worker_threads_);
     WARPED_REGISTER_MSG_HANDLER(TimeWarpEventDispatcher, receiveEventMessage, EventMessage);
+    WARPED_REGISTER_MSG_HANDLER(TimeWarpEventDispatcher, receiveEventCancelMessage,
+        EventCancelMessage);
 
     // Initialize statistics data structures
     tw_stats_->initialize(num_worker_threads_, num_local_lps_);
@@ -540,7 +932,7 @@ TimeWarpEventDispatcher::initialize(const std::vector<std::vector<LogicalProcess
     auto initial_event = std::make_shared<InitialEvent>();
     for (auto& partition : lps) {
         for (auto& lp : partition) {
-            unsigned int lp_id = local_lp_id_by_name_[lp->name_];
+            unsigned int lp_id = local_lp_id_by_global_id_[lp->id_];
             auto new_events = lp->initializeLP();
             sendEvents(initial_event, new_events, lp_id, lp);
             state_manager_->saveState(initial_event, lp_id, lp);
@@ -565,17 +957,17 @@ TimeWarpEventDispatcher::initialize(const std::vector<std::vector<LogicalProcess
 FileStream& TimeWarpEventDispatcher::getFileStream(LogicalProcess *lp,
     const std::string& filename, std::ios_base::openmode mode, std::shared_ptr<Event> this_event) {
 
-    unsigned int local_lp_id = local_lp_id_by_name_[lp->name_];
+    unsigned int local_lp_id = local_lp_id_by_global_id_[lp->id_];
 
     return *twfs_manager_->getFileStream(filename, mode, local_lp_id, this_event);
 }
 
-void TimeWarpEventDispatcher::enqueueRemoteEvent(std::shared_ptr<Event> event,
+void TimeWarpEventDispatcher::enqueueRemoteEvent(const std::shared_ptr<Event>& event,
     unsigned int receiver_id) {
 
     if (event->timestamp() <= max_sim_time_) {
 
-        Color color = gvt_manager_->sendEventUpdate(event);
+        Color color = gvt_manager_->sendEventUpdate(event, thread_id);
 
         auto event_msg = make_unique<EventMessage>(comm_manager_->getID(), receiver_id, event, color);
         termination_manager_->updateMsgCount(1);
@@ -11,6 +11,8 @@
 #endif
 
 #include <atomic>
+#include <barrier>
+#include <chrono>
 #include <memory>
 #include <unordered_map>
 #include <string>
@@ -24,6 +26,9 @@
 #include "TimeWarpCommunicationManager.hpp"
 #include "TimeWarpStatistics.hpp"
 #include "CircularList.hpp"
+#include "ThreadAffinity.hpp"
+#include "OptimismThrottle.hpp"
+#include "cereal/types/vector.hpp"
 
 namespace warped {
 
@@ -36,7 +41,9 @@ class TimeWarpFileStreamManager;
 class TimeWarpEventSet;
 class TimeWarpGVTManager;
 class TimeWarpTerminationManager;
+struct EventCancelMessage;
 enum class Color;
+enum class InsertStatus;
 
 // This is the EventDispatcher that will run a Time Warp synchronized parallel simulation.
 
@@ -45,6 +52,10 @@ public:
     TimeWarpEventDispatcher(unsigned int max_sim_time,
         unsigned int num_worker_threads,
         bool is_lp_migration_on,
+        ThreadAffinityPolicy thread_affinity_policy,
+        OptimismThrottle optimism_throttle,
+        bool is_fossil_collection_batched,
+        unsigned int fossil_batch_size,
         std::shared_ptr<TimeWarpCommunicationManager> comm_manager,
         std::unique_ptr<TimeWarpEventSet> event_set,
         std::unique_ptr<TimeWarpGVTManager> gvt_manager,
@@ -57,25 +68,53 @@ public:
     void startSimulation(const std::vector<std::vector<LogicalProcess*>>& lps);
 
 private:
-    void sendEvents(std::shared_ptr<Event> source_event, std::vector<std::shared_ptr<Event>> new_events,
+    void sendEvents(const std::shared_ptr<Event>& source_event,
+                    const std::vector<std::shared_ptr<Event>>& new_events,
                     unsigned int sender_lp_id, LogicalProcess *sender_lp);
 
-    void sendLocalEvent(std::shared_ptr<Event> event);
+    void sendLocalEvent(const std::shared_ptr<Event>& event);
+
+    void countInsertStatus(InsertStatus status);
 
     void cancelEvents(std::unique_ptr<std::vector<std::shared_ptr<Event>>> events_to_cancel);
 
-    void rollback(std::shared_ptr<Event> straggler_event);
+    // Cancels events which are all sent to the same local lp, holding its input queue lock once
+    void cancelLocalEvents(std::vector<std::shared_ptr<Event>>::iterator first,
+                           std::vector<std::shared_ptr<Event>>::iterator last);
+
+    void sendCancelMessage(std::unique_ptr<EventCancelMessage> cancel_msg,
+                           const std::shared_ptr<Event>& lowest_event);
+
+    void rollback(const std::shared_ptr<Event>& straggler_event);
+
+    // Adapts the optimism throttle of this thread to the GVT and returns the largest timestamp
+    // of the positive events it may process
+    unsigned int throttleTimestamp();
+
+    // Waits for the GVT to advance while the lowest events of this thread's schedule queue,
+    // the lowest at held_timestamp, are too far ahead of it
+    void holdBackEvents(unsigned int held_timestamp, unsigned int local_gvt_flag,
+                        unsigned int& held_back_gvt);
+
+    // Fossil collects all queues of an lp. Called by the thread which holds the lp.
+    void fossilCollect(unsigned int gvt, unsigned int local_lp_id);
+
+    // Fossil collects the next lps of this thread's share which are not being processed, so
+    // idle lps are collected too. The sweep restarts when the GVT changes.
+    void collectFossilBatch(unsigned int& sweep_gvt, unsigned int& next_lp_id);
 
-    void coastForward(std::shared_ptr<Event> stop_event, 
-                            std::shared_ptr<Event> restored_state_event);
+    void coastForward(const std::shared_ptr<Event>& stop_event,
+                      const std::shared_ptr<Event>& restored_state_event);
 
     FileStream& getFileStream(LogicalProcess *lp, const std::string& filename,
         std::ios_base::openmode mode, std::shared_ptr<Event> this_event);
 
-    void enqueueRemoteEvent(std::shared_ptr<Event> event, unsigned int receiver_id);
+    void enqueueRemoteEvent(const std::shared_ptr<Event>& event, unsigned int receiver_id);
 
     void processEvents(unsigned int id);
 
+    void placeWorkerThread();
+
 #ifdef TIMEWARP_EVENT_LOG
     std::string eventLogFileName(unsigned int thread_id) {
         return "eventlog_worker_" + std::to_string(thread_id) + ".csv";
@@ -88,6 +127,8 @@ private:
 
     void receiveEventMessage(std::unique_ptr<TimeWarpKernelMessage> kmsg);
 
+    void receiveEventCancelMessage(std::unique_ptr<TimeWarpKernelMessage> kmsg);
+
     void onGVT(unsigned int gvt);
 
 /* ============================================================================ */
@@ -96,8 +137,24 @@ private:
     bool is_lp_migration_on_;
     unsigned int num_local_lps_;
 
-    std::unordered_map<std::string, LogicalProcess*> lps_by_name_;
-    std::unordered_map<std::string, unsigned int> local_lp_id_by_name_;
+    // Placement of the worker threads and their queues on the cores
+    ThreadAffinity thread_affinity_;
+
+    // Time window above the GVT in which the worker threads process events
+    OptimismThrottle optimism_throttle_;
+
+    // Fossil collection in batches of lps per worker thread instead of after each event
+    bool is_fossil_collection_batched_;
+    unsigned int fossil_batch_size_;
+
+    // Holds back all threads until every worker thread has placed its queues
+    std::unique_ptr<std::barrier<>> placement_barrier_;
+
+    // Local lps indexed by local lp id
+    std::vector<LogicalProcess*> lps_;
+
+    // Local lp id indexed by global lp id
+    std::vector<unsigned int> local_lp_id_by_global_id_;
 
 #ifdef TIMEWARP_EVENT_LOG
     // Event log for each worker thread
@@ -114,6 +171,12 @@ private:
     const std::unique_ptr<TimeWarpStatistics> tw_stats_;
 
     static THREAD_LOCAL_SPECIFIER unsigned int thread_id;
+
+    // Largest number of anti-messages sent in one EventCancelMessage
+    static constexpr std::size_t MAX_CANCEL_MESSAGE_EVENTS = 8;
+
+    // Longest wait of a worker thread whose events are held back by the optimism throttle
+    static constexpr std::chrono::microseconds THROTTLE_WAIT {100};
 };
 
 struct EventMessage : public TimeWarpKernelMessage {
@@ -133,6 +196,48 @@ struct EventMessage : public TimeWarpKernelMessage {
         color_)
 };
 
+// Anti-messages for a batch of events sent to lps on the same node. Only the fields which make
+// up the comparison key of each event are sent, so no event objects have to be serialized. The
+// events are grouped by sender and receiver, and the ids of both are sent once per group.
+struct EventCancelMessage : public TimeWarpKernelMessage {
+    EventCancelMessage() = default;
+    EventCancelMessage(unsigned int sender, unsigned int receiver) :
+        TimeWarpKernelMessage(sender, receiver) {}
+
+    // Events of the same sender and receiver must be added one after another to share a group
+    void addEvent(const Event& event) {
+        if ((group_ == keys_.size()) || (keys_[group_] != event.sender_id_) ||
+                (keys_[group_+1] != event.receiver_id_)) {
+            group_ = keys_.size();
+            keys_.insert(keys_.end(), {event.sender_id_, event.receiver_id_, 0});
+        }
+        keys_[group_+2]++;
+        keys_.insert(keys_.end(), {event.timestamp(), event.send_time_,
+            static_cast<unsigned int>(event.generation_)});
+        num_events_++;
+    }
+
+    // Number of events added by the sender
+    std::size_t size() const { return num_events_; }
+
+    // Sender id, receiver id and number of events of each group, followed by the receive time,
+    // send time and generation of each of its events
+    // NOTE: Only the lower bits of the generation are part of the key, so the rest is not sent.
+    static constexpr std::size_t FIELDS_PER_GROUP = 3;
+    static constexpr std::size_t FIELDS_PER_EVENT = 3;
+    std::vector<unsigned int> keys_;
+    Color color_;
+
+    // Start of the group being filled, and number of events added
+    std::size_t group_ = 0;
+    std::size_t num_events_ = 0;
+
+    MessageType get_type() { return MessageType::EventCancelMessage; }
+
+    WARPED_REGISTER_SERIALIZABLE_MEMBERS(cereal::base_class<TimeWarpKernelMessage>(this), keys_,
+        color_)
+};
+
 } // namespace warped
 
 #endif
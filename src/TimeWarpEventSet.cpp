@@ -10,11 +10,14 @@ namespace warped {
 void TimeWarpEventSet::initialize (const std::vector<std::vector<LogicalProcess*>>& lps,
                                    unsigned int num_of_lps,
                                    bool is_lp_migration_on,
-                                   unsigned int num_of_worker_threads) {
+                                   unsigned int num_of_worker_threads,
+                                   bool are_outputs_held) {
 
     num_of_lps_         = num_of_lps;
     num_of_schedulers_  = lps.size();
+    num_of_worker_threads_ = num_of_worker_threads;
     is_lp_migration_on_ = is_lp_migration_on;
+    are_outputs_held_   = are_outputs_held;
 
     /* Create the input and processed queues and their locks.
        Also create the input queue-scheduler map and scheduled event pointer. */
@@ -27,31 +30,33 @@ void TimeWarpEventSet::initialize (const std::vector<std::vector<LogicalProcess*
 
     for (unsigned int scheduler_id = 0; scheduler_id < lps.size(); scheduler_id++) {
         for (unsigned int lp_id = 0; lp_id < lps[scheduler_id].size(); lp_id++) {
-            input_queue_.push_back(
-                    make_unique<std::multiset<std::shared_ptr<Event>, compareEvents>>());
-            processed_queue_.push_back(make_unique<std::deque<std::shared_ptr<Event>>>());
+            input_queue_.emplace_back();
+            processed_queue_.emplace_back();
             scheduled_event_pointer_.push_back(nullptr);
+            rolled_back_event_.push_back(nullptr);
             input_queue_scheduler_map_.push_back(scheduler_id);
         }
     }
 
     /* Create the schedule queues */
+    threads_per_scheduler_ =
+        (num_of_worker_threads + num_of_schedulers_ - 1) / num_of_schedulers_;
     for (unsigned int scheduler_id = 0; scheduler_id < num_of_schedulers_; scheduler_id++) {
-#if defined(SORTED_LADDER_QUEUE) || defined(PARTIALLY_SORTED_LADDER_QUEUE)
-        schedule_queue_.push_back(make_unique<LadderQueue>());
-#elif defined(SPLAY_TREE)
-        schedule_queue_.push_back(make_unique<SplayTree>());
-#elif defined(CIRCULAR_QUEUE)
-        schedule_queue_.push_back(make_unique<CircularQueue>( lps[scheduler_id].size() ));
-#else
-        schedule_queue_.push_back(
-                make_unique<std::multiset<std::shared_ptr<Event>, compareEvents>>());
-#endif
+        schedule_queue_.push_back(make_unique<ScheduleQueue>(schedule_queue_type_,
+                                        lps[scheduler_id].size(), threads_per_scheduler_));
     }
+    is_schedule_queue_concurrent_ =
+        !schedule_queue_.empty() && schedule_queue_[0]->isConcurrent();
 
     /* Map worker threads to schedule queues. */
     for (unsigned int thread_id = 0; thread_id < num_of_worker_threads; thread_id++) {
         worker_thread_scheduler_map_.push_back(thread_id % num_of_schedulers_);
+        steal_seed_.push_back(thread_id + 1);
+    }
+
+    /* Nothing to steal from with a single schedule queue */
+    if (num_of_schedulers_ < 2) {
+        work_stealing_policy_ = WorkStealingPolicy::None;
     }
 }
 
@@ -71,23 +76,28 @@ void TimeWarpEventSet::releaseInputQueueLock (unsigned int lp_id) {
  *  NOTE: scheduled_event_pointer is also protected by the input queue lock
  */
 InsertStatus TimeWarpEventSet::insertEvent (
-                    unsigned int lp_id, std::shared_ptr<Event> event) {
-    // Always insert event into input queue
-    input_queue_[lp_id]->insert(event);
+                    unsigned int lp_id, const std::shared_ptr<Event>& event) {
+    // An anti-message whose positive event has not been processed cancels it right away
+    if ((event->event_type_ == EventType::NEGATIVE) && annihilateEvent(lp_id, event)) {
+        return InsertStatus::Annihilated;
+    }
+
+    // Otherwise always insert event into input queue
+    input_queue_[lp_id].insert(event);
     unsigned int scheduler_id = input_queue_scheduler_map_[lp_id];
     if (scheduled_event_pointer_[lp_id] == nullptr) {
         // If no event is currently scheduled. This can only happen if the thread that handles
         // events for lp with id == lp_id has determined that there are no more events left in
         // its input queue
-        assert(input_queue_[lp_id]->size() == 1);
-        schedule_queue_lock_[scheduler_id].lock();
+        assert(input_queue_[lp_id].size() == 1);
+        lockScheduleQueue(scheduler_id);
         schedule_queue_[scheduler_id]->insert(event);
-        schedule_queue_lock_[scheduler_id].unlock();
+        unlockScheduleQueue(scheduler_id);
         scheduled_event_pointer_[lp_id] = event;
         return InsertStatus::StarvedObject;
     }
 
-    auto smallest_event = *input_queue_[lp_id]->begin();
+    const auto& smallest_event = *input_queue_[lp_id].begin();
     if (smallest_event == scheduled_event_pointer_[lp_id]) {
         return InsertStatus::LpOnly;
     }
@@ -95,12 +105,8 @@ InsertStatus TimeWarpEventSet::insertEvent (
     // If the pointer comparison of the smallest event does not match scheduled event, well
     // that means we should update the schedule queue...
     auto ret = InsertStatus::SchedEventSwapSuccess;
-    schedule_queue_lock_[scheduler_id].lock();
-#if defined(CIRCULAR_QUEUE)
-    if (schedule_queue_[scheduler_id]->deactivate(scheduled_event_pointer_[lp_id])) {
-#else
+    lockScheduleQueue(scheduler_id);
     if (schedule_queue_[scheduler_id]->erase(scheduled_event_pointer_[lp_id])) {
-#endif
         // ...but only if the event was successfully erased from the schedule queue. If it is
         // not then the event is already being processed and a rollback will have to occur.
         schedule_queue_[scheduler_id]->insert(smallest_event);
@@ -108,39 +114,64 @@ InsertStatus TimeWarpEventSet::insertEvent (
     } else {
         ret = InsertStatus::SchedEventSwapFailure;
     }
-    schedule_queue_lock_[scheduler_id].unlock();
+    unlockScheduleQueue(scheduler_id);
     return ret;
 }
 
 /*
  *  NOTE: caller must always have the input queue lock for the lp with id lp_id
  */
-std::shared_ptr<Event> TimeWarpEventSet::getEvent (unsigned int thread_id) {
+bool TimeWarpEventSet::annihilateEvent (unsigned int lp_id,
+                                        const std::shared_ptr<Event>& cancel_event) {
+
+    // A positive event sorts right after its anti-message
+    auto pos_iterator = input_queue_[lp_id].lower_bound(cancel_event);
+    if ((pos_iterator == input_queue_[lp_id].end()) || !(**pos_iterator == *cancel_event) ||
+            ((*pos_iterator)->event_type_ != EventType::POSITIVE)) {
+        return false;
+    }
 
-    unsigned int scheduler_id = worker_thread_scheduler_map_[thread_id];
+    // The events sent by a rolled back event may be held back by lazy cancellation. They are
+    // only cancelled once the lp has processed the event again or its anti-message.
+    if (rolled_back_event_[lp_id] && (**pos_iterator <= *rolled_back_event_[lp_id])) {
+        return false;
+    }
 
-    schedule_queue_lock_[scheduler_id].lock();
+    if (*pos_iterator != scheduled_event_pointer_[lp_id]) {
+        input_queue_[lp_id].erase(pos_iterator);
+        return true;
+    }
 
-#if defined(SORTED_LADDER_QUEUE) || defined(PARTIALLY_SORTED_LADDER_QUEUE)
-    auto event = schedule_queue_[scheduler_id]->dequeue();
+    // The scheduled event can only be removed if it is still in the schedule queue. If it is
+    // not then it is already being processed and the anti-message will cause a rollback.
+    unsigned int scheduler_id = input_queue_scheduler_map_[lp_id];
+    lockScheduleQueue(scheduler_id);
+    if (!schedule_queue_[scheduler_id]->erase(scheduled_event_pointer_[lp_id])) {
+        unlockScheduleQueue(scheduler_id);
+        return false;
+    }
 
-#elif defined(SPLAY_TREE)
-    auto event = schedule_queue_[scheduler_id]->begin();
-    if (event != nullptr) {
-        schedule_queue_[scheduler_id]->erase(event);
+    input_queue_[lp_id].erase(pos_iterator);
+    if (!input_queue_[lp_id].empty()) {
+        scheduled_event_pointer_[lp_id] = *input_queue_[lp_id].begin();
+        schedule_queue_[scheduler_id]->insert(scheduled_event_pointer_[lp_id]);
+    } else {
+        scheduled_event_pointer_[lp_id] = nullptr;
     }
+    unlockScheduleQueue(scheduler_id);
+    return true;
+}
 
-#elif defined(CIRCULAR_QUEUE)
-    auto event = schedule_queue_[scheduler_id]->pop_front();
+/*
+ *  NOTE: caller must always have the input queue lock for the lp with id lp_id
+ */
+std::shared_ptr<Event> TimeWarpEventSet::getEvent (unsigned int thread_id, bool& is_stolen,
+        unsigned int max_timestamp, unsigned int& held_timestamp) {
 
-#else  /* STL MultiSet */
-    auto event_iterator = schedule_queue_[scheduler_id]->begin();
-    auto event = (event_iterator != schedule_queue_[scheduler_id]->end()) ?
-                    *event_iterator : nullptr;
-    if (event != nullptr) {
-        schedule_queue_[scheduler_id]->erase(event_iterator);
-    }
-#endif
+    unsigned int scheduler_id = worker_thread_scheduler_map_[thread_id];
+    is_stolen = false;
+
+    auto event = popEvent(scheduler_id, max_timestamp, held_timestamp);
 
     // NOTE: scheduled_event_pointer is not changed here so that other threads will not schedule new
     // events and this thread can move events into processed queue and update schedule queue correctly.
@@ -149,59 +180,161 @@ std::shared_ptr<Event> TimeWarpEventSet::getEvent (unsigned int thread_id) {
     // then, a rollback will bring the processed positive event back to input queue and they will
     // be cancelled.
 
-    schedule_queue_lock_[scheduler_id].unlock();
+    if ((event == nullptr) && (work_stealing_policy_ != WorkStealingPolicy::None)) {
+        event = stealEvent(thread_id, max_timestamp, held_timestamp);
+        is_stolen = (event != nullptr);
+    }
 
     return event;
 }
 
-#ifdef PARTIALLY_SORTED_LADDER_QUEUE
 /*
- *  NOTE: This is needed only for partially unsorted ladder queue
+ *  NOTE: A held back event is back in the queue before the lock is released, so no other
+ *        thread sees the queue without it
+ */
+std::shared_ptr<Event> TimeWarpEventSet::popEvent (unsigned int scheduler_id,
+        unsigned int max_timestamp, unsigned int& held_timestamp) {
+
+    lockScheduleQueue(scheduler_id);
+
+    auto event = schedule_queue_[scheduler_id]->pop(max_timestamp, held_timestamp);
+
+    unlockScheduleQueue(scheduler_id);
+
+    return event;
+}
+
+/*
+ *  NOTE: The stolen event stays mapped to its own schedule queue, so the next event of that
+ *        lp is scheduled on the victim's queue again by replenishScheduler().
+ */
+std::shared_ptr<Event> TimeWarpEventSet::stealEvent (unsigned int thread_id,
+        unsigned int max_timestamp, unsigned int& held_timestamp) {
+
+    unsigned int scheduler_id = worker_thread_scheduler_map_[thread_id];
+
+    unsigned int offset = 0;
+    if (work_stealing_policy_ == WorkStealingPolicy::Random) {
+        unsigned int& seed = steal_seed_[thread_id];
+        seed = seed * 1103515245 + 12345;
+        offset = (seed >> 16) % (num_of_schedulers_ - 1);
+    }
+
+    for (unsigned int i = 0; i < num_of_schedulers_ - 1; i++) {
+        unsigned int victim_id =
+            (scheduler_id + 1 + (offset + i) % (num_of_schedulers_ - 1)) % num_of_schedulers_;
+
+        auto event = popEvent(victim_id, max_timestamp, held_timestamp);
+        if (event != nullptr) {
+            return event;
+        }
+    }
+    return nullptr;
+}
+
+bool TimeWarpEventSet::isScheduleQueuePartiallySorted () {
+
+    return ((schedule_queue_type_ == ScheduleQueueType::PartiallySortedLadderQueue) ||
+            (schedule_queue_type_ == ScheduleQueueType::MultiQueue));
+}
+
+bool TimeWarpEventSet::isScheduleQueueRelaxed () {
+
+    return (schedule_queue_type_ == ScheduleQueueType::MultiQueue);
+}
+
+/*
+ *  NOTE: This is needed only for partially sorted schedule queues
  */
 unsigned int TimeWarpEventSet::lowestTimestamp (unsigned int thread_id) {
 
     unsigned int scheduler_id = worker_thread_scheduler_map_[thread_id];
     return schedule_queue_[scheduler_id]->lowestTimestamp();
 }
-#endif
+
+/*
+ *  NOTE: The first worker thread of a schedule queue places it. Worker thread i is mapped to
+ *        schedule queue i % num_of_schedulers_, so that is thread scheduler_id when there are
+ *        enough worker threads.
+ */
+unsigned int TimeWarpEventSet::placementThread (unsigned int lp_id) {
+
+    return input_queue_scheduler_map_[lp_id] % num_of_worker_threads_;
+}
+
+/*
+ *  NOTE: No other thread may use the event set while this runs
+ */
+void TimeWarpEventSet::placeQueues (unsigned int thread_id) {
+
+    std::vector<unsigned int> num_lps(num_of_schedulers_, 0);
+
+    for (unsigned int lp_id = 0; lp_id < num_of_lps_; lp_id++) {
+        num_lps[input_queue_scheduler_map_[lp_id]]++;
+        if (placementThread(lp_id) == thread_id) {
+            input_queue_[lp_id] = PendingEventQueue(input_queue_[lp_id]);
+        }
+    }
+
+    for (unsigned int scheduler_id = thread_id; scheduler_id < num_of_schedulers_;
+                                                scheduler_id += num_of_worker_threads_) {
+        auto queue = make_unique<ScheduleQueue>(schedule_queue_type_,
+                                            num_lps[scheduler_id], threads_per_scheduler_);
+        while (auto event = schedule_queue_[scheduler_id]->pop()) {
+            queue->insert(event);
+        }
+        schedule_queue_[scheduler_id] = std::move(queue);
+    }
+}
 
 /*
  *  NOTE: caller must have the input queue lock for the lp with id lp_id
  */
 std::shared_ptr<Event> TimeWarpEventSet::lastProcessedEvent (unsigned int lp_id) {
 
-    return ((processed_queue_[lp_id]->size()) ? processed_queue_[lp_id]->back() : nullptr);
+    return ((processed_queue_[lp_id].size()) ? processed_queue_[lp_id].back() : nullptr);
 }
 
 /*
  *  NOTE: caller must have the input queue lock for the lp with id lp_id
  */
-void TimeWarpEventSet::rollback (unsigned int lp_id, std::shared_ptr<Event> straggler_event) {
+unsigned int TimeWarpEventSet::rollback (unsigned int lp_id,
+                                         const std::shared_ptr<Event>& straggler_event) {
 
     // Every event GREATER OR EQUAL to straggler event must remove from the processed queue and
     // reinserted back into input queue.
     // EQUAL will ensure that a negative message will properly be cancelled out.
 
-    auto event_riterator = processed_queue_[lp_id]->rbegin();  // Starting with largest event
+    auto& processed_queue = processed_queue_[lp_id];
+    auto& input_queue = input_queue_[lp_id];
 
-    while (event_riterator != processed_queue_[lp_id]->rend() && (**event_riterator >= *straggler_event)){
+    // The processed queue is sorted, so the events to move form a single block at the end
+    auto first = processed_queue.lowerBound(*straggler_event);
+    unsigned int count = processed_queue.size() - first;
 
-        auto event = std::move(processed_queue_[lp_id]->back()); // Starting from largest event
-        assert(event);
-        processed_queue_[lp_id]->pop_back();
-        input_queue_[lp_id]->insert(event);
-        event_riterator = processed_queue_[lp_id]->rbegin();
+    if (are_outputs_held_ && count) {
+        auto& rolled_back_event = rolled_back_event_[lp_id];
+        if (!rolled_back_event || (*rolled_back_event < *processed_queue.back())) {
+            rolled_back_event = processed_queue.back();
+        }
     }
+
+    processed_queue.truncate(first, [&input_queue](std::shared_ptr<Event>&& event) {
+        assert(event);
+        input_queue.append(std::move(event));
+    });
+    input_queue.mergeAppended();
+
+    return count;
 }
 
 /*
  *  NOTE: caller must have the input queue lock for the lp with id lp_id
  */
-std::unique_ptr<std::vector<std::shared_ptr<Event>>> 
-    TimeWarpEventSet::getEventsForCoastForward (
+ProcessedEventHistory::Range TimeWarpEventSet::getEventsForCoastForward (
                                 unsigned int lp_id, 
-                                std::shared_ptr<Event> straggler_event, 
-                                std::shared_ptr<Event> restored_state_event) {
+                                const std::shared_ptr<Event>& straggler_event,
+                                const std::shared_ptr<Event>& restored_state_event) {
 
     // To avoid error if asserts are disabled
     unused(straggler_event);
@@ -213,23 +346,20 @@ std::unique_ptr<std::vector<std::shared_ptr<Event>>>
     // It is assumed that all processed events GREATER THAN OR EQUAL to the straggler event have
     // been moved from the processed queue to the input queue with a call to rollback().
     //
-    // All coast forwared events remain in the processed queue.
-
-    // Create empty vector
-    auto events = make_unique<std::vector<std::shared_ptr<Event>>>();
+    // All coast forwared events remain in the processed queue, the returned range refers to
+    // them directly. Events are in order of SMALLEST to LARGEST.
 
-    auto event_riterator = processed_queue_[lp_id]->rbegin();  // Starting with largest event
+    auto& processed_queue = processed_queue_[lp_id];
 
-    while ((event_riterator != processed_queue_[lp_id]->rend()) && (**event_riterator > *restored_state_event)) {
-
-        assert(*event_riterator);
-        assert(**event_riterator < *straggler_event);
-        // Events are in order of LARGEST to SMALLEST
-        events->push_back(*event_riterator);
-        event_riterator++;
+    // First event GREATER THAN the restored state event
+    auto first = processed_queue.lowerBound(*restored_state_event);
+    while ((first < processed_queue.size()) &&
+            (*processed_queue[first] <= *restored_state_event)) {
+        first++;
     }
+    assert(processed_queue.empty() || (*processed_queue.back() < *straggler_event));
 
-    return events;
+    return processed_queue.range(first, processed_queue.size());
 }
 
 /*
@@ -244,17 +374,59 @@ void TimeWarpEventSet::startScheduling (unsigned int lp_id) {
 
     // Just simply add pointer to next event into the scheduler if input queue is not empty
     // for the given lp, otherwise set to nullptr
-    if (!input_queue_[lp_id]->empty()) {
-        scheduled_event_pointer_[lp_id] = *input_queue_[lp_id]->begin();
+    if (!input_queue_[lp_id].empty()) {
+        scheduled_event_pointer_[lp_id] = *input_queue_[lp_id].begin();
         unsigned int scheduler_id = input_queue_scheduler_map_[lp_id];
-        schedule_queue_lock_[scheduler_id].lock();
+        lockScheduleQueue(scheduler_id);
         schedule_queue_[scheduler_id]->insert(scheduled_event_pointer_[lp_id]);
-        schedule_queue_lock_[scheduler_id].unlock();
+        unlockScheduleQueue(scheduler_id);
     } else {
         scheduled_event_pointer_[lp_id] = nullptr;
     }
 }
 
+/*
+ *  NOTE: caller must have the input queue lock for the lp with id lp_id
+ */
+std::shared_ptr<Event> TimeWarpEventSet::scheduledEvent (unsigned int lp_id) {
+
+    return scheduled_event_pointer_[lp_id];
+}
+
+/*
+ *  NOTE: caller must always have the input queue lock for the lp with id lp_id
+ *
+ *  NOTE: An lp without a scheduled event has no events at all, and none can be inserted while
+ *        the caller holds the lock, so no thread can process it either.
+ */
+bool TimeWarpEventSet::pauseScheduling (unsigned int lp_id) {
+
+    if (scheduled_event_pointer_[lp_id] == nullptr) {
+        return true;
+    }
+
+    unsigned int scheduler_id = input_queue_scheduler_map_[lp_id];
+    lockScheduleQueue(scheduler_id);
+    bool is_erased = schedule_queue_[scheduler_id]->erase(scheduled_event_pointer_[lp_id]);
+    unlockScheduleQueue(scheduler_id);
+    return is_erased;
+}
+
+/*
+ *  NOTE: caller must always have the input queue lock for the lp with id lp_id
+ */
+void TimeWarpEventSet::resumeScheduling (unsigned int lp_id) {
+
+    if (scheduled_event_pointer_[lp_id] == nullptr) {
+        return;
+    }
+
+    unsigned int scheduler_id = input_queue_scheduler_map_[lp_id];
+    lockScheduleQueue(scheduler_id);
+    schedule_queue_[scheduler_id]->insert(scheduled_event_pointer_[lp_id]);
+    unlockScheduleQueue(scheduler_id);
+}
+
 /*
  *  NOTE: This can only be called by the thread that handles event for the lp with id lp_id
  *
@@ -269,11 +441,11 @@ void TimeWarpEventSet::replenishScheduler (unsigned int lp_id) {
     assert(scheduled_event_pointer_[lp_id]);
 
     // Move the just processed event to the processed queue
-    auto num_erased = input_queue_[lp_id]->erase(scheduled_event_pointer_[lp_id]);
+    auto num_erased = input_queue_[lp_id].erase(scheduled_event_pointer_[lp_id]);
     assert(num_erased == 1);
     unused(num_erased);
 
-    processed_queue_[lp_id]->push_back(scheduled_event_pointer_[lp_id]);
+    processed_queue_[lp_id].push_back(scheduled_event_pointer_[lp_id]);
 
     // Map the lp to the next schedule queue (cyclic order)
     // This is supposed to balance the load across all the schedule queues
@@ -286,27 +458,29 @@ void TimeWarpEventSet::replenishScheduler (unsigned int lp_id) {
 
     // Update scheduler with new event for the lp the previous event was executed for
     // NOTE: A pointer to the scheduled event will remain in the input queue
-    if (!input_queue_[lp_id]->empty()) {
-        scheduled_event_pointer_[lp_id] = *input_queue_[lp_id]->begin();
-        schedule_queue_lock_[scheduler_id].lock();
+    if (!input_queue_[lp_id].empty()) {
+        scheduled_event_pointer_[lp_id] = *input_queue_[lp_id].begin();
+        lockScheduleQueue(scheduler_id);
         schedule_queue_[scheduler_id]->insert(scheduled_event_pointer_[lp_id]);
-        schedule_queue_lock_[scheduler_id].unlock();
+        unlockScheduleQueue(scheduler_id);
     } else {
         scheduled_event_pointer_[lp_id] = nullptr;
     }
 }
 
-bool TimeWarpEventSet::cancelEvent (unsigned int lp_id, std::shared_ptr<Event> cancel_event) {
+bool TimeWarpEventSet::cancelEvent (unsigned int lp_id,
+                                    const std::shared_ptr<Event>& cancel_event) {
 
     bool found = false;
-    auto neg_iterator = input_queue_[lp_id]->find(cancel_event);
-    assert(neg_iterator != input_queue_[lp_id]->end());
+    auto neg_iterator = input_queue_[lp_id].find(cancel_event);
+    assert(neg_iterator != input_queue_[lp_id].end());
     auto pos_iterator = std::next(neg_iterator);
-    assert(pos_iterator != input_queue_[lp_id]->end());
+    assert(pos_iterator != input_queue_[lp_id].end());
 
     if (**pos_iterator == **neg_iterator) {
-        input_queue_[lp_id]->erase(neg_iterator);
-        input_queue_[lp_id]->erase(pos_iterator);
+        // NOTE: Erase the later event first so that the other iterator stays valid
+        input_queue_[lp_id].erase(pos_iterator);
+        input_queue_[lp_id].erase(neg_iterator);
         found = true;
     }
 
@@ -314,7 +488,7 @@ bool TimeWarpEventSet::cancelEvent (unsigned int lp_id, std::shared_ptr<Event> c
 }
 
 // For debugging
-void TimeWarpEventSet::printEvent(std::shared_ptr<Event> event) {
+void TimeWarpEventSet::printEvent(const std::shared_ptr<Event>& event) {
     std::cout << "\tSender:     " << event->sender_name_                  << "\n"
               << "\tReceiver:   " << event->receiverName()                << "\n"
               << "\tSend time:  " << event->send_time_                    << "\n"
@@ -326,24 +500,22 @@ void TimeWarpEventSet::printEvent(std::shared_ptr<Event> event) {
 unsigned int TimeWarpEventSet::fossilCollect (unsigned int fossil_collect_time, unsigned int lp_id) {
 
     unsigned int count = 0;
+    auto& processed_queue = processed_queue_[lp_id];
 
-    if (processed_queue_[lp_id]->empty()) {
+    if (processed_queue.empty()) {
         return count;
     }
 
     if (fossil_collect_time == (unsigned int)-1) {
-        count = processed_queue_[lp_id]->size();
-        processed_queue_[lp_id]->clear();
+        count = processed_queue.size();
+        processed_queue.clear();
         return count;
     }
 
-    auto event_iterator = processed_queue_[lp_id]->begin();
-    while ((event_iterator != std::prev(processed_queue_[lp_id]->end())) &&
-           ((*event_iterator)->timestamp() < fossil_collect_time)) {
-        processed_queue_[lp_id]->pop_front();
-        event_iterator = processed_queue_[lp_id]->begin();
-        count++;
-    }
+    // Keep the last processed event, it is needed to detect stragglers
+    count = std::min(processed_queue.lowerBound(fossil_collect_time),
+                     processed_queue.size() - 1);
+    processed_queue.pop_front(count);
 
     return count;
 }
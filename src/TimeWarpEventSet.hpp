@@ -6,21 +6,22 @@
  */
 
 #include <vector>
-#include <deque>
 #include <set>
 #include <unordered_map>
 #include <mutex>
 #include <memory>
 #include <atomic>
+#include <limits>
+#include <string>
 
 #include "config.h"
 #include "LogicalProcess.hpp"
 #include "Event.hpp"
 #include "utility/memory.hpp"
 #include "TicketLock.hpp"
-#include "LadderQueue.hpp"
-#include "SplayTree.hpp"
-#include "CircularQueue.hpp"
+#include "ScheduleQueue.hpp"
+#include "PendingEventQueue.hpp"
+#include "ProcessedEventHistory.hpp"
 
 namespace warped {
 
@@ -28,50 +29,146 @@ enum class InsertStatus {
     LpOnly,
     StarvedObject,
     SchedEventSwapSuccess,
-    SchedEventSwapFailure
+    SchedEventSwapFailure,
+    Annihilated             // A negative event removed its positive event instead
 };
 
+// Which sibling schedule queue an idle worker thread steals from
+enum class WorkStealingPolicy {
+    None,       // Never steal
+    Neighbor,   // Try the next schedule queues in order
+    Random      // Try the other schedule queues starting from a random one
+};
+
+// Converts the configuration string to the work stealing policy. Returns false if the string
+// is not a valid policy.
+inline bool workStealingPolicyFromString(const std::string& name, WorkStealingPolicy& policy) {
+    if (name == "none") {
+        policy = WorkStealingPolicy::None;
+    } else if (name == "neighbor") {
+        policy = WorkStealingPolicy::Neighbor;
+    } else if (name == "random") {
+        policy = WorkStealingPolicy::Random;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 class TimeWarpEventSet {
 public:
-    TimeWarpEventSet() = default;
+    TimeWarpEventSet(ScheduleQueueType schedule_queue_type = ScheduleQueueType::MultiSet,
+                     WorkStealingPolicy work_stealing_policy = WorkStealingPolicy::None) :
+        schedule_queue_type_(schedule_queue_type),
+        work_stealing_policy_(work_stealing_policy) {}
 
+    // are_outputs_held is set if the output manager can hold back the events sent by a rolled
+    // back event until it is processed again or cancelled (lazy and dynamic cancellation)
     void initialize (const std::vector<std::vector<LogicalProcess*>>& lps,
                      unsigned int num_of_lps,
                      bool is_lp_migration_on,
-                     unsigned int num_of_worker_threads);
+                     unsigned int num_of_worker_threads,
+                     bool are_outputs_held = false);
 
     void acquireInputQueueLock (unsigned int lp_id);
 
     void releaseInputQueueLock (unsigned int lp_id);
 
-    InsertStatus insertEvent (unsigned int lp_id, std::shared_ptr<Event> event);
+    InsertStatus insertEvent (unsigned int lp_id, const std::shared_ptr<Event>& event);
+
+    // is_stolen is set if the event was taken from another thread's schedule queue. A positive
+    // event above max_timestamp is left in its schedule queue, and held_timestamp is lowered to
+    // its timestamp.
+    std::shared_ptr<Event> getEvent (unsigned int thread_id, bool& is_stolen,
+                                     unsigned int max_timestamp, unsigned int& held_timestamp);
+
+    std::shared_ptr<Event> getEvent (unsigned int thread_id, bool& is_stolen) {
+        unsigned int held_timestamp;
+        return getEvent(thread_id, is_stolen, std::numeric_limits<unsigned int>::max(),
+                        held_timestamp);
+    }
+
+    std::shared_ptr<Event> getEvent (unsigned int thread_id) {
+        bool is_stolen;
+        return getEvent(thread_id, is_stolen);
+    }
+
+    // True if the schedule queues can return events out of order
+    bool isScheduleQueuePartiallySorted ();
 
-    std::shared_ptr<Event> getEvent (unsigned int thread_id);
+    // True if the schedule queues trade ordering for concurrency (multi-queue)
+    bool isScheduleQueueRelaxed ();
 
-#ifdef PARTIALLY_SORTED_LADDER_QUEUE
     unsigned int lowestTimestamp (unsigned int thread_id);
-#endif
+
+    // Schedule queue which the worker thread takes its events from
+    const std::vector<unsigned int>& workerThreadSchedulerMap () {
+        return worker_thread_scheduler_map_;
+    }
+
+    // Worker thread which first touches the queues of the lp with id lp_id
+    unsigned int placementThread (unsigned int lp_id);
+
+    // Reallocates the schedule queues and input queues placed on this worker thread from
+    // the thread itself, so that their memory is local to it (first touch). Must be called
+    // by every worker thread before any thread starts processing events.
+    void placeQueues (unsigned int thread_id);
 
     std::shared_ptr<Event> lastProcessedEvent (unsigned int lp_id);
 
-    void rollback (unsigned int lp_id, std::shared_ptr<Event> straggler_event);
+    // Returns the number of processed events moved back to the input queue
+    unsigned int rollback (unsigned int lp_id, const std::shared_ptr<Event>& straggler_event);
 
-    std::unique_ptr<std::vector<std::shared_ptr<Event>>> getEventsForCoastForward (
+    ProcessedEventHistory::Range getEventsForCoastForward (
                         unsigned int lp_id, 
-                        std::shared_ptr<Event> straggler_event, 
-                        std::shared_ptr<Event> restored_state_event);
+                        const std::shared_ptr<Event>& straggler_event,
+                        const std::shared_ptr<Event>& restored_state_event);
 
     void startScheduling (unsigned int lp_id);
 
+    // Lowest unprocessed event of the lp, which is in its schedule queue unless a worker thread
+    // has taken it. nullptr if the lp has no events.
+    std::shared_ptr<Event> scheduledEvent (unsigned int lp_id);
+
+    // Takes the scheduled event of the lp out of its schedule queue, so that no worker thread
+    // can process the lp until resumeScheduling() is called. Returns false if a worker thread
+    // has already taken the event. The caller must hold the input queue lock of the lp until
+    // scheduling is resumed, and must account for the event in the GVT while it is paused.
+    bool pauseScheduling (unsigned int lp_id);
+
+    void resumeScheduling (unsigned int lp_id);
+
     void replenishScheduler (unsigned int lp_id);
 
-    bool cancelEvent (unsigned int lp_id, std::shared_ptr<Event> cancel_event);
+    bool cancelEvent (unsigned int lp_id, const std::shared_ptr<Event>& cancel_event);
 
-    void printEvent (std::shared_ptr<Event> event);
+    void printEvent (const std::shared_ptr<Event>& event);
 
     unsigned int fossilCollect (unsigned int fossil_collect_time, unsigned int lp_id);
 
 private:
+    // Concurrent schedule queues do their own locking
+    void lockScheduleQueue (unsigned int scheduler_id) {
+        if (!is_schedule_queue_concurrent_) schedule_queue_lock_[scheduler_id].lock();
+    }
+
+    void unlockScheduleQueue (unsigned int scheduler_id) {
+        if (!is_schedule_queue_concurrent_) schedule_queue_lock_[scheduler_id].unlock();
+    }
+
+    // Takes the lowest event of a schedule queue, unless it is held back as in getEvent
+    std::shared_ptr<Event> popEvent (unsigned int scheduler_id, unsigned int max_timestamp,
+                                     unsigned int& held_timestamp);
+
+    std::shared_ptr<Event> stealEvent (unsigned int thread_id, unsigned int max_timestamp,
+                                       unsigned int& held_timestamp);
+
+    // Removes the positive event which cancel_event cancels if no worker thread has taken it
+    // yet, so that the anti-message never has to be scheduled. Returns true if it did. A
+    // rolled back event whose sent events may be held back is never removed, its anti-message
+    // must be processed by the lp to release them.
+    bool annihilateEvent (unsigned int lp_id, const std::shared_ptr<Event>& cancel_event);
+
     // Number of lps
     unsigned int num_of_lps_ = 0;
 
@@ -79,16 +176,18 @@ private:
     std::unique_ptr<std::mutex []> input_queue_lock_;
 
     // Queues to hold the unprocessed events for each lp
-    std::vector<std::unique_ptr<std::multiset<std::shared_ptr<Event>, 
-                                            compareEvents>>> input_queue_;
+    std::vector<PendingEventQueue> input_queue_;
 
     // Queues to hold the processed events for each lp
-    std::vector<std::unique_ptr<std::deque<std::shared_ptr<Event>>>> 
-                                                            processed_queue_;
+    std::vector<ProcessedEventHistory> processed_queue_;
 
     // Number of event schedulers
     unsigned int num_of_schedulers_ = 0;
 
+    // Number of worker threads and of worker threads sharing a schedule queue
+    unsigned int num_of_worker_threads_ = 0;
+    unsigned int threads_per_scheduler_ = 0;
+
     // Lock to protect the schedule queues
 #ifdef SCHEDULE_QUEUE_SPINLOCKS
     std::unique_ptr<TicketLock []> schedule_queue_lock_;
@@ -96,17 +195,13 @@ private:
     std::unique_ptr<std::mutex []> schedule_queue_lock_;
 #endif
 
+    // Type of schedule queue
+    ScheduleQueueType schedule_queue_type_;
+
+    bool is_schedule_queue_concurrent_ = false;
+
     // Queues to hold the scheduled events
-#if defined(SORTED_LADDER_QUEUE) || defined(PARTIALLY_SORTED_LADDER_QUEUE)
-    std::vector<std::unique_ptr<LadderQueue>> schedule_queue_;
-#elif defined(SPLAY_TREE)
-    std::vector<std::unique_ptr<SplayTree>> schedule_queue_;
-#elif defined(CIRCULAR_QUEUE)
-    std::vector<std::unique_ptr<CircularQueue>> schedule_queue_;
-#else
-    std::vector<std::unique_ptr<std::multiset<std::shared_ptr<Event>, 
-                                            compareEvents>>> schedule_queue_;
-#endif
+    std::vector<std::unique_ptr<ScheduleQueue>> schedule_queue_;
 
     // Map unprocessed queue to a schedule queue
     std::vector<unsigned int> input_queue_scheduler_map_;
@@ -117,8 +212,20 @@ private:
     // Map worker thread to a schedule queue
     std::vector<unsigned int> worker_thread_scheduler_map_;
 
+    // Victim policy for idle worker threads
+    WorkStealingPolicy work_stealing_policy_;
+
+    // Random state of each worker thread for the random victim policy
+    std::vector<unsigned int> steal_seed_;
+
     // Event scheduled from all lps
     std::vector<std::shared_ptr<Event>> scheduled_event_pointer_;
+
+    bool are_outputs_held_ = false;
+
+    // Largest event moved back to the input queue by a rollback of each lp, if outputs are
+    // held. Only events up to it can have been processed before.
+    std::vector<std::shared_ptr<Event>> rolled_back_event_;
 };
 
 } // warped namespace
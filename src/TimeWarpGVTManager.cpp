@@ -1,12 +1,30 @@
+#include <algorithm>    // for std::min()
+#include <cassert>
+#include <limits>
+#include <malloc.h>     // for mallinfo2()
+
 #include "TimeWarpGVTManager.hpp"
 #include "utility/memory.hpp"           // for make_unique
 
 namespace warped {
 
 void TimeWarpGVTManager::initialize() {
+    thread_reports_ = make_unique<ThreadReport []>(num_worker_threads_);
+
     gvt_state_ = GVTState::IDLE;
     gvt_start = std::chrono::steady_clock::now();
     gvt_stop = std::chrono::steady_clock::now();
+    memory_sample_time_ = gvt_start;
+}
+
+void TimeWarpGVTManager::setPeriodPolicy(bool is_adaptive, unsigned int min_period,
+    unsigned int max_period, uint64_t max_uncommitted_events, uint64_t max_memory) {
+
+    is_adaptive_ = is_adaptive;
+    min_period_ = min_period;
+    max_period_ = max_period;
+    max_uncommitted_events_ = max_uncommitted_events;
+    max_memory_ = max_memory;
 }
 
 void TimeWarpGVTManager::checkProgressGVT() {
@@ -19,4 +37,253 @@ void TimeWarpGVTManager::checkProgressGVT() {
     progressGVT();
 }
 
+// NOTE: An early start is not taken before min_period_ has elapsed, so a node which stays above
+//       its limits does not spend all of its time calculating the GVT. The heap is sampled at
+//       most once a millisecond, as mallinfo2 walks all of the malloc arenas.
+bool TimeWarpGVTManager::periodElapsed(std::chrono::time_point<std::chrono::steady_clock> since) {
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - since).count();
+    if (elapsed >= gvt_period_) {
+        return true;
+    }
+
+    if (elapsed < min_period_) {
+        return false;
+    }
+
+    if (is_start_requested_.load(std::memory_order_relaxed)) {
+        is_start_requested_.store(false, std::memory_order_relaxed);
+        num_early_starts_++;
+        return true;
+    }
+
+    if ((max_uncommitted_events_ == 0) && (max_memory_ == 0)) {
+        return false;
+    }
+
+    if ((max_memory_ != 0) && (now - memory_sample_time_ >= std::chrono::milliseconds(1))) {
+        memory_ = mallinfo2().uordblks;
+        memory_sample_time_ = now;
+    }
+
+    if (isUnderPressure()) {
+        is_early_start_ = true;
+        num_early_starts_++;
+        return true;
+    }
+    return false;
+}
+
+// The counts of a thread are only written by the thread itself and are read without locking,
+//  so the sum may be a few events behind
+bool TimeWarpGVTManager::isUnderPressure() {
+    if ((max_memory_ != 0) && (memory_ >= max_memory_)) {
+        return true;
+    }
+
+    if (max_uncommitted_events_ != 0) {
+        uint64_t num_uncommitted = 0;
+        for (unsigned int i = 0; i < num_worker_threads_; i++) {
+            auto& report = thread_reports_[i];
+            num_uncommitted += report.num_processed_.load(std::memory_order_relaxed);
+            num_uncommitted -= report.num_rolled_back_.load(std::memory_order_relaxed);
+            num_uncommitted -= report.num_committed_.load(std::memory_order_relaxed);
+        }
+        return ((int64_t)num_uncommitted >= (int64_t)max_uncommitted_events_);
+    }
+    return false;
+}
+
+void TimeWarpGVTManager::countProcessedEvent(unsigned int thread_id) {
+    auto& count = thread_reports_[thread_id].num_processed_;
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void TimeWarpGVTManager::countRolledBackEvents(unsigned int thread_id, unsigned int num_events) {
+    auto& count = thread_reports_[thread_id].num_rolled_back_;
+    count.store(count.load(std::memory_order_relaxed) + num_events, std::memory_order_relaxed);
+}
+
+void TimeWarpGVTManager::countCommittedEvents(unsigned int thread_id, unsigned int num_events) {
+    auto& count = thread_reports_[thread_id].num_committed_;
+    count.store(count.load(std::memory_order_relaxed) + num_events, std::memory_order_relaxed);
+}
+
+// The period is halved when a node was under pressure, and otherwise grows by a quarter. It
+//  does not grow while more than half of the events processed since the last GVT were rolled
+//  back: the optimism then already holds many events which are not committed, and a longer
+//  period would let their states and output pile up further.
+void TimeWarpGVTManager::updatePeriod(uint64_t memory) {
+    memory_ = memory;
+
+    uint64_t num_processed = 0;
+    uint64_t num_rolled_back = 0;
+    for (unsigned int i = 0; i < num_worker_threads_; i++) {
+        num_processed += thread_reports_[i].num_processed_.load(std::memory_order_relaxed);
+        num_rolled_back += thread_reports_[i].num_rolled_back_.load(std::memory_order_relaxed);
+    }
+    uint64_t interval_processed = num_processed - last_num_processed_;
+    uint64_t interval_rolled_back = num_rolled_back - last_num_rolled_back_;
+    last_num_processed_ = num_processed;
+    last_num_rolled_back_ = num_rolled_back;
+
+    bool is_pressure = is_early_start_ || is_remote_pressure_ || isUnderPressure();
+    is_early_start_ = false;
+    is_remote_pressure_ = false;
+
+    if (!is_adaptive_) {
+        return;
+    }
+
+    if (is_pressure) {
+        gvt_period_ = std::max(min_period_, gvt_period_ / 2);
+    } else if (2 * interval_rolled_back <= interval_processed) {
+        gvt_period_ = std::min(max_period_, gvt_period_ + gvt_period_ / 4 + 1);
+    }
+}
+
+// NOTE: The epoch is read before the thread takes the event, so a thread which reports with the
+//       current epoch took it after the epoch started. An epoch read before an earlier epoch
+//       ended is stale and is not reported.
+void TimeWarpGVTManager::reportThreadMin(unsigned int timestamp, unsigned int thread_id,
+                                         unsigned int local_gvt_flag) {
+
+    if ((local_gvt_flag == 0) || (local_gvt_flag != gvt_epoch_.load())) {
+        return;
+    }
+
+    auto& report = thread_reports_[thread_id];
+    if (report.epoch_.load(std::memory_order_relaxed) == local_gvt_flag) {
+        return;
+    }
+
+    report.local_min_ = timestamp;
+    if (report.send_epoch_ == local_gvt_flag) {
+        report.local_min_ = std::min(report.local_min_, report.send_min_);
+    }
+    report.epoch_.store(local_gvt_flag);
+    num_reports_pending_.fetch_sub(1);
+}
+
+// The master and message threads only insert events received from other nodes, which the GVT
+//  managers account for when they are received
+void TimeWarpGVTManager::reportThreadSendMin(unsigned int timestamp, unsigned int thread_id) {
+    auto epoch = gvt_epoch_.load();
+    if ((epoch == 0) || (thread_id >= num_worker_threads_)) {
+        return;
+    }
+
+    auto& report = thread_reports_[thread_id];
+    if (report.epoch_.load(std::memory_order_relaxed) == epoch) {
+        return;
+    }
+
+    if (report.send_epoch_ != epoch) {
+        report.send_epoch_ = epoch;
+        report.send_min_ = timestamp;
+    } else {
+        report.send_min_ = std::min(report.send_min_, timestamp);
+    }
+}
+
+// NOTE: The threads which report while the event is out of the schedule queues do not see it,
+//       so it must be part of the report of the thread which took it. An epoch cannot end
+//       before that thread has reported, so one which starts later is still reported to.
+bool TimeWarpGVTManager::reportThreadClaimMin(unsigned int timestamp, unsigned int thread_id) {
+    auto epoch = gvt_epoch_.load();
+    if ((epoch != 0) &&
+            (thread_reports_[thread_id].epoch_.load(std::memory_order_relaxed) == epoch)) {
+        return false;
+    }
+
+    reportThreadSendMin(timestamp, thread_id);
+    return true;
+}
+
+void TimeWarpGVTManager::setGVT(unsigned int gvt) {
+    {
+        std::lock_guard<std::mutex> lock(wait_lock_);
+        gVT_ = gvt;
+    }
+    gvt_changed_.notify_all();
+}
+
+void TimeWarpGVTManager::waitForGVTUpdate(unsigned int gvt, unsigned int local_gvt_flag,
+    std::chrono::microseconds timeout) {
+
+    std::unique_lock<std::mutex> lock(wait_lock_);
+    gvt_changed_.wait_for(lock, timeout, [&]() {
+        return (gVT_ != gvt) || (gvt_epoch_.load() != local_gvt_flag);
+    });
+}
+
+void TimeWarpGVTManager::startLocalReports() {
+    if (++last_epoch_ == 0) {
+        ++last_epoch_;
+    }
+
+    num_reports_pending_.store(num_worker_threads_);
+    {
+        std::lock_guard<std::mutex> lock(wait_lock_);
+        gvt_epoch_.store(last_epoch_);
+    }
+    gvt_changed_.notify_all();
+}
+
+bool TimeWarpGVTManager::collectLocalReports(unsigned int& local_min) {
+    if (num_reports_pending_.load() > 0) {
+        return false;
+    }
+
+    local_min = std::numeric_limits<unsigned int>::max();
+    for (unsigned int i = 0; i < num_worker_threads_; i++) {
+        local_min = std::min(local_min, thread_reports_[i].local_min_);
+    }
+
+    gvt_epoch_.store(0);
+    return true;
+}
+
+void TimeWarpGVTManager::startReduction(unsigned int local_min, int64_t msg_count) {
+    assert(!is_reduction_pending_);
+
+    comm_manager_->flushMessages();
+
+    send_min_value_ = local_min;
+    send_msg_count_ = msg_count;
+    comm_manager_->startAllReduce(&send_min_value_, &reduced_min_,
+                                  &send_msg_count_, &reduced_msg_count_);
+
+    is_reduction_pending_ = true;
+    num_reductions_++;
+}
+
+bool TimeWarpGVTManager::testReduction() {
+    assert(is_reduction_pending_);
+
+    if (comm_manager_->testAllReduce()) {
+        is_reduction_pending_ = false;
+        return true;
+    }
+    return false;
+}
+
+// A node starts a reduction only after the previous one has completed, which needs every node
+//  to have started it. So the numbers of reductions started by the nodes differ by one at most,
+//  and the largest is the sum rounded up to a multiple of the number of nodes.
+void TimeWarpGVTManager::completeReductions() {
+    int64_t num_processes = comm_manager_->getNumProcesses();
+
+    int64_t total_reductions;
+    comm_manager_->sumAllReduceInt64(&num_reductions_, &total_reductions);
+    int64_t max_reductions = (total_reductions + num_processes - 1) / num_processes;
+
+    while (is_reduction_pending_ && !testReduction()) {}
+
+    while (num_reductions_ < max_reductions) {
+        startReduction(std::numeric_limits<unsigned int>::max(), 0);
+        while (!testReduction()) {}
+    }
+}
+
 } // namespace warped
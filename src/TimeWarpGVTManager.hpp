@@ -1,6 +1,10 @@
 #ifndef GVT_MANAGER_HPP
 #define GVT_MANAGER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <memory> // for shared_ptr
 #include <mutex>
 
@@ -21,22 +25,43 @@ public:
     virtual void initialize();
     virtual ~TimeWarpGVTManager() = default;
 
+    // Sets the number of uncommitted events and the bytes of heap in use on this node above
+    // which a GVT calculation starts before the period has elapsed, 0 for no limit. If
+    // adaptive, the period is tuned between min_period and max_period after each GVT.
+    void setPeriodPolicy(bool is_adaptive, unsigned int min_period, unsigned int max_period,
+                         uint64_t max_uncommitted_events, uint64_t max_memory);
+
+    // Called by the master thread of every node once the simulation has terminated
+    virtual void finalize() {}
+
     void checkProgressGVT();
 
     virtual bool readyToStart() = 0;
 
     virtual void progressGVT() = 0;
 
-    virtual void receiveEventUpdate(std::shared_ptr<Event>& event, Color color) = 0;
+    virtual void receiveEventUpdate(const std::shared_ptr<Event>& event, Color color) = 0;
+
+    // Counts an event sent to another node by the given thread and returns the color to send
+    // it with. May be called by any thread, concurrently with receiveEventUpdate.
+    virtual Color sendEventUpdate(const std::shared_ptr<Event>& event,
+                                  unsigned int thread_id) = 0;
 
-    virtual Color sendEventUpdate(std::shared_ptr<Event>& event) = 0;
+    // Reports the local minimum of a worker thread once per GVT epoch. local_gvt_flag is the
+    // value of getLocalGVTFlag() read before the thread took the event with the timestamp.
+    void reportThreadMin(unsigned int timestamp, unsigned int thread_id,
+                         unsigned int local_gvt_flag);
 
-    virtual void reportThreadMin(unsigned int timestamp, unsigned int thread_id,
-                                 unsigned int local_gvt_flag) = 0;
+    // Reports an event sent by a worker thread which has not reported its minimum yet
+    void reportThreadSendMin(unsigned int timestamp, unsigned int thread_id);
 
-    virtual void reportThreadSendMin(unsigned int timestamp, unsigned int thread_id) = 0;
+    // Reports an unprocessed event which a worker thread takes out of the schedule queues for a
+    // while, in the report of that thread. Returns false if the thread has already reported
+    // its minimum in the current epoch, in which case the event must be left where it is.
+    bool reportThreadClaimMin(unsigned int timestamp, unsigned int thread_id);
 
-    virtual unsigned int getLocalGVTFlag() = 0;
+    // Current GVT epoch while worker threads still have to report their minimums, otherwise 0
+    unsigned int getLocalGVTFlag() { return gvt_epoch_.load(); }
 
     virtual bool gvtUpdated() = 0;
 
@@ -44,7 +69,65 @@ public:
 
     unsigned int getGVT() { return gVT_; }
 
+    // Count the events processed, rolled back and committed by a worker thread
+    void countProcessedEvent(unsigned int thread_id);
+    void countRolledBackEvents(unsigned int thread_id, unsigned int num_events);
+    void countCommittedEvents(unsigned int thread_id, unsigned int num_events);
+
+    // Called by the master thread on each new GVT with the heap in use. Adapts the period
+    // from the pressure on the memory and the efficiency since the last GVT.
+    void updatePeriod(uint64_t memory);
+
+    unsigned int getPeriod() { return gvt_period_; }
+
+    // Asks for a GVT calculation as soon as min_period has elapsed, for a worker thread which
+    // waits for the GVT to advance. May be called by any thread.
+    virtual void requestEarlyStart() {
+        is_start_requested_.store(true, std::memory_order_relaxed);
+    }
+
+    // Number of GVT calculations started before the period had elapsed
+    uint64_t numEarlyStarts() { return num_early_starts_; }
+
+    // Blocks a worker thread which holds back its events until the GVT is no longer gvt, an
+    // epoch other than local_gvt_flag has started or the timeout has elapsed
+    void waitForGVTUpdate(unsigned int gvt, unsigned int local_gvt_flag,
+                          std::chrono::microseconds timeout);
+
 protected:
+    // Sets a new GVT and wakes the worker threads which wait for it
+    void setGVT(unsigned int gvt);
+
+    // Returns true once the period has elapsed since the given time, or earlier if a start was
+    // requested or the uncommitted events or the memory in use on this node are above their
+    // limits
+    bool periodElapsed(std::chrono::time_point<std::chrono::steady_clock> since);
+
+    // True if the uncommitted events or the last sample of the memory are above their limits
+    bool isUnderPressure();
+
+    // Another node was under pressure during the last GVT calculation
+    void reportRemotePressure() { is_remote_pressure_ = true; }
+
+    // Starts a new GVT epoch in which every worker thread reports its local minimum
+    void startLocalReports();
+
+    // Returns true and ends the epoch once all worker threads have reported, with the minimum
+    // of their reports in local_min
+    bool collectLocalReports(unsigned int& local_min);
+
+    // Starts a non-blocking reduction of the minimum and the sum of the message counts of all
+    // nodes. Messages held back for aggregation are sent first.
+    void startReduction(unsigned int local_min, int64_t msg_count);
+
+    // Returns true once the pending reduction has completed. The results are then in
+    // reduced_min_ and reduced_msg_count_.
+    bool testReduction();
+
+    // Completes the reductions which other nodes have started, so every node takes part in
+    // the same number of them when the simulation terminates
+    void completeReductions();
+
     const std::shared_ptr<TimeWarpCommunicationManager> comm_manager_;
 
     unsigned int gVT_ = 0;
@@ -59,6 +142,66 @@ protected:
 
     unsigned int num_worker_threads_;
 
+    unsigned int reduced_min_;
+
+    int64_t reduced_msg_count_;
+
+private:
+    // Local minimum of a worker thread, on a cache line of its own. Only the thread itself
+    // writes it, so reporting takes no lock and never waits for the other threads.
+    struct alignas(64) ThreadReport {
+        // Epoch the thread last reported its minimum in
+        std::atomic<unsigned int> epoch_ {0};
+        unsigned int local_min_;
+
+        // Minimum timestamp of the events the thread sent in send_epoch_ before reporting
+        unsigned int send_epoch_ = 0;
+        unsigned int send_min_;
+
+        // Events processed, rolled back and committed by the thread
+        std::atomic<uint64_t> num_processed_ {0};
+        std::atomic<uint64_t> num_rolled_back_ {0};
+        std::atomic<uint64_t> num_committed_ {0};
+    };
+
+    std::unique_ptr<ThreadReport []> thread_reports_;
+
+    std::atomic<unsigned int> gvt_epoch_ {0};
+    unsigned int last_epoch_ = 0;
+    std::atomic<unsigned int> num_reports_pending_ {0};
+
+    bool is_reduction_pending_ = false;
+
+    // Number of reductions this node has started
+    int64_t num_reductions_ = 0;
+
+    // Buffers of the pending reduction
+    unsigned int send_min_value_;
+    int64_t send_msg_count_;
+
+    bool is_adaptive_ = false;
+    unsigned int min_period_ = 0;
+    unsigned int max_period_ = 0;
+    uint64_t max_uncommitted_events_ = 0;
+    uint64_t max_memory_ = 0;
+
+    // Last sample of the heap in use and when it was taken
+    uint64_t memory_ = 0;
+    std::chrono::time_point<std::chrono::steady_clock> memory_sample_time_;
+
+    bool is_early_start_ = false;
+    std::atomic<bool> is_start_requested_ {false};
+    bool is_remote_pressure_ = false;
+    uint64_t num_early_starts_ = 0;
+
+    // Worker threads waiting in waitForGVTUpdate()
+    std::mutex wait_lock_;
+    std::condition_variable gvt_changed_;
+
+    // Events processed and rolled back by all worker threads at the last GVT
+    uint64_t last_num_processed_ = 0;
+    uint64_t last_num_rolled_back_ = 0;
+
 };
 
 }
@@ -0,0 +1,121 @@
+#include "TimeWarpIncrementalStateManager.hpp"
+
+#include <algorithm> // for std::min
+#include <cassert>
+#include <cstring>
+
+#include "LogicalProcess.hpp"
+#include "utility/memory.hpp"
+
+namespace warped {
+
+void TimeWarpIncrementalStateManager::initialize(unsigned int num_local_lps) {
+
+    shadow_ = make_unique<std::vector<unsigned char> []>(num_local_lps);
+
+    TimeWarpPeriodicStateManager::initialize(num_local_lps);
+}
+
+void TimeWarpIncrementalStateManager::saveLPState(const std::shared_ptr<Event>& current_event,
+    unsigned int local_lp_id, LogicalProcess *lp) {
+
+    std::size_t size;
+    auto data = static_cast<unsigned char*>(lp->getState().incrementalStateData(size));
+    if (data == nullptr) {
+        TimeWarpPeriodicStateManager::saveLPState(current_event, local_lp_id, lp);
+        return;
+    }
+
+    auto& state_queue = state_queue_[local_lp_id];
+    auto& shadow = shadow_[local_lp_id];
+
+    // Nothing older to undo to, so the first saved state starts a new shadow
+    std::vector<unsigned char> undo_log;
+    if (state_queue.empty()) {
+        shadow.assign(data, data + size);
+    } else {
+        assert(shadow.size() == size);
+        recordChanges(data, shadow, undo_log);
+    }
+
+    state_queue.emplace_back(current_event, nullptr, saveRngState(lp), std::move(undo_log));
+}
+
+std::shared_ptr<Event> TimeWarpIncrementalStateManager::restoreState(
+    const std::shared_ptr<Event>& rollback_event, unsigned int local_lp_id, LogicalProcess *lp) {
+
+    std::size_t size;
+    auto data = static_cast<unsigned char*>(lp->getState().incrementalStateData(size));
+    if (data == nullptr) {
+        return TimeWarpStateManager::restoreState(rollback_event, local_lp_id, lp);
+    }
+
+    auto& state_queue = state_queue_[local_lp_id];
+    auto& shadow = shadow_[local_lp_id];
+    assert(!state_queue.empty());
+    assert(shadow.size() == size);
+
+    // Undo every saved state that is not before the rollback event, latest first
+    while (!state_queue.empty() && (*state_queue.back().state_event_ >= *rollback_event)) {
+        applyUndoLog(state_queue.back().undo_log_, shadow);
+        state_queue.pop_back();
+    }
+
+    // We must have a state that we can go back to.
+    assert(!state_queue.empty());
+
+    std::memcpy(data, shadow.data(), size);
+
+    auto& max = state_queue.back();
+    restoreRngState(max, lp);
+
+    return max.state_event_;
+}
+
+void TimeWarpIncrementalStateManager::recordChanges(const unsigned char *data,
+    std::vector<unsigned char>& shadow, std::vector<unsigned char>& undo_log) {
+
+    std::size_t size = shadow.size();
+    std::size_t offset = 0;
+
+    while (offset < size) {
+        std::size_t length = std::min(CHUNK_SIZE, size - offset);
+        if (std::memcmp(data + offset, shadow.data() + offset, length) == 0) {
+            offset += length;
+            continue;
+        }
+
+        // Extend the change over all following chunks that changed too
+        std::size_t start = offset;
+        offset += length;
+        while (offset < size) {
+            length = std::min(CHUNK_SIZE, size - offset);
+            if (std::memcmp(data + offset, shadow.data() + offset, length) == 0) break;
+            offset += length;
+        }
+
+        std::size_t header[2] = {start, offset - start};
+        auto header_bytes = reinterpret_cast<const unsigned char*>(header);
+        undo_log.insert(undo_log.end(), header_bytes, header_bytes + sizeof(header));
+        undo_log.insert(undo_log.end(), shadow.begin() + start, shadow.begin() + offset);
+
+        std::memcpy(shadow.data() + start, data + start, offset - start);
+    }
+}
+
+void TimeWarpIncrementalStateManager::applyUndoLog(const std::vector<unsigned char>& undo_log,
+    std::vector<unsigned char>& shadow) {
+
+    std::size_t position = 0;
+    while (position < undo_log.size()) {
+        std::size_t header[2];
+        std::memcpy(header, undo_log.data() + position, sizeof(header));
+        position += sizeof(header);
+
+        assert(header[0] + header[1] <= shadow.size());
+        std::memcpy(shadow.data() + header[0], undo_log.data() + position, header[1]);
+        position += header[1];
+    }
+}
+
+} // namespace warped
@@ -0,0 +1,60 @@
+#ifndef INCREMENTAL_STATE_MANAGER_HPP
+#define INCREMENTAL_STATE_MANAGER_HPP
+
+#include <memory>
+#include <vector>
+
+#include "TimeWarpPeriodicStateManager.hpp"
+
+/* Subclass of TimeWarpPeriodicStateManager which saves the state incrementally. States are
+ * saved with the same fixed period, but for lps whose state provides the
+ * LPState::incrementalStateData hook only the bytes which changed since the previous saved
+ * state are kept.
+ *
+ * A copy of the most recently saved state (the shadow) is kept for each lp. Each saved state
+ * holds an undo log with the old contents of the bytes it changed, so a rollback rebuilds an
+ * older state by undoing the saved states after it, latest first, in the shadow. Fossil
+ * collection simply drops the oldest saved states since their undo logs are no longer needed.
+ *
+ * States without the hook are saved with a full copy, as in the periodic state manager.
+ */
+
+namespace warped {
+
+class TimeWarpIncrementalStateManager : public TimeWarpPeriodicStateManager {
+public:
+
+    TimeWarpIncrementalStateManager(unsigned int period, bool is_adaptive = false,
+                                    unsigned int max_period = 100) :
+        TimeWarpPeriodicStateManager(period, is_adaptive, max_period) {}
+
+    virtual ~TimeWarpIncrementalStateManager() = default;
+
+    void initialize(unsigned int num_local_lps) override;
+
+    std::shared_ptr<Event> restoreState(const std::shared_ptr<Event>& rollback_event,
+        unsigned int local_lp_id, LogicalProcess *lp) override;
+
+protected:
+    void saveLPState(const std::shared_ptr<Event>& current_event,
+        unsigned int local_lp_id, LogicalProcess *lp) override;
+
+private:
+    // Granularity in bytes at which states are compared
+    static constexpr std::size_t CHUNK_SIZE = 16;
+
+    // Appends the old contents of the bytes that differ between data and shadow to the undo
+    // log, as (offset, length, bytes) records, and brings the shadow up to date
+    static void recordChanges(const unsigned char *data, std::vector<unsigned char>& shadow,
+        std::vector<unsigned char>& undo_log);
+
+    static void applyUndoLog(const std::vector<unsigned char>& undo_log,
+        std::vector<unsigned char>& shadow);
+
+    // Most recently saved state of each lp
+    std::unique_ptr<std::vector<unsigned char> []> shadow_;
+};
+
+} // namespace warped
+
+#endif
@@ -11,8 +11,10 @@ namespace warped {
 
 enum class MessageType {
     EventMessage,
+    EventCancelMessage,
     MatternGVTToken,
     GVTUpdateMessage,
+    GVTStartRequest,
     TerminationToken,
     Terminator
 };
@@ -0,0 +1,235 @@
+#include "TimeWarpLazyOutputManager.hpp"
+
+#include <algorithm> // for std::find_if, std::reverse
+#include <cassert>
+#include <iterator> // for std::prev
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <typeinfo>
+
+#include "serialization.hpp"
+#include "utility/memory.hpp"
+#include "utility/warnings.hpp"
+
+namespace warped {
+
+namespace {
+
+// Appends everything written to it to a string, which keeps its capacity when cleared
+class StringBuffer : public std::streambuf {
+public:
+    std::string data_;
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            data_.push_back(traits_type::to_char_type(c));
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        data_.append(s, n);
+        return n;
+    }
+};
+
+// Serializes the event into buffer, reusing its memory
+const std::string& serializeEvent(const std::shared_ptr<Event>& event, StringBuffer& buffer) {
+    buffer.data_.clear();
+    std::ostream os(&buffer);
+    {
+        cereal::PortableBinaryOutputArchive oarchive(os);
+        oarchive(event);
+    }
+    return buffer.data_;
+}
+
+} // anonymous namespace
+
+void TimeWarpLazyOutputManager::initialize(unsigned int num_local_lps) {
+    held_queue_ = make_unique<std::deque<OutputEvent> []>(num_local_lps);
+    comparisons_ = make_unique<Comparisons []>(num_local_lps);
+    TimeWarpOutputManager::initialize(num_local_lps);
+}
+
+// For lazy cancellation, hold back the events sent after the straggler event until the lp
+//  has processed their input events again.
+std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+TimeWarpLazyOutputManager::rollback(const std::shared_ptr<Event>& straggler_event,
+    unsigned int local_lp_id) {
+
+    moveEventsSentAfter(straggler_event, local_lp_id, held_queue_[local_lp_id]);
+    return make_unique<std::vector<std::shared_ptr<Event>>>();
+}
+
+bool TimeWarpLazyOutputManager::isRegenerated(const std::shared_ptr<Event>& input_event,
+    const std::shared_ptr<Event>& output_event, unsigned int local_lp_id) {
+
+    auto held_event = takeSameEvent(held_queue_[local_lp_id], input_event, output_event);
+    if (held_event == nullptr) {
+        return false;
+    }
+    countComparisons(local_lp_id, 1, 0);
+
+    // Keep the event which the receiver already has and track it as sent by the input event
+    //  again
+    insertEvent(input_event, held_event, local_lp_id);
+    return true;
+}
+
+std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+TimeWarpLazyOutputManager::eventsNotRegenerated(const std::shared_ptr<Event>& processed_event,
+    unsigned int local_lp_id) {
+
+    auto events_to_cancel = takeEventsSentUpTo(held_queue_[local_lp_id], processed_event);
+    if (events_to_cancel != nullptr) {
+        countComparisons(local_lp_id, 0, events_to_cancel->size());
+    }
+    return events_to_cancel;
+}
+
+// NOTE: The cancelled event is not processed again, so none of its events can be regenerated.
+//       The events held for other input events still can be. Its events are not compared
+//       with anything, so they do not count as misses.
+std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+TimeWarpLazyOutputManager::eventsSentByCancelledEvent(
+    const std::shared_ptr<Event>& cancelled_event, unsigned int local_lp_id) {
+
+    return takeEventsSentBy(held_queue_[local_lp_id], cancelled_event);
+}
+
+std::size_t TimeWarpLazyOutputManager::heldSize(unsigned int local_lp_id) {
+    return held_queue_[local_lp_id].size();
+}
+
+bool TimeWarpLazyOutputManager::isLazy(unsigned int local_lp_id) {
+    unused(local_lp_id);
+    return true;
+}
+
+// NOTE: The dynamic output manager also holds events while an lp is aggressive, to observe
+//       whether they are regenerated
+bool TimeWarpLazyOutputManager::canHoldEvents() {
+    return true;
+}
+
+uint64_t TimeWarpLazyOutputManager::numComparedEvents(unsigned int local_lp_id) {
+    return comparisons_[local_lp_id].compared_;
+}
+
+uint64_t TimeWarpLazyOutputManager::numRegeneratedEvents(unsigned int local_lp_id) {
+    return comparisons_[local_lp_id].regenerated_;
+}
+
+void TimeWarpLazyOutputManager::countComparisons(unsigned int local_lp_id,
+    unsigned int num_hits, unsigned int num_misses) {
+
+    comparisons_[local_lp_id].regenerated_ += num_hits;
+    comparisons_[local_lp_id].compared_ += num_hits + num_misses;
+}
+
+std::size_t TimeWarpLazyOutputManager::moveEventsSentAfter(
+    const std::shared_ptr<Event>& straggler_event, unsigned int local_lp_id,
+    std::deque<OutputEvent>& queue) {
+
+    auto& output_queue = output_queue_[local_lp_id];
+    std::size_t num_moved = 0;
+
+    // NOTE: Events still in queue from an earlier rollback all have input events after the
+    //       events processed since, so the moved events go in front of them.
+    while (!output_queue.empty() && (*output_queue.back().input_event_ >= *straggler_event)) {
+        assert(queue.empty() ||
+            (*output_queue.back().input_event_ <= *queue.front().input_event_));
+        queue.push_front(std::move(output_queue.back()));
+        output_queue.pop_back();
+        num_moved++;
+    }
+
+    return num_moved;
+}
+
+std::shared_ptr<Event> TimeWarpLazyOutputManager::takeSameEvent(std::deque<OutputEvent>& queue,
+    const std::shared_ptr<Event>& input_event, const std::shared_ptr<Event>& output_event) {
+
+    for (auto it = queue.begin(); (it != queue.end()) && (*it->input_event_ <= *input_event);
+            it++) {
+
+        if ((*it->input_event_ == *input_event) && isSameEvent(it->output_event_, output_event)) {
+            auto same_event = std::move(it->output_event_);
+            queue.erase(it);
+            return same_event;
+        }
+    }
+    return nullptr;
+}
+
+std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+TimeWarpLazyOutputManager::takeEventsSentUpTo(std::deque<OutputEvent>& queue,
+    const std::shared_ptr<Event>& processed_event) {
+
+    if (queue.empty() || (*queue.front().input_event_ > *processed_event)) {
+        return nullptr;
+    }
+
+    auto events = make_unique<std::vector<std::shared_ptr<Event>>>();
+    while (!queue.empty() && (*queue.front().input_event_ <= *processed_event)) {
+        events->push_back(std::move(queue.front().output_event_));
+        queue.pop_front();
+    }
+
+    // Events are returned in order of LARGEST to SMALLEST
+    std::reverse(events->begin(), events->end());
+    return events;
+}
+
+std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+TimeWarpLazyOutputManager::takeEventsSentBy(std::deque<OutputEvent>& queue,
+    const std::shared_ptr<Event>& input_event) {
+
+    // The events sent by the same input event are next to each other
+    auto first = std::find_if(queue.begin(), queue.end(),
+        [&input_event](const OutputEvent& e) { return *e.input_event_ >= *input_event; });
+    auto last = std::find_if(first, queue.end(),
+        [&input_event](const OutputEvent& e) { return !(*e.input_event_ == *input_event); });
+    if (first == last) {
+        return nullptr;
+    }
+
+    // Events are returned in order of LARGEST to SMALLEST
+    auto events = make_unique<std::vector<std::shared_ptr<Event>>>();
+    events->reserve(last - first);
+    for (auto it = last; it != first; it--) {
+        events->push_back(std::move(std::prev(it)->output_event_));
+    }
+    queue.erase(first, last);
+    return events;
+}
+
+// NOTE: The new event has not been given a generation yet. It takes the generation of the held
+//       event for the comparison and keeps it only if the events are the same.
+bool TimeWarpLazyOutputManager::isSameEvent(const std::shared_ptr<Event>& held_event,
+                                            const std::shared_ptr<Event>& new_event) {
+
+    // Most events which differ are told apart without serializing them
+    if ((held_event->receiver_id_ != new_event->receiver_id_) ||
+        (held_event->timestamp() != new_event->timestamp()) ||
+        (held_event->event_type_ != new_event->event_type_) ||
+        (typeid(*held_event) != typeid(*new_event)) ||
+        (held_event->size() != new_event->size())) {
+        return false;
+    }
+
+    // One pair of buffers per worker thread, so that comparisons do not allocate
+    thread_local StringBuffer held_buffer, new_buffer;
+
+    auto generation = new_event->generation_;
+    new_event->generation_ = held_event->generation_;
+    bool is_same = (serializeEvent(held_event, held_buffer) ==
+                    serializeEvent(new_event, new_buffer));
+    new_event->generation_ = generation;
+    return is_same;
+}
+
+} // namespace warped
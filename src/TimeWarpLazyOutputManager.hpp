@@ -0,0 +1,105 @@
+#ifndef LAZY_OUTPUT_MANAGER_HPP
+#define LAZY_OUTPUT_MANAGER_HPP
+
+#include <cstdint>  // for uint64_t
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "TimeWarpOutputManager.hpp"
+
+/* This class is a subclass of TimeWarpOutputManager that implements lazy cancellation. On a
+ * rollback, the events sent after the straggler are not cancelled right away but held back.
+ * While the lp processes its events again, every event it sends is compared with the events
+ * held back for the same input event. An event which is regenerated is not sent again, and the
+ * earlier copy is kept by the receiver. Once an input event has been processed again (or has
+ * been cancelled), the events it sent before the rollback which were not regenerated are
+ * returned to be sent as anti-messages. A cancelled input event only releases the events it
+ * sent itself.
+ *
+ * Two events are the same if they have the same receiver, timestamp, type, size and serialized
+ * contents.
+ */
+
+namespace warped {
+
+class TimeWarpLazyOutputManager : public TimeWarpOutputManager {
+public:
+    TimeWarpLazyOutputManager() = default;
+    virtual ~TimeWarpLazyOutputManager() = default;
+
+    void initialize(unsigned int num_local_lps) override;
+
+    std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+        rollback(const std::shared_ptr<Event>& straggler_event,
+                 unsigned int local_lp_id) override;
+
+    bool isRegenerated(const std::shared_ptr<Event>& input_event,
+        const std::shared_ptr<Event>& output_event, unsigned int local_lp_id) override;
+
+    std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+        eventsNotRegenerated(const std::shared_ptr<Event>& processed_event,
+                             unsigned int local_lp_id) override;
+
+    std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+        eventsSentByCancelledEvent(const std::shared_ptr<Event>& cancelled_event,
+                                   unsigned int local_lp_id) override;
+
+    // Number of events held back by a rollback for the specified lp
+    std::size_t heldSize(unsigned int local_lp_id);
+
+    bool isLazy(unsigned int local_lp_id) override;
+
+    bool canHoldEvents() override;
+
+    uint64_t numComparedEvents(unsigned int local_lp_id) override;
+
+    uint64_t numRegeneratedEvents(unsigned int local_lp_id) override;
+
+protected:
+    // Counts the outcome of comparing the events sent before a rollback with the events sent
+    // again
+    virtual void countComparisons(unsigned int local_lp_id, unsigned int num_hits,
+                                  unsigned int num_misses);
+
+    // Moves the entries of the output queue of the specified lp whose input events are not
+    // before the straggler to the front of queue and returns how many were moved
+    std::size_t moveEventsSentAfter(const std::shared_ptr<Event>& straggler_event,
+        unsigned int local_lp_id, std::deque<OutputEvent>& queue);
+
+    // Removes the event in queue which was sent by input_event and is the same as
+    // output_event, and returns it or nullptr if there is none
+    static std::shared_ptr<Event> takeSameEvent(std::deque<OutputEvent>& queue,
+        const std::shared_ptr<Event>& input_event, const std::shared_ptr<Event>& output_event);
+
+    // Removes the events in queue sent by input events up to processed_event and returns them
+    // in order of LARGEST to SMALLEST, or nullptr if there are none
+    static std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+        takeEventsSentUpTo(std::deque<OutputEvent>& queue,
+                           const std::shared_ptr<Event>& processed_event);
+
+    // Removes the events in queue sent by input_event and returns them in order of LARGEST to
+    // SMALLEST, or nullptr if there are none
+    static std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+        takeEventsSentBy(std::deque<OutputEvent>& queue,
+                         const std::shared_ptr<Event>& input_event);
+
+    static bool isSameEvent(const std::shared_ptr<Event>& held_event,
+                            const std::shared_ptr<Event>& new_event);
+
+    // Events sent after the last straggler which have not been regenerated or cancelled yet,
+    // in order of their input events (per lp)
+    std::unique_ptr<std::deque<OutputEvent> []> held_queue_;
+
+private:
+    struct Comparisons {
+        uint64_t compared_ = 0;
+        uint64_t regenerated_ = 0;
+    };
+
+    std::unique_ptr<Comparisons []> comparisons_;
+};
+
+} // namespace warped
+
+#endif
@@ -1,15 +1,52 @@
 #include <cstring> // for memcpy
-#include <algorithm> // for std::remove_if
+#include <algorithm> // for std::remove_if, std::min, std::max
 #include <cstdint>  // for uint8_t type
 #include <cassert>
+#include <functional> // for std::greater
+#include <iostream>
+#include <queue>
 
 #include "TimeWarpMPICommunicationManager.hpp"
 #include "TimeWarpEventDispatcher.hpp"          // for EventMessage
 #include "utility/memory.hpp"
+#include "utility/streambuf.hpp"
 #include "utility/warnings.hpp"
 
 namespace warped {
 
+namespace {
+
+std::atomic<unsigned int> next_instance_id {0};
+
+// Outbox of this thread and the communication manager it belongs to
+thread_local unsigned int outbox_instance_id = (unsigned int)-1;
+thread_local Outbox* outbox = nullptr;
+
+// How long the master thread waits when the message thread has passed nothing on
+constexpr std::chrono::microseconds CONTROL_MESSAGE_WAIT(50);
+
+} // anonymous namespace
+
+TimeWarpMPICommunicationManager::TimeWarpMPICommunicationManager(unsigned int max_buffer_size,
+    unsigned max_aggregate, bool is_aggregation_adaptive, unsigned int max_aggregation_delay,
+    bool is_message_thread_dedicated) :
+        instance_id_(next_instance_id++),
+        is_message_thread_dedicated_(is_message_thread_dedicated),
+        send_buffer_size_(max_buffer_size*max_aggregate),
+        aggregate_size_(max_aggregate, is_aggregation_adaptive),
+        max_aggregation_delay_(max_aggregation_delay) {}
+
+TimeWarpMPICommunicationManager::~TimeWarpMPICommunicationManager() {
+    stopMessageThread();
+
+    Outbox* next = outboxes_.load();
+    while (next != nullptr) {
+        Outbox* current = next;
+        next = current->next_;
+        delete current;
+    }
+}
+
 unsigned int TimeWarpMPICommunicationManager::initialize() {
 
     // MPI_Init requires command line arguments, but doesn't use them. Just give
@@ -19,7 +56,9 @@ unsigned int TimeWarpMPICommunicationManager::initialize() {
     argv[0] = NULL;
     int provided;
 
-    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    // A dedicated message thread makes MPI calls too, one thread at a time
+    int required = is_message_thread_dedicated_ ? MPI_THREAD_SERIALIZED : MPI_THREAD_FUNNELED;
+    MPI_Init_thread(&argc, &argv, required, &provided);
 
     delete [] argv;
 
@@ -28,22 +67,35 @@ unsigned int TimeWarpMPICommunicationManager::initialize() {
                   << std::endl;
     }
 
-    send_queue_ = std::make_shared<MessageQueue>(max_buffer_size_);
-    recv_queue_ = std::make_shared<MessageQueue>(max_buffer_size_);
+    if (provided < required) {
+        std::cout << "Warning: Your MPI Implementation does not support a dedicated message "
+                  << "thread, messages are handled by the master thread" << std::endl;
+        is_message_thread_dedicated_ = false;
+    }
+
+    send_queue_ = std::make_shared<MessageQueue>(send_buffer_size_);
+    recv_queue_ = std::make_shared<MessageQueue>(send_buffer_size_);
 
     MPI_Comm_size(MPI_COMM_WORLD, &num_processes_);
     MPI_Comm_rank(MPI_COMM_WORLD, &my_rank_);
+    MPI_Comm_dup(MPI_COMM_WORLD, &allreduce_comm_);
 
     aggregate_message_count_by_receiver_ = make_unique<unsigned int[]>(num_processes_);
     std::memset(aggregate_message_count_by_receiver_.get(), 0, num_processes_*sizeof(unsigned int));
 
     aggregate_messages_ = make_unique<std::list<std::unique_ptr<TimeWarpKernelMessage>>[]>(num_processes_);
 
+    aggregate_size_.initialize(num_processes_);
+    aggregate_start_by_receiver_ =
+        make_unique<std::chrono::steady_clock::time_point[]>(num_processes_);
+    stragglers_by_sender_ = make_unique<std::atomic<unsigned int>[]>(num_processes_);
+
     return getNumProcesses();
 }
 
 void TimeWarpMPICommunicationManager::finalize() {
     assert(isInitiatingThread());
+    MPI_Comm_free(&allreduce_comm_);
     MPI_Finalize();
 }
 
@@ -57,6 +109,7 @@ unsigned int TimeWarpMPICommunicationManager::getID() {
 
 int TimeWarpMPICommunicationManager::waitForAllProcesses() {
     assert(isInitiatingThread());
+    auto lock = lockForCollective();
     return MPI_Barrier(MPI_COMM_WORLD);
 }
 
@@ -69,100 +122,287 @@ bool TimeWarpMPICommunicationManager::isInitiatingThread() {
 int
 TimeWarpMPICommunicationManager::sumReduceUint64(uint64_t *send_local, uint64_t *recv_global) {
     assert(isInitiatingThread());
+    auto lock = lockForCollective();
     return MPI_Reduce(send_local, recv_global, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
 }
 
 int
 TimeWarpMPICommunicationManager::gatherUint64(uint64_t *send_local, uint64_t *recv_root) {
     assert(isInitiatingThread());
+    auto lock = lockForCollective();
     return MPI_Gather(send_local, 1, MPI_UINT64_T, recv_root, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
 }
 
 int TimeWarpMPICommunicationManager::sumAllReduceInt64(int64_t* send_local, int64_t* recv_global) {
     assert(isInitiatingThread());
+    auto lock = lockForCollective();
     return MPI_Allreduce(send_local, recv_global, 1, MPI_INT64_T, MPI_SUM, MPI_COMM_WORLD);
 }
 
 int TimeWarpMPICommunicationManager::minAllReduceUint(unsigned int* send_local, unsigned int* recv_global) {
     assert(isInitiatingThread());
+    auto lock = lockForCollective();
     return MPI_Allreduce(send_local, recv_global, 1, MPI_UNSIGNED, MPI_MIN, MPI_COMM_WORLD);
 }
 
+void TimeWarpMPICommunicationManager::startAllReduce(unsigned int* send_min,
+    unsigned int* recv_min, int64_t* send_sum, int64_t* recv_sum) {
+
+    assert(isInitiatingThread());
+    auto lock = lockForCollective();
+    if ((MPI_Iallreduce(send_min, recv_min, 1, MPI_UNSIGNED, MPI_MIN, allreduce_comm_,
+                        &allreduce_requests_[0]) != MPI_SUCCESS) ||
+        (MPI_Iallreduce(send_sum, recv_sum, 1, MPI_INT64_T, MPI_SUM, allreduce_comm_,
+                        &allreduce_requests_[1]) != MPI_SUCCESS)) {
+        throw std::runtime_error("MPI_Iallreduce failed");
+    }
+}
+
+bool TimeWarpMPICommunicationManager::testAllReduce() {
+    assert(isInitiatingThread());
+    auto lock = lockForCollective();
+    int flag = 0;
+    MPI_Testall(2, allreduce_requests_, &flag, MPI_STATUSES_IGNORE);
+    return flag;
+}
+
+std::unique_lock<std::mutex> TimeWarpMPICommunicationManager::lockForCollective() {
+    is_collective_waiting_.store(true);
+    std::unique_lock<std::mutex> lock(mpi_lock_);
+    is_collective_waiting_.store(false);
+    return lock;
+}
+
+// The ticket announced before taking one is at most the ticket taken, so a sending thread which
+// reads next_ticket_ and then every pending ticket knows all messages with a ticket below the
+// lowest of them are in their outboxes.
 void TimeWarpMPICommunicationManager::insertMessage(std::unique_ptr<TimeWarpKernelMessage> msg) {
-    send_queue_->msg_list_lock_.lock();
-    send_queue_->msg_list_.push_back(std::move(msg));
-    send_queue_->msg_list_lock_.unlock();
+    auto& thread_outbox = threadOutbox();
+
+    thread_outbox.pending_ticket_.store(next_ticket_.load());
+    uint64_t ticket = next_ticket_.fetch_add(1);
+    thread_outbox.messages_.push({ticket, std::move(msg)});
+    thread_outbox.pending_ticket_.store(Outbox::NO_TICKET);
+}
+
+Outbox& TimeWarpMPICommunicationManager::threadOutbox() {
+    if ((outbox_instance_id != instance_id_) || (outbox == nullptr)) {
+        outbox = new Outbox();
+        outbox_instance_id = instance_id_;
+
+        outbox->next_ = outboxes_.load();
+        while (!outboxes_.compare_exchange_weak(outbox->next_, outbox)) {}
+    }
+    return *outbox;
 }
 
 void TimeWarpMPICommunicationManager::handleMessages() {
-    testReceiveRequests();
-    testSendRequests();
-    startReceiveRequests();
-    startSendRequests();
+    // The message thread sends and receives, so only run the handlers it passed on
+    if (message_thread_.joinable()) {
+        if (handleControlMessages() == 0) {
+            std::this_thread::sleep_for(CONTROL_MESSAGE_WAIT);
+        }
+        return;
+    }
+
+    handleControlMessages();
+    progressMessages();
 }
 
 void TimeWarpMPICommunicationManager::flushMessages() {
+    if (message_thread_.joinable()) {
+        flush_requested_.store(true);
+        return;
+    }
+    sendAggregates();
+}
+
+void TimeWarpMPICommunicationManager::sendAggregates() {
     for (unsigned int receiver_id = 0; receiver_id < getNumProcesses(); receiver_id++) {
         packAndSend(receiver_id);
     }
 }
 
+unsigned int TimeWarpMPICommunicationManager::progressMessages() {
+    unsigned int requests = testReceiveRequests();
+    requests += testSendRequests();
+    requests += startReceiveRequests();
+    requests += startSendRequests();
+    return requests;
+}
+
+void TimeWarpMPICommunicationManager::startMessageThread(std::function<void()> thread_init) {
+    if (!is_message_thread_dedicated_ || message_thread_.joinable()) {
+        return;
+    }
+
+    stop_message_thread_.store(false);
+    message_thread_ = std::thread {&TimeWarpMPICommunicationManager::runMessageThread, this,
+                                   std::move(thread_init)};
+}
+
+void TimeWarpMPICommunicationManager::stopMessageThread() {
+    if (!message_thread_.joinable()) {
+        return;
+    }
+
+    stop_message_thread_.store(true);
+    message_thread_.join();
+}
+
+void TimeWarpMPICommunicationManager::runMessageThread(std::function<void()> thread_init) {
+    thread_init();
+    is_on_message_thread_ = true;
+
+    while (!stop_message_thread_.load()) {
+        unsigned int requests;
+        {
+            std::lock_guard<std::mutex> lock(mpi_lock_);
+
+            requests = progressMessages();
+            if (flush_requested_.exchange(false)) {
+                sendAggregates();
+                requests++;
+            }
+        }
+
+        // Let the other threads run if there is nothing to do, and a collective operation of
+        // the master thread take the lock
+        if ((requests == 0) || is_collective_waiting_.load()) {
+            std::this_thread::yield();
+        }
+    }
+
+    is_on_message_thread_ = false;
+}
+
+unsigned int TimeWarpMPICommunicationManager::handleControlMessages() {
+    unsigned int count = 0;
+    std::unique_ptr<TimeWarpKernelMessage> msg;
+    while (control_messages_.pop(msg)) {
+        dispatchMessage(std::move(msg));
+        count++;
+    }
+    return count;
+}
+
+void TimeWarpMPICommunicationManager::dispatchMessage(std::unique_ptr<TimeWarpKernelMessage> msg) {
+    int msg_type_int = static_cast<int>(msg->get_type());
+    msg_handler_by_msg_type_[msg_type_int](std::move(msg));
+}
+
+void TimeWarpMPICommunicationManager::reportStraggler(unsigned int node_id) {
+    stragglers_by_sender_[node_id]++;
+}
+
+uint64_t TimeWarpMPICommunicationManager::numAggregatesSent() {
+    return num_aggregates_sent_;
+}
+
+uint64_t TimeWarpMPICommunicationManager::numAggregatedMessages() {
+    return num_aggregated_messages_;
+}
+
 unsigned int TimeWarpMPICommunicationManager::startSendRequests() {
     unsigned int requests = 0;
+    auto now = std::chrono::steady_clock::now();
+
+    // Find the tickets of the messages which are all in the outboxes already. An outbox
+    // registered after the list is read takes a ticket of at least ticket_limit.
+    uint64_t ticket_limit = next_ticket_.load();
+    Outbox* first_outbox = outboxes_.load();
+    for (Outbox* o = first_outbox; o != nullptr; o = o->next_) {
+        ticket_limit = std::min(ticket_limit, o->pending_ticket_.load());
+    }
 
-    send_queue_->msg_list_lock_.lock();
+    // Take them in ticket order by merging the outboxes
+    using OutboxFront = std::pair<uint64_t, Outbox*>;
+    std::priority_queue<OutboxFront, std::vector<OutboxFront>, std::greater<OutboxFront>> fronts;
+    if (ticket_limit > next_ticket_to_send_) {
+        for (Outbox* o = first_outbox; o != nullptr; o = o->next_) {
+            auto front = o->messages_.front();
+            if ((front != nullptr) && (front->first < ticket_limit)) {
+                fronts.emplace(front->first, o);
+            }
+        }
+        next_ticket_to_send_ = ticket_limit;
+    }
+
+    while (!fronts.empty()) {
 
-    while (!send_queue_->msg_list_.empty()) {
+        Outbox* o = fronts.top().second;
+        fronts.pop();
 
-        auto msg = std::move(send_queue_->msg_list_.front());
-        send_queue_->msg_list_.pop_front();
+        auto msg = std::move(o->messages_.front()->second);
+        o->messages_.pop();
+
+        auto front = o->messages_.front();
+        if ((front != nullptr) && (front->first < ticket_limit)) {
+            fronts.emplace(front->first, o);
+        }
 
         unsigned int receiver_id = msg->receiver_id;
         auto msg_type = msg->get_type();
 
+        if (aggregate_messages_[receiver_id].empty()) {
+            aggregate_start_by_receiver_[receiver_id] = now;
+        }
         aggregate_messages_[receiver_id].push_back(std::move(msg));
 
-        if ((++aggregate_message_count_by_receiver_[receiver_id] >= max_aggregate_) ||
-            (msg_type != MessageType::EventMessage)) {
-
+        if (msg_type != MessageType::EventMessage) {
             packAndSend(receiver_id);
+            requests++;
+
+        } else if (++aggregate_message_count_by_receiver_[receiver_id] >=
+                aggregate_size_.size(receiver_id)) {
 
+            aggregate_size_.aggregateFilled(receiver_id);
+            packAndSend(receiver_id);
             requests++;
         }
     }
 
-    send_queue_->msg_list_lock_.unlock();
+    // Send the aggregates which have been held for too long
+    if (max_aggregation_delay_.count() > 0) {
+        for (unsigned int receiver_id = 0; receiver_id < getNumProcesses(); receiver_id++) {
+            unsigned int count = aggregate_message_count_by_receiver_[receiver_id];
+            if ((count == 0) ||
+                    (now - aggregate_start_by_receiver_[receiver_id] < max_aggregation_delay_)) {
+                continue;
+            }
+
+            aggregate_size_.aggregateExpired(receiver_id, count);
+            packAndSend(receiver_id);
+            requests++;
+        }
+    }
 
     return requests;
 }
 
 void TimeWarpMPICommunicationManager::packAndSend(unsigned int receiver_id) {
 
-    int position = 0;
-    uint8_t* message_buffer = new uint8_t[max_buffer_size_];
-    int num_messages = aggregate_messages_[receiver_id].size();
-    int header_size = sizeof(int)*(num_messages+1);
-    int message_position = header_size;
-
-    MPI_Pack(&num_messages, 1, MPI_INT, message_buffer, max_buffer_size_, &position, MPI_COMM_WORLD);
-    for (auto& m : aggregate_messages_[receiver_id]) {
-        std::ostringstream oss;
-        cereal::PortableBinaryOutputArchive oarchive(oss);
-        oarchive(m);
-
-        int length = oss.str().length();
-        MPI_Pack(&length, 1, MPI_INT, message_buffer, max_buffer_size_, &position, MPI_COMM_WORLD);
-        MPI_Pack(const_cast<char*>(oss.str().c_str()), length, MPI_BYTE, message_buffer,
-                 max_buffer_size_, &message_position, MPI_COMM_WORLD);
+    std::size_t header_size = sizeof(int)*(aggregate_messages_[receiver_id].size()+2);
+    auto message_buffer = buffer_pool_.acquire(std::max(send_buffer_size_, header_size));
+    unsigned int num_stragglers = stragglers_by_sender_[receiver_id].exchange(0);
+
+    // If the messages do not fit, serialize them again into a buffer of the size they need
+    std::size_t message_size = packMessages(receiver_id, num_stragglers, message_buffer);
+    if (message_size > message_buffer.size()) {
+        send_buffer_size_ = message_size;
+        buffer_pool_.release(std::move(message_buffer));
+        message_buffer = buffer_pool_.acquire(message_size);
+        message_size = packMessages(receiver_id, num_stragglers, message_buffer);
+        assert(message_size <= message_buffer.size());
     }
 
-    auto new_request = make_unique<PendingRequest>(std::unique_ptr<uint8_t[]>(message_buffer), message_position);
+    auto new_request = make_unique<PendingRequest>(std::move(message_buffer), message_size);
     send_queue_->pending_request_list_.push_back(std::move(new_request));
 
     if (MPI_Isend(
-            send_queue_->pending_request_list_.back()->buffer_.get(),
+            send_queue_->pending_request_list_.back()->buffer_.data(),
             send_queue_->pending_request_list_.back()->count_,
-            MPI_PACKED,
+            MPI_BYTE,
             receiver_id,
             MPI_DATA_TAG,
             MPI_COMM_WORLD,
@@ -170,10 +410,47 @@ void TimeWarpMPICommunicationManager::packAndSend(unsigned int receiver_id) {
         throw std::runtime_error("MPI_Isend failed");
     }
 
+    if (!aggregate_messages_[receiver_id].empty()) {
+        num_aggregates_sent_++;
+        num_aggregated_messages_ += aggregate_messages_[receiver_id].size();
+    }
+
     aggregate_messages_[receiver_id].clear();
     aggregate_message_count_by_receiver_[receiver_id] = 0;
 }
 
+// The buffer starts with the number of messages, the number of rollbacks the receiver's events
+// caused here since the last aggregate and the length of each message, followed by the
+// serialized messages. Returns the size of the whole aggregate, which is larger than the buffer
+// if it did not fit.
+std::size_t TimeWarpMPICommunicationManager::packMessages(unsigned int receiver_id,
+    unsigned int num_stragglers, std::vector<uint8_t>& buffer) {
+
+    int num_messages = aggregate_messages_[receiver_id].size();
+    std::size_t header_size = sizeof(int)*(num_messages+2);
+    assert(header_size <= buffer.size());
+
+    auto header = reinterpret_cast<int*>(buffer.data());
+    header[0] = num_messages;
+    header[1] = num_stragglers;
+
+    // Serialize the messages straight into the buffer behind the header
+    MemoryOutputBuffer payload(reinterpret_cast<char*>(buffer.data()) + header_size,
+                               buffer.size() - header_size);
+    std::ostream os(&payload);
+    int i = 2;
+    for (auto& m : aggregate_messages_[receiver_id]) {
+        std::size_t start = payload.size();
+        {
+            cereal::PortableBinaryOutputArchive oarchive(os);
+            oarchive(m);
+        }
+        header[i++] = payload.size() - start;
+    }
+
+    return header_size + payload.size();
+}
+
 unsigned int TimeWarpMPICommunicationManager::startReceiveRequests() {
     int flag = 0;
     MPI_Status status;
@@ -190,15 +467,19 @@ unsigned int TimeWarpMPICommunicationManager::startReceiveRequests() {
 
         if (flag) {
 
-            auto new_request = make_unique<PendingRequest>(make_unique<uint8_t[]>(max_buffer_size_), max_buffer_size_);
+            // Receive exactly the probed message into a buffer of its size
+            int count;
+            MPI_Get_count(&status, MPI_BYTE, &count);
+
+            auto new_request = make_unique<PendingRequest>(buffer_pool_.acquire(count), count);
             recv_queue_->pending_request_list_.push_back(std::move(new_request));
 
             if (MPI_Irecv(
-                    recv_queue_->pending_request_list_.back()->buffer_.get(),
+                    recv_queue_->pending_request_list_.back()->buffer_.data(),
                     recv_queue_->pending_request_list_.back()->count_,
-                    MPI_PACKED,
-                    MPI_ANY_SOURCE,
-                    MPI_DATA_TAG,
+                    MPI_BYTE,
+                    status.MPI_SOURCE,
+                    status.MPI_TAG,
                     MPI_COMM_WORLD,
                     &recv_queue_->pending_request_list_.back()->request_) != MPI_SUCCESS) {
 
@@ -221,7 +502,10 @@ unsigned int TimeWarpMPICommunicationManager::testSendRequests() {
         if (MPI_Test(&pr->request_, &pr->flag_, &pr->status_) != MPI_SUCCESS) {
             throw std::runtime_error("MPI_Test failed in testSendRequest");
         }
-        if (pr->flag_) count++;
+        if (pr->flag_) {
+            count++;
+            buffer_pool_.release(std::move(pr->buffer_));
+        }
     }
 
     send_queue_->pending_request_list_.erase(
@@ -244,33 +528,45 @@ unsigned int TimeWarpMPICommunicationManager::testReceiveRequests() {
         if (pr->flag_) {
             count++;
 
-            int num_messages;
-            char* message_buffer = reinterpret_cast<char*>(pr->buffer_.get());
-            int message_length = pr->count_;;
-            int position = 0;
+            const char* message_buffer = reinterpret_cast<const char*>(pr->buffer_.data());
+            auto header = reinterpret_cast<const int*>(message_buffer);
+            int num_messages = header[0];
+            int header_length = (num_messages+2)*sizeof(int);
+
+            // Our events are arriving too late at the sender, so send them sooner
+            unsigned int sender_id = pr->status_.MPI_SOURCE;
+            if (header[1] > 0) {
+                aggregate_size_.stragglersReported(sender_id);
+            }
 
-            MPI_Unpack(message_buffer, message_length, &position, &num_messages, 1, MPI_INT, MPI_COMM_WORLD);
-            int header_length = (num_messages+1)*sizeof(int);
-            int msg_position = header_length;
+            // Deserialize in place from the receive buffer
+            MemoryInputBuffer payload(message_buffer + header_length,
+                                      pr->count_ - header_length);
+            std::istream is(&payload);
 
             for (int i = 0; i < num_messages; i++) {
                 std::unique_ptr<TimeWarpKernelMessage> msg = nullptr;
 
-                // Unpack from aggregate buffer
-                int msg_length = reinterpret_cast<int*>(message_buffer)[i + 1];
-                auto msg_buffer = make_unique<char[]>(msg_length);
-                MPI_Unpack(message_buffer, message_length, &msg_position, msg_buffer.get(), msg_length,
-                           MPI_BYTE, MPI_COMM_WORLD);
-
-                // Deserialize
-                std::istringstream iss(std::string(msg_buffer.get(), msg_length));
-                cereal::PortableBinaryInputArchive iarchive(iss);
-                iarchive(msg);
+                std::size_t start = payload.position();
+                {
+                    cereal::PortableBinaryInputArchive iarchive(is);
+                    iarchive(msg);
+                }
+                assert(payload.position() - start == static_cast<std::size_t>(header[i + 2]));
+                unused(start);
 
+                // The message thread handles events itself and passes the other messages on
+                // to the master thread
                 MessageType msg_type = msg->get_type();
-                int msg_type_int = static_cast<int>(msg_type);
-                msg_handler_by_msg_type_[msg_type_int](std::move(msg));
+                if (is_on_message_thread_ && (msg_type != MessageType::EventMessage) &&
+                        (msg_type != MessageType::EventCancelMessage)) {
+                    control_messages_.push(std::move(msg));
+                } else {
+                    dispatchMessage(std::move(msg));
+                }
             }
+
+            buffer_pool_.release(std::move(pr->buffer_));
         }
     }
 
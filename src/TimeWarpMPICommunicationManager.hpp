@@ -4,14 +4,23 @@
 #include <mpi.h>
 #include <vector>
 #include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <mutex>
+#include <thread>
+#include <utility>
 
+#include "AggregateSizeTuner.hpp"
+#include "MessageBufferPool.hpp"
+#include "SPSCQueue.hpp"
 #include "TimeWarpCommunicationManager.hpp"
 #include "TimeWarpKernelMessage.hpp"
 
 namespace warped {
 
 struct MessageQueue;
+struct Outbox;
 struct MPISendQueue;
 struct MPIRecvQueue;
 
@@ -19,10 +28,12 @@ struct MPIRecvQueue;
 
 class TimeWarpMPICommunicationManager : public TimeWarpCommunicationManager {
 public:
-    TimeWarpMPICommunicationManager(unsigned int max_buffer_size, unsigned max_aggregate) :
-        max_buffer_size_(max_buffer_size*max_aggregate), max_aggregate_(max_aggregate) {}
+    TimeWarpMPICommunicationManager(unsigned int max_buffer_size, unsigned max_aggregate,
+                                    bool is_aggregation_adaptive = false,
+                                    unsigned int max_aggregation_delay = 0,
+                                    bool is_message_thread_dedicated = false);
 
-    virtual ~TimeWarpMPICommunicationManager() = default;
+    virtual ~TimeWarpMPICommunicationManager();
     unsigned int initialize();
     void finalize();
     unsigned int getNumProcesses();
@@ -33,24 +44,100 @@ public:
     void handleMessages();
     void flushMessages();
 
+    void startMessageThread(std::function<void()> thread_init);
+    void stopMessageThread();
+
+    void reportStraggler(unsigned int node_id);
+
+    uint64_t numAggregatesSent();
+    uint64_t numAggregatedMessages();
+
     int sumReduceUint64(uint64_t* send_local, uint64_t* recv_global);
     int gatherUint64(uint64_t* send_local, uint64_t* recv_root);
     int sumAllReduceInt64(int64_t* send_local, int64_t* recv_global);
     int minAllReduceUint(unsigned int* send_local, unsigned int* recv_global);
 
+    void startAllReduce(unsigned int* send_min, unsigned int* recv_min,
+                        int64_t* send_sum, int64_t* recv_sum);
+    bool testAllReduce();
+
 protected:
     void packAndSend(unsigned int receiver_id);
+    std::size_t packMessages(unsigned int receiver_id, unsigned int num_stragglers,
+                             std::vector<uint8_t>& buffer);
 
     unsigned int startSendRequests();
     unsigned int startReceiveRequests();
     unsigned int testSendRequests();
     unsigned int testReceiveRequests();
 
+    // Tests and starts the send and receive requests once and returns how many there were
+    unsigned int progressMessages();
+
+    // Sends the aggregates for all nodes
+    void sendAggregates();
+
+    void runMessageThread(std::function<void()> thread_init);
+
+    // Runs the handlers of the messages passed on by the message thread and returns how many
+    unsigned int handleControlMessages();
+
+    void dispatchMessage(std::unique_ptr<TimeWarpKernelMessage> msg);
+
+    // Takes mpi_lock_ for a collective operation of the master thread
+    std::unique_lock<std::mutex> lockForCollective();
+
+    // Outbox of the calling thread, registered on its first message
+    Outbox& threadOutbox();
+
     bool isInitiatingThread();
 
 private:
-    unsigned int max_buffer_size_;
-    unsigned int max_aggregate_;
+    // Messages are inserted into an outbox of the inserting thread together with a ticket from
+    // next_ticket_. The thread sending them merges the outboxes in ticket order, so messages
+    // are sent in the order they were inserted and the inserting threads share no lock.
+    std::atomic<Outbox*> outboxes_ {nullptr};
+    alignas(64) std::atomic<uint64_t> next_ticket_ {0};
+    // Every message with a lower ticket has been taken from the outboxes
+    uint64_t next_ticket_to_send_ = 0;
+    const unsigned int instance_id_;
+
+    // With a dedicated message thread, all sends and receives happen on that thread. Messages
+    // other than events are passed on to the master thread through control_messages_, and a
+    // flush requested by the master thread is done by the message thread.
+    bool is_message_thread_dedicated_;
+    std::thread message_thread_;
+    std::atomic<bool> stop_message_thread_ {false};
+    std::atomic<bool> flush_requested_ {false};
+    bool is_on_message_thread_ = false;
+    SPSCQueue<std::unique_ptr<TimeWarpKernelMessage>> control_messages_;
+
+    // Serializes the MPI calls of the message thread and the collective operations of the
+    // master thread. The message thread lets a waiting collective operation go first.
+    std::mutex mpi_lock_;
+    std::atomic<bool> is_collective_waiting_ {false};
+
+    // Communicator of the reductions started by startAllReduce, so a process may take part in
+    // the blocking collective operations while one of them is still pending
+    MPI_Comm allreduce_comm_ = MPI_COMM_NULL;
+    MPI_Request allreduce_requests_[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+
+    // Size of the buffer an aggregate is first serialized into. It grows whenever an aggregate
+    // does not fit, so later aggregates of that size are serialized only once.
+    std::size_t send_buffer_size_;
+
+    // Number of event messages aggregated for each receiver
+    AggregateSizeTuner aggregate_size_;
+
+    // Longest time a message is held for aggregation, 0 for no limit
+    std::chrono::microseconds max_aggregation_delay_;
+    std::unique_ptr<std::chrono::steady_clock::time_point[]> aggregate_start_by_receiver_;
+
+    // Rollbacks caused by events from each node since the last aggregate sent to it
+    std::unique_ptr<std::atomic<unsigned int>[]> stragglers_by_sender_;
+
+    uint64_t num_aggregates_sent_ = 0;
+    uint64_t num_aggregated_messages_ = 0;
 
     int num_processes_;
     int my_rank_;
@@ -60,13 +147,16 @@ private:
 
     std::shared_ptr<MessageQueue> send_queue_;
     std::shared_ptr<MessageQueue> recv_queue_;
+
+    // Buffers of the send and receive requests are recycled once the requests complete
+    MessageBufferPool buffer_pool_;
 };
 
 struct PendingRequest {
-    PendingRequest(std::unique_ptr<uint8_t[]> buffer, unsigned int count) :
+    PendingRequest(std::vector<uint8_t> buffer, unsigned int count) :
         buffer_(std::move(buffer)), count_(count) {}
 
-    std::unique_ptr<uint8_t[]> buffer_;
+    std::vector<uint8_t> buffer_;
     MPI_Request request_;
     int flag_;
     MPI_Status status_;
@@ -79,12 +169,21 @@ struct MessageQueue {
 
     unsigned int max_buffer_size_;
 
-    std::deque<std::unique_ptr<TimeWarpKernelMessage>>  msg_list_;
-    std::mutex msg_list_lock_;
-
     std::vector<std::unique_ptr<PendingRequest>> pending_request_list_;
 };
 
+// Messages inserted by one thread, in the order of their tickets
+struct Outbox {
+    static constexpr uint64_t NO_TICKET = (uint64_t)-1;
+
+    SPSCQueue<std::pair<uint64_t, std::unique_ptr<TimeWarpKernelMessage>>> messages_;
+
+    // Lowest ticket the thread may take for the message it is inserting, or NO_TICKET
+    std::atomic<uint64_t> pending_ticket_ {NO_TICKET};
+
+    Outbox* next_ = nullptr;
+};
+
 } // namespace warped
 
 #endif
@@ -1,6 +1,8 @@
+#include <algorithm> // for std::partition_point
 #include <limits> // for std::numeric_limits<unsigned int>::max()
 
 #include "utility/memory.hpp"
+#include "utility/warnings.hpp"
 #include "TimeWarpOutputManager.hpp"
 
 namespace warped {
@@ -10,34 +12,31 @@ void TimeWarpOutputManager::initialize(unsigned int num_local_lps) {
     num_local_lps_ = num_local_lps;
 }
 
-void TimeWarpOutputManager::insertEvent(std::shared_ptr<Event> input_event,
-        std::shared_ptr<Event> output_event, unsigned int local_lp_id) {
-    output_queue_[local_lp_id].push_back(OutputEvent(input_event, output_event));
+void TimeWarpOutputManager::insertEvent(const std::shared_ptr<Event>& input_event,
+        const std::shared_ptr<Event>& output_event, unsigned int local_lp_id) {
+    output_queue_[local_lp_id].emplace_back(input_event, output_event);
 }
 
+// NOTE: The events are sent in the order of their input events, so the events to remove are
+//       found with a binary search and erased at once
 unsigned int TimeWarpOutputManager::fossilCollect(unsigned int gvt, unsigned int local_lp_id) {
 
     unsigned int retval = std::numeric_limits<unsigned int>::max();
 
-    if (output_queue_[local_lp_id].empty()) {
-        return retval;
-    }
-
-    auto min = output_queue_[local_lp_id].begin();
-    while ((min != output_queue_[local_lp_id].end()) && (min->input_event_->timestamp() < gvt)) {
-        output_queue_[local_lp_id].pop_front();
-        min = output_queue_[local_lp_id].begin();
-    }
+    auto& output_queue = output_queue_[local_lp_id];
+    auto min = std::partition_point(output_queue.begin(), output_queue.end(),
+        [gvt](const OutputEvent& event) { return event.input_event_->timestamp() < gvt; });
+    output_queue.erase(output_queue.begin(), min);
 
-    if (min != output_queue_[local_lp_id].end()) {
-        retval = min->input_event_->timestamp();
+    if (!output_queue.empty()) {
+        retval = output_queue.front().input_event_->timestamp();
     }
 
     return retval;
 }
 
 std::unique_ptr<std::vector<std::shared_ptr<Event>>>
-TimeWarpOutputManager::removeEventsSentAfter(std::shared_ptr<Event> straggler_event,
+TimeWarpOutputManager::removeEventsSentAfter(const std::shared_ptr<Event>& straggler_event,
     unsigned int local_lp_id) {
 
     // We need to get all the events that are STRICTLY GREATER than the straggler event.
@@ -51,13 +50,59 @@ TimeWarpOutputManager::removeEventsSentAfter(std::shared_ptr<Event> straggler_ev
         auto back = std::move(output_queue_[local_lp_id].back());
         output_queue_[local_lp_id].pop_back();
         // Events are returned in order of LARGEST to SMALLEST
-        events_to_cancel->push_back(back.output_event_);
+        events_to_cancel->push_back(std::move(back.output_event_));
         max = output_queue_[local_lp_id].rbegin();
     }
 
     return events_to_cancel;
 }
 
+// NOTE: Events are never held back by a rollback unless cancellation is lazy
+bool TimeWarpOutputManager::isRegenerated(const std::shared_ptr<Event>& input_event,
+    const std::shared_ptr<Event>& output_event, unsigned int local_lp_id) {
+    unused(input_event, output_event, local_lp_id);
+    return false;
+}
+
+std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+TimeWarpOutputManager::eventsNotRegenerated(const std::shared_ptr<Event>& processed_event,
+    unsigned int local_lp_id) {
+    unused(processed_event, local_lp_id);
+    return nullptr;
+}
+
+std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+TimeWarpOutputManager::eventsSentByCancelledEvent(const std::shared_ptr<Event>& cancelled_event,
+    unsigned int local_lp_id) {
+    unused(cancelled_event, local_lp_id);
+    return nullptr;
+}
+
+bool TimeWarpOutputManager::isLazy(unsigned int local_lp_id) {
+    unused(local_lp_id);
+    return false;
+}
+
+bool TimeWarpOutputManager::canHoldEvents() {
+    return false;
+}
+
+// NOTE: Aggressive cancellation does not compare the events sent again
+uint64_t TimeWarpOutputManager::numComparedEvents(unsigned int local_lp_id) {
+    unused(local_lp_id);
+    return 0;
+}
+
+uint64_t TimeWarpOutputManager::numRegeneratedEvents(unsigned int local_lp_id) {
+    unused(local_lp_id);
+    return 0;
+}
+
+unsigned int TimeWarpOutputManager::numModeSwitches(unsigned int local_lp_id) {
+    unused(local_lp_id);
+    return 0;
+}
+
 std::size_t TimeWarpOutputManager::size(unsigned int local_lp_id) {
     return output_queue_[local_lp_id].size();
 }
@@ -1,6 +1,7 @@
 #ifndef OUTPUT_MANAGER_HPP
 #define OUTPUT_MANAGER_HPP
 
+#include <cstdint>  // for uint64_t
 #include <vector>
 #include <deque>
 
@@ -20,11 +21,11 @@ public:
     virtual ~TimeWarpOutputManager() = default;
 
     // Creates an output queue for each lp as well as locks for each output queue.
-    void initialize(unsigned int num_local_lps);
+    virtual void initialize(unsigned int num_local_lps);
 
     // Insert an event into the output queue for the specified lp
-    void insertEvent(std::shared_ptr<Event> input_event, std::shared_ptr<Event> output_event,
-        unsigned int local_lp_id);
+    void insertEvent(const std::shared_ptr<Event>& input_event,
+        const std::shared_ptr<Event>& output_event, unsigned int local_lp_id);
 
     // Remove any events from the output queue before the gvt for the specified lp
     unsigned int fossilCollect(unsigned int gvt, unsigned int local_lp_id);
@@ -35,12 +36,48 @@ public:
     // The rollback method will return a vector of negative events that must be sent
     // as anti-messages
     virtual std::unique_ptr<std::vector<std::shared_ptr<Event>>>
-        rollback(std::shared_ptr<Event> straggler_event, unsigned int local_lp_id) = 0;
+        rollback(const std::shared_ptr<Event>& straggler_event, unsigned int local_lp_id) = 0;
+
+    // Returns true if output_event, sent while processing input_event, is the same as an
+    // event which was sent by the same input event before a rollback and has not been
+    // cancelled. The earlier event is then kept and output_event must not be sent.
+    virtual bool isRegenerated(const std::shared_ptr<Event>& input_event,
+        const std::shared_ptr<Event>& output_event, unsigned int local_lp_id);
+
+    // Called once processed_event has been processed. Returns the events held back by a
+    // rollback which can no longer be regenerated, to be sent as anti-messages, or nullptr if
+    // there are none.
+    virtual std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+        eventsNotRegenerated(const std::shared_ptr<Event>& processed_event,
+                             unsigned int local_lp_id);
+
+    // Called once cancelled_event has been cancelled. Returns the events it sent before a
+    // rollback which are still held back, to be sent as anti-messages, or nullptr if there are
+    // none.
+    virtual std::unique_ptr<std::vector<std::shared_ptr<Event>>>
+        eventsSentByCancelledEvent(const std::shared_ptr<Event>& cancelled_event,
+                                   unsigned int local_lp_id);
+
+    // Whether a rollback of the specified lp currently holds back the events sent after the
+    // straggler instead of cancelling them
+    virtual bool isLazy(unsigned int local_lp_id);
+
+    // Whether events sent by a rolled back event can be held back until it is processed again
+    // or cancelled, for any lp
+    virtual bool canHoldEvents();
+
+    // Number of events sent before rollbacks of the specified lp which were compared with the
+    // events sent again, and how many of them were regenerated
+    virtual uint64_t numComparedEvents(unsigned int local_lp_id);
+    virtual uint64_t numRegeneratedEvents(unsigned int local_lp_id);
+
+    // Number of times the specified lp switched between aggressive and lazy cancellation
+    virtual unsigned int numModeSwitches(unsigned int local_lp_id);
 
 protected:
 
     struct OutputEvent {
-        OutputEvent(std::shared_ptr<Event> ie, std::shared_ptr<Event> oe) :
+        OutputEvent(const std::shared_ptr<Event>& ie, const std::shared_ptr<Event>& oe) :
             input_event_(ie), output_event_(oe) {}
 
         std::shared_ptr<Event> input_event_;
@@ -48,7 +85,8 @@ protected:
     };
 
     std::unique_ptr<std::vector<std::shared_ptr<Event>>>
-        removeEventsSentAfter(std::shared_ptr<Event> straggler_event, unsigned int local_lp_id);
+        removeEventsSentAfter(const std::shared_ptr<Event>& straggler_event,
+                              unsigned int local_lp_id);
 
     // Array of local output queues and locks
     std::unique_ptr<std::deque<OutputEvent> []> output_queue_;
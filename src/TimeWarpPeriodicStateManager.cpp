@@ -1,4 +1,9 @@
 #include "TimeWarpPeriodicStateManager.hpp"
+
+#include <algorithm> // for std::min, std::max
+#include <chrono>    // for std::chrono::steady_clock
+#include <cmath>     // for std::sqrt
+
 #include "LogicalProcess.hpp"
 #include "utility/memory.hpp"
 
@@ -10,31 +15,109 @@ void TimeWarpPeriodicStateManager::initialize(unsigned int num_local_lps) {
     count_ = make_unique<unsigned int []>(num_local_lps);
     memset(count_.get(), 0, num_local_lps*sizeof(unsigned int));
 
+    if (is_adaptive_) {
+        tuning_ = make_unique<CheckpointTuning []>(num_local_lps);
+        for (unsigned int i = 0; i < num_local_lps; i++) {
+            tuning_[i].period_ = std::min(std::max(period_, 1U), max_period_);
+        }
+    }
+
     TimeWarpStateManager::initialize(num_local_lps);
 }
 
-void TimeWarpPeriodicStateManager::saveState(std::shared_ptr<Event> current_event,
+void TimeWarpPeriodicStateManager::saveState(const std::shared_ptr<Event>& current_event,
     unsigned int local_lp_id, LogicalProcess *lp) {
 
     // Save if count is zero. State will always be saved on first call
+    if (!is_adaptive_) {
+        if (count_[local_lp_id] == 0) {
+            saveLPState(current_event, local_lp_id, lp);
+            count_[local_lp_id] = period_ - 1;
+        } else {
+            count_[local_lp_id]--;
+        }
+        return;
+    }
+
+    auto& tuning = tuning_[local_lp_id];
     if (count_[local_lp_id] == 0) {
+        auto start = std::chrono::steady_clock::now();
+        saveLPState(current_event, local_lp_id, lp);
+        auto stop = std::chrono::steady_clock::now();
 
-        auto lp_state = lp->getState().clone();
+        tuning.saves_++;
+        tuning.save_time_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                                    stop - start).count();
+        count_[local_lp_id] = tuning.period_ - 1;
+    } else {
+        count_[local_lp_id]--;
+    }
 
-        std::list<std::shared_ptr<std::stringstream> > saved_rng_list;
-        for (auto rng = lp->rng_list_.begin(); rng != lp->rng_list_.end(); rng++) {
-            auto ss = std::make_shared<std::stringstream>();
-            (*rng)->getState(*ss);
-            saved_rng_list.push_back(ss);
-        }
+    if (++tuning.events_ >= ADJUST_EVENTS) {
+        adjustPeriod(local_lp_id);
+    }
+}
+
+void TimeWarpPeriodicStateManager::coastForwardDone(unsigned int local_lp_id,
+    unsigned int num_events, uint64_t duration) {
+
+    if (!is_adaptive_) return;
 
-        state_queue_[local_lp_id].emplace_back(current_event, std::move(lp_state), saved_rng_list);
+    auto& tuning = tuning_[local_lp_id];
+    tuning.rollbacks_++;
+    tuning.coast_forward_events_ += num_events;
+    tuning.coast_forward_time_ += duration;
+}
+
+unsigned int TimeWarpPeriodicStateManager::checkpointInterval(unsigned int local_lp_id) {
+
+    return is_adaptive_ ? tuning_[local_lp_id].period_ : period_;
+}
+
+void TimeWarpPeriodicStateManager::adjustPeriod(unsigned int local_lp_id) {
+
+    auto& tuning = tuning_[local_lp_id];
+    unsigned int period = tuning.period_;
+
+    if (tuning.rollbacks_ == 0) {
+        // Saved states are not being used, save less often
+        period *= 2;
+
+    } else if ((tuning.coast_forward_events_ == 0) || (tuning.saves_ == 0)) {
+        // Every rollback went back to a saved state exactly, so there is no coast forward
+        // cost to weigh against yet. Grow slowly to measure it.
+        period++;
 
-        count_[local_lp_id] = period_ - 1;
     } else {
-        count_[local_lp_id]--;
+        double save_cost = double(tuning.save_time_) / tuning.saves_;
+        double coast_forward_cost =
+            double(tuning.coast_forward_time_) / tuning.coast_forward_events_;
+        double rollback_rate = double(tuning.rollbacks_) / tuning.events_;
+
+        double best_period = std::sqrt(2.0 * save_cost / (rollback_rate * coast_forward_cost));
+
+        // Move at most a factor of two at a time to keep the period stable
+        best_period = std::min(best_period, 2.0 * period);
+        best_period = std::max(best_period, 0.5 * period);
+        period = static_cast<unsigned int>(best_period + 0.5);
     }
 
+    tuning.period_ = std::min(std::max(period, 1U), max_period_);
+
+    // Keep half of the history so that the period follows changes in the model
+    tuning.events_ /= 2;
+    tuning.rollbacks_ /= 2;
+    tuning.saves_ /= 2;
+    tuning.save_time_ /= 2;
+    tuning.coast_forward_events_ /= 2;
+    tuning.coast_forward_time_ /= 2;
+}
+
+void TimeWarpPeriodicStateManager::saveLPState(const std::shared_ptr<Event>& current_event,
+    unsigned int local_lp_id, LogicalProcess *lp) {
+
+    auto lp_state = lp->getState().clone();
+    state_queue_[local_lp_id].emplace_back(current_event, std::move(lp_state), saveRngState(lp));
 }
 
 } // namespace warped
@@ -1,6 +1,7 @@
 #ifndef PERIODIC_STATE_MANAGER_HPP
 #define PERIODIC_STATE_MANAGER_HPP
 
+#include <cstdint>
 #include <cstring>
 
 #include "TimeWarpStateManager.hpp"
@@ -9,6 +10,12 @@
  * implementation, the period is fixed and is a number of events. The save state method
  * should be called for each event processed so that the period count can be decremented. When
  * period count reaches 0, the state is saved.
+ *
+ * In adaptive mode the period is tuned for each lp at run time. The manager measures how
+ * often the lp rolls back, how long a state save takes and how long coasting forward over one
+ * event takes, and periodically sets the period to the one which minimizes the sum of the
+ * saving and coast forward costs per event, sqrt(2 * save cost / (rollbacks per event *
+ * coast forward cost)). The given period is used as the starting period.
  */
 
 namespace warped {
@@ -16,21 +23,55 @@ namespace warped {
 class TimeWarpPeriodicStateManager : public TimeWarpStateManager {
 public:
 
-    TimeWarpPeriodicStateManager(unsigned int period) :
-        period_(period) {}
+    TimeWarpPeriodicStateManager(unsigned int period, bool is_adaptive = false,
+                                 unsigned int max_period = 100) :
+        period_(period), is_adaptive_(is_adaptive), max_period_(max_period) {}
 
     virtual ~TimeWarpPeriodicStateManager() = default;
 
     void initialize(unsigned int num_local_lps) override;
 
     // Saves the state of the specified lp if the count is equal to 0.
-    virtual void saveState(std::shared_ptr<Event> current_event, unsigned int local_lp_id,
+    virtual void saveState(const std::shared_ptr<Event>& current_event, unsigned int local_lp_id,
         LogicalProcess *lp) override;
 
+    void coastForwardDone(unsigned int local_lp_id, unsigned int num_events,
+        uint64_t duration) override;
+
+    unsigned int checkpointInterval(unsigned int local_lp_id) override;
+
+protected:
+    // Saves a full copy of the state of the specified lp
+    virtual void saveLPState(const std::shared_ptr<Event>& current_event,
+        unsigned int local_lp_id, LogicalProcess *lp);
+
 private:
+    // Sets a new period for the lp from the costs measured since the last adjustment
+    void adjustPeriod(unsigned int local_lp_id);
+
+    // Number of events of an lp between adjustments of its period
+    static constexpr uint64_t ADJUST_EVENTS = 256;
+
     // Period is the number of events that must be processed before saving state
     unsigned int period_;
 
+    bool is_adaptive_;
+    unsigned int max_period_;
+
+    // Measurements for the adaptive period of one lp. Times are in nanoseconds.
+    struct CheckpointTuning {
+        unsigned int period_ = 0;
+        uint64_t events_ = 0;
+        uint64_t rollbacks_ = 0;
+        uint64_t saves_ = 0;
+        uint64_t save_time_ = 0;
+        uint64_t coast_forward_events_ = 0;
+        uint64_t coast_forward_time_ = 0;
+    };
+
+    // Only used in adaptive mode (per lp)
+    std::unique_ptr<CheckpointTuning []> tuning_;
+
     // Count keeps a running count of the number of event that we must wait before saving
     // the state again (per lp)
     std::unique_ptr<unsigned int []> count_;
@@ -1,6 +1,7 @@
 #include <limits> // for std::numeric_limits<unsigned int>::max();
 #include <cassert>
-#include <algorithm> // for std::min
+#include <algorithm> // for std::min, std::partition_point
+#include <iterator>  // for std::make_move_iterator
 
 #include "TimeWarpStateManager.hpp"
 #include "LogicalProcess.hpp"
@@ -14,8 +15,8 @@ void TimeWarpStateManager::initialize(unsigned int num_local_lps) {
     num_local_lps_ = num_local_lps;
 }
 
-std::shared_ptr<Event> TimeWarpStateManager::restoreState(std::shared_ptr<Event> rollback_event,
-    unsigned int local_lp_id, LogicalProcess *lp) {
+std::shared_ptr<Event> TimeWarpStateManager::restoreState(
+    const std::shared_ptr<Event>& rollback_event, unsigned int local_lp_id, LogicalProcess *lp) {
 
     assert(!state_queue_[local_lp_id].empty());
 
@@ -35,51 +36,61 @@ std::shared_ptr<Event> TimeWarpStateManager::restoreState(std::shared_ptr<Event>
 
     lp->getState().restoreState(*max->lp_state_);
 
-    // Restore state of random number generators
-    for (auto rng = lp->rng_list_.rbegin(); rng != lp->rng_list_.rend(); rng++) {
-        auto ss = std::move(max->rng_state_.back());
-        max->rng_state_.pop_back();
-        (*rng)->restoreState(*ss);
-    }
+    restoreRngState(*max, lp);
+
+    // Return the state
+    return max->state_event_;
+}
 
-    // Need to resave state of random number generator
+std::vector<unsigned char> TimeWarpStateManager::saveRngState(LogicalProcess *lp) {
+
+    std::vector<unsigned char> rng_state;
     for (auto rng = lp->rng_list_.begin(); rng != lp->rng_list_.end(); rng++) {
-        auto ss = std::make_shared<std::stringstream>();
-        (*rng)->getState(*ss);
-        max->rng_state_.push_back(ss);
+        (*rng)->saveSnapshot(rng_state);
     }
+    return rng_state;
+}
 
-    // Return the state
-    return max->state_event_;
+void TimeWarpStateManager::restoreRngState(const SavedState& saved_state, LogicalProcess *lp) {
+
+    // The snapshots are not consumed, so the saved state stays valid for later rollbacks
+    const unsigned char *position = saved_state.rng_state_.data();
+    for (auto rng = lp->rng_list_.begin(); rng != lp->rng_list_.end(); rng++) {
+        (*rng)->restoreSnapshot(position);
+    }
+    assert(position == saved_state.rng_state_.data() + saved_state.rng_state_.size());
 }
 
 // NOTE: Returns the time at which events should be fossil collected before
+// NOTE: The states are saved in timestamp order, so the states to remove are found with a
+//       binary search and erased at once
 unsigned int TimeWarpStateManager::fossilCollect(unsigned int gvt, unsigned int local_lp_id) {
 
-    if (state_queue_[local_lp_id].empty()) {
+    auto& state_queue = state_queue_[local_lp_id];
+    if (state_queue.empty()) {
         // Return zero so that no events are fossil collected.
         return 0;
     }
 
-    // Keep two iterators which keep track of the two minimum elements in the state queue
-    auto min = state_queue_[local_lp_id].begin();
-    auto next = std::next(min);
-
-    // We need to keep a state that is less than the GVT
-    // Loop through and delete states until min timestamp is less than GVT and next timestamp is
-    //  greater than GVT.
-    while ((next != state_queue_[local_lp_id].end()) && (next->state_event_->timestamp() < gvt)) {
-        state_queue_[local_lp_id].pop_front();
-        min = state_queue_[local_lp_id].begin();
-        next = std::next(min);
-    }
-
     if (gvt == (unsigned int)-1) {
-        state_queue_[local_lp_id].pop_front();
+        state_queue.clear();
         return gvt;
     }
 
-    return min->state_event_->timestamp();
+    // We need to keep the last state that is less than the GVT, or the first state if there is
+    //  none
+    auto next = std::partition_point(std::next(state_queue.begin()), state_queue.end(),
+        [gvt](const SavedState& state) { return state.state_event_->timestamp() < gvt; });
+    state_queue.erase(state_queue.begin(), std::prev(next));
+
+    return state_queue.front().state_event_->timestamp();
+}
+
+void TimeWarpStateManager::placeStateQueue(unsigned int local_lp_id) {
+    auto& state_queue = state_queue_[local_lp_id];
+    std::deque<SavedState> placed_queue(std::make_move_iterator(state_queue.begin()),
+                                        std::make_move_iterator(state_queue.end()));
+    state_queue.swap(placed_queue);
 }
 
 // NOTE: Used for debugging
@@ -6,9 +6,10 @@
  * the state.
  */
 
+#include <cstdint>
 #include <memory>
 #include <deque>
-#include <list>
+#include <vector>
 
 #include "TimeWarpEventDispatcher.hpp"
 #include "LogicalProcess.hpp"
@@ -29,28 +30,52 @@ public:
     unsigned int fossilCollect(unsigned int gvt, unsigned int local_lp_id);
 
     // Restores a state based on rollback time for the given lp.
-    std::shared_ptr<Event> restoreState(std::shared_ptr<Event> rollback_event, unsigned int local_lp_id,
-        LogicalProcess *lp);
+    virtual std::shared_ptr<Event> restoreState(const std::shared_ptr<Event>& rollback_event,
+        unsigned int local_lp_id, LogicalProcess *lp);
+
+    // Reallocates the state queue of the specified lp from the calling thread, so that its
+    // memory is local to the worker thread which will use it
+    void placeStateQueue(unsigned int local_lp_id);
 
     // Number of states in the state queue for the specified lp
     std::size_t size(unsigned int local_lp_id);
 
-    virtual void saveState(std::shared_ptr<Event> current_event, unsigned int local_lp_id,
+    virtual void saveState(const std::shared_ptr<Event>& current_event, unsigned int local_lp_id,
         LogicalProcess *lp) = 0;
 
+    // Called after the lp has coasted forward over num_events events in duration nanoseconds
+    // following a rollback
+    virtual void coastForwardDone(unsigned int local_lp_id, unsigned int num_events,
+        uint64_t duration) = 0;
+
+    // Number of events between saved states for the specified lp
+    virtual unsigned int checkpointInterval(unsigned int local_lp_id) = 0;
+
 protected:
 
     struct SavedState {
-        SavedState(std::shared_ptr<Event> state_event, std::unique_ptr<LPState> lp_state,
-            std::list<std::shared_ptr<std::stringstream> > rng_state)
+        SavedState(const std::shared_ptr<Event>& state_event, std::unique_ptr<LPState> lp_state,
+            std::vector<unsigned char> rng_state, std::vector<unsigned char> undo_log = {})
                 : state_event_(state_event), lp_state_(std::move(lp_state)),
-                rng_state_(rng_state) {}
+                rng_state_(std::move(rng_state)), undo_log_(std::move(undo_log)) {}
 
         std::shared_ptr<Event> state_event_;
         std::unique_ptr<LPState> lp_state_;
-        std::list<std::shared_ptr<std::stringstream> > rng_state_;
+
+        // Binary snapshots of all random number generators of the lp, in registration order
+        std::vector<unsigned char> rng_state_;
+
+        // Only used by incremental state saving, in which case lp_state_ is null. Holds the
+        // old contents of the bytes which changed since the previous saved state.
+        std::vector<unsigned char> undo_log_;
     };
 
+    // Saves the state of all random number generators of the lp
+    std::vector<unsigned char> saveRngState(LogicalProcess *lp);
+
+    // Restores the random number generators of the lp from a saved state
+    void restoreRngState(const SavedState& saved_state, LogicalProcess *lp);
+
     // Array of vectors (Array of states queues), one for each lp
     std::unique_ptr<std::deque<SavedState> []> state_queue_;
 
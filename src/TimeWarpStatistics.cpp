@@ -1,5 +1,6 @@
 #include <cstring>  // for std::memset
 #include <fstream>
+#include <string>
 
 #include "TimeWarpStatistics.hpp"
 #include "utility/memory.hpp"
@@ -9,7 +10,8 @@ namespace warped {
 void TimeWarpStatistics::initialize(unsigned int num_worker_threads, unsigned int num_objects) {
     num_worker_threads_ = num_worker_threads;
 
-    local_stats_ = make_unique<Stats []>(num_worker_threads+1);
+    // Worker threads, the master thread and the message thread
+    local_stats_ = make_unique<Stats []>(num_worker_threads+2);
     local_stats_[num_worker_threads][NUM_OBJECTS] = num_objects;
 }
 
@@ -82,9 +84,7 @@ void TimeWarpStatistics::calculateStats() {
                 sumReduceLocal(NUM_OBJECTS, num_objects_by_node_);
                 break;
             case EVENTS_ROLLEDBACK.value:
-                global_stats_[EVENTS_ROLLEDBACK] =
-                    global_stats_[EVENTS_PROCESSED] -
-                    global_stats_[EVENTS_COMMITTED];
+                sumReduceLocal(EVENTS_ROLLEDBACK, rolled_back_events_by_node_);
                 break;
             case AVERAGE_RBLENGTH.value:
                 global_stats_[AVERAGE_RBLENGTH] = (global_stats_[TOTAL_ROLLBACKS] == 0) ? 0 :
@@ -113,6 +113,79 @@ void TimeWarpStatistics::calculateStats() {
                                           - global_stats_[NUM_OBJECTS])
                                           / global_stats_[EVENTS_PROCESSED];
                 break;
+            case RELAXED_QUEUE_ROLLBACKS.value:
+                sumReduceLocal(RELAXED_QUEUE_ROLLBACKS, relaxed_queue_rollbacks_by_node_);
+                break;
+            case EVENTS_STOLEN.value:
+                sumReduceLocal(EVENTS_STOLEN, events_stolen_by_node_);
+                break;
+            case CHECKPOINT_INTERVALS.value:
+                sumReduceLocal(CHECKPOINT_INTERVALS, checkpoint_intervals_by_node_);
+                break;
+            case AVERAGE_CHECKPOINT_INTERVAL.value:
+                global_stats_[AVERAGE_CHECKPOINT_INTERVAL] = (global_stats_[NUM_OBJECTS] == 0) ? 0 :
+                    (static_cast<double>(global_stats_[CHECKPOINT_INTERVALS]) /
+                     (static_cast<double>(global_stats_[NUM_OBJECTS])));
+                break;
+            case LAZY_CANCELLATION_HITS.value:
+                sumReduceLocal(LAZY_CANCELLATION_HITS, lazy_cancellation_hits_by_node_);
+                break;
+            case LAZY_CANCELLATION_MISSES.value:
+                sumReduceLocal(LAZY_CANCELLATION_MISSES, lazy_cancellation_misses_by_node_);
+                break;
+            case CANCELLATION_COMPARISONS.value:
+                sumReduceLocal(CANCELLATION_COMPARISONS, cancellation_comparisons_by_node_);
+                break;
+            case CANCELLATION_COMPARISON_HITS.value:
+                sumReduceLocal(CANCELLATION_COMPARISON_HITS,
+                               cancellation_comparison_hits_by_node_);
+                break;
+            case CANCELLATION_HIT_RATIO.value:
+                // Covers the events compared in aggressive mode as well
+                global_stats_[CANCELLATION_HIT_RATIO] =
+                    (global_stats_[CANCELLATION_COMPARISONS] == 0) ? 0 :
+                    (static_cast<double>(global_stats_[CANCELLATION_COMPARISON_HITS]) /
+                     (static_cast<double>(global_stats_[CANCELLATION_COMPARISONS])));
+                break;
+            case LAZY_CANCELLATION_LPS.value:
+                sumReduceLocal(LAZY_CANCELLATION_LPS, lazy_cancellation_lps_by_node_);
+                break;
+            case CANCELLATION_MODE_SWITCHES.value:
+                sumReduceLocal(CANCELLATION_MODE_SWITCHES, cancellation_mode_switches_by_node_);
+                break;
+            case ANNIHILATED_EVENTS.value:
+                sumReduceLocal(ANNIHILATED_EVENTS, annihilated_events_by_node_);
+                break;
+            case SCHEDULED_ANTI_MESSAGES.value:
+                sumReduceLocal(SCHEDULED_ANTI_MESSAGES, scheduled_anti_messages_by_node_);
+                break;
+            case AGGREGATES_SENT.value:
+                sumReduceLocal(AGGREGATES_SENT, aggregates_sent_by_node_);
+                break;
+            case AGGREGATED_MESSAGES.value:
+                sumReduceLocal(AGGREGATED_MESSAGES, aggregated_messages_by_node_);
+                break;
+            case AVERAGE_AGGREGATE_SIZE.value:
+                global_stats_[AVERAGE_AGGREGATE_SIZE] = (global_stats_[AGGREGATES_SENT] == 0) ? 0 :
+                    (static_cast<double>(global_stats_[AGGREGATED_MESSAGES]) /
+                     (static_cast<double>(global_stats_[AGGREGATES_SENT])));
+                break;
+            case GVT_PERIODS.value:
+                // Periods of this node, which starts the calculations with the asynchronous
+                // method
+                global_stats_[GVT_PERIODS] = local_stats_[num_worker_threads_][GVT_PERIODS];
+                break;
+            case AVERAGE_GVT_PERIOD.value:
+                global_stats_[AVERAGE_GVT_PERIOD] = (global_stats_[GVT_CYCLES] == 0) ? 0 :
+                    (static_cast<double>(global_stats_[GVT_PERIODS]) /
+                     (static_cast<double>(global_stats_[GVT_CYCLES])));
+                break;
+            case EARLY_GVT_STARTS.value:
+                sumReduceLocal(EARLY_GVT_STARTS, early_gvt_starts_by_node_);
+                break;
+            case EVENTS_HELD_BACK.value:
+                sumReduceLocal(EVENTS_HELD_BACK, events_held_back_by_node_);
+                break;
             default:
                 break;
         }
@@ -166,6 +239,38 @@ void TimeWarpStatistics::writeToFile(double num_seconds) {
     ofs.close();
 }
 
+void TimeWarpStatistics::addLPCancellation(const std::string& lp_name, bool is_lazy,
+    uint64_t num_compared, uint64_t num_regenerated, unsigned int num_mode_switches) {
+    lp_cancellation_.push_back({lp_name, is_lazy, num_compared, num_regenerated,
+                                num_mode_switches});
+}
+
+void TimeWarpStatistics::writeLPCancellationToFile() {
+    if ((stats_file_ == "none") || lp_cancellation_.empty()) {
+        return;
+    }
+
+    auto file_name = stats_file_ + ".lps";
+    if (comm_manager_->getNumProcesses() > 1) {
+        file_name += "." + std::to_string(comm_manager_->getID());
+    }
+    std::ofstream ofs(file_name, std::ios::out | std::ios::trunc);
+
+    ofs << "LP,\tMode,\tCompared,\tRegenerated,\tHit ratio,\tMode switches" << std::endl;
+    for (auto& lp : lp_cancellation_) {
+        double hit_ratio = (lp.num_compared_ == 0) ? 0 :
+            (static_cast<double>(lp.num_regenerated_) / static_cast<double>(lp.num_compared_));
+        ofs << lp.lp_name_                                   << ",\t"
+            << (lp.is_lazy_ ? "lazy" : "aggressive")         << ",\t"
+            << lp.num_compared_                              << ",\t"
+            << lp.num_regenerated_                           << ",\t"
+            << hit_ratio                                     << ",\t"
+            << lp.num_mode_switches_                         << std::endl;
+    }
+
+    ofs.close();
+}
+
 void TimeWarpStatistics::printStats() {
 
     std::cout << "Totals"                      << "\n"
@@ -183,13 +288,31 @@ void TimeWarpStatistics::printStats() {
               << "\tTotal Rollbacks:           " << global_stats_[TOTAL_ROLLBACKS] << "\n\n"
 
               << "\tTotal anti-messages sent:  " << global_stats_[TOTAL_NEGATIVE_EVENTS] << "\n"
-              << "\tCancelled events:          " << global_stats_[CANCELLED_EVENTS] << "\n\n"
+              << "\tCancelled events:          " << global_stats_[CANCELLED_EVENTS] << "\n"
+              << "\tAnnihilated on insert:     " << global_stats_[ANNIHILATED_EVENTS] << "\n"
+              << "\tScheduled anti-messages:   " << global_stats_[SCHEDULED_ANTI_MESSAGES] << "\n"
+              << "\tLazy cancellation hits:    " << global_stats_[LAZY_CANCELLATION_HITS] << "\n"
+              << "\tLazy cancellation misses:  " << global_stats_[LAZY_CANCELLATION_MISSES] << "\n"
+              << "\tEvents compared:           " << global_stats_[CANCELLATION_COMPARISONS] << "\n"
+              << "\tEvents regenerated:        " << global_stats_[CANCELLATION_COMPARISON_HITS]
+                                                 << "\n"
+              << "\tCancellation hit ratio:    " << global_stats_[CANCELLATION_HIT_RATIO] << "\n"
+              << "\tLazy cancellation LPs:     " << global_stats_[LAZY_CANCELLATION_LPS] << "\n"
+              << "\tCancel mode switches:      " << global_stats_[CANCELLATION_MODE_SWITCHES]
+                                                 << "\n\n"
+
+              << "\tCoast forward events:      " << global_stats_[COAST_FORWARDED_EVENTS] << "\n"
+              << "\tAvg checkpoint interval:   " << global_stats_[AVERAGE_CHECKPOINT_INTERVAL]
+                                                 << " events\n\n"
 
-              << "\tCoast forward events:      " << global_stats_[COAST_FORWARDED_EVENTS] << "\n\n"
+              << "\tAggregate messages sent:   " << global_stats_[AGGREGATES_SENT] << "\n"
+              << "\tAverage aggregate size:    " << global_stats_[AVERAGE_AGGREGATE_SIZE]
+                                                 << " messages\n\n"
 
               << "\tTotal events processed:    " << global_stats_[EVENTS_PROCESSED] << "\n"
               << "\tTotal events committed:    " << global_stats_[EVENTS_COMMITTED] << "\n"
-              << "\tTotal events rolled back:  " << global_stats_[EVENTS_ROLLEDBACK] << "\n\n"
+              << "\tTotal events rolled back:  " << global_stats_[EVENTS_ROLLEDBACK] << "\n"
+              << "\tEvents held back:          " << global_stats_[EVENTS_HELD_BACK] << "\n\n"
 
               << "\tAverage rollback length:   " << global_stats_[AVERAGE_RBLENGTH] << "\n"
               << "\tEfficiency:                " << global_stats_[EFFICIENCY]*100.0 << "%\n\n"
@@ -197,10 +320,15 @@ void TimeWarpStatistics::printStats() {
               << "\tEvents for starved objs:   " << global_stats_[EVENTS_FOR_STARVED_OBJECTS] << "\n"
               << "\tSched event swaps success: " << global_stats_[SCHEDULED_EVENT_SWAPS_SUCCESS] << "\n"
               << "\tSched event swaps failure: " << global_stats_[SCHEDULED_EVENT_SWAPS_FAILURE] << "\n"
-              << "\tDesign Efficiency:         " << global_stats_[DESIGN_EFFICIENCY]*100.0 << "%\n\n"
+              << "\tDesign Efficiency:         " << global_stats_[DESIGN_EFFICIENCY]*100.0 << "%\n"
+              << "\tRelaxed queue rollbacks:   " << global_stats_[RELAXED_QUEUE_ROLLBACKS] << "\n"
+              << "\tEvents stolen:             " << global_stats_[EVENTS_STOLEN] << "\n\n"
 
               << "\tAverage maximum memory:    " << global_stats_[AVERAGE_MAX_MEMORY] << " MB\n"
-              << "\tGVT cycles:                " << global_stats_[GVT_CYCLES] << std::endl << std::endl;
+              << "\tGVT cycles:                " << global_stats_[GVT_CYCLES] << "\n"
+              << "\tAverage GVT period:        " << global_stats_[AVERAGE_GVT_PERIOD] << " ms\n"
+              << "\tEarly GVT starts:          " << global_stats_[EARLY_GVT_STARTS]
+                                                 << std::endl << std::endl;
 
     delete [] local_pos_sent_by_node_;
     delete [] local_neg_sent_by_node_;
@@ -217,6 +345,22 @@ void TimeWarpStatistics::printStats() {
     delete [] starved_obj_events_by_node_;
     delete [] event_swaps_success_by_node_;
     delete [] event_swaps_failed_by_node_;
+    delete [] relaxed_queue_rollbacks_by_node_;
+    delete [] events_stolen_by_node_;
+    delete [] checkpoint_intervals_by_node_;
+    delete [] lazy_cancellation_hits_by_node_;
+    delete [] lazy_cancellation_misses_by_node_;
+    delete [] cancellation_comparisons_by_node_;
+    delete [] cancellation_comparison_hits_by_node_;
+    delete [] lazy_cancellation_lps_by_node_;
+    delete [] cancellation_mode_switches_by_node_;
+    delete [] annihilated_events_by_node_;
+    delete [] scheduled_anti_messages_by_node_;
+    delete [] aggregates_sent_by_node_;
+    delete [] aggregated_messages_by_node_;
+    delete [] early_gvt_starts_by_node_;
+    delete [] rolled_back_events_by_node_;
+    delete [] events_held_back_by_node_;
 }
 
 } // namespace warped
@@ -3,7 +3,9 @@
 
 #include <memory>   // for unique_ptr
 #include <cstdint>  // uint64_t
+#include <string>
 #include <tuple>
+#include <vector>
 
 #include "TimeWarpCommunicationManager.hpp"
 
@@ -43,7 +45,27 @@ struct Stats {
         uint64_t,                   // Scheduled event swap success 22
         uint64_t,                   // Scheduled event swap failed  23
         double,                     // Design Efficiency            24
-        uint64_t                    // dummy/number of elements     25
+        uint64_t,                   // Relaxed queue rollbacks      25
+        uint64_t,                   // Events stolen                26
+        uint64_t,                   // Sum of checkpoint intervals  27
+        double,                     // Average checkpoint interval  28
+        uint64_t,                   // Lazy cancellation hits       29
+        uint64_t,                   // Lazy cancellation misses     30
+        uint64_t,                   // Events compared on reprocess 31
+        uint64_t,                   // Compared events regenerated  32
+        double,                     // Cancellation hit ratio       33
+        uint64_t,                   // Lps with lazy cancellation   34
+        uint64_t,                   // Cancellation mode switches   35
+        uint64_t,                   // Annihilated on insert        36
+        uint64_t,                   // Scheduled anti-messages      37
+        uint64_t,                   // Aggregate messages sent      38
+        uint64_t,                   // Messages in aggregates       39
+        double,                     // Average aggregate size       40
+        uint64_t,                   // Sum of GVT periods           41
+        double,                     // Average GVT period           42
+        uint64_t,                   // Early GVT starts             43
+        uint64_t,                   // Events held back             44
+        uint64_t                    // dummy/number of elements     45
     > stats_;
 
     template<unsigned I>
@@ -78,7 +100,27 @@ const stats_index<21> EVENTS_FOR_STARVED_OBJECTS;
 const stats_index<22> SCHEDULED_EVENT_SWAPS_SUCCESS;
 const stats_index<23> SCHEDULED_EVENT_SWAPS_FAILURE;
 const stats_index<24> DESIGN_EFFICIENCY;
-const stats_index<25> NUM_STATISTICS;
+const stats_index<25> RELAXED_QUEUE_ROLLBACKS;
+const stats_index<26> EVENTS_STOLEN;
+const stats_index<27> CHECKPOINT_INTERVALS;
+const stats_index<28> AVERAGE_CHECKPOINT_INTERVAL;
+const stats_index<29> LAZY_CANCELLATION_HITS;
+const stats_index<30> LAZY_CANCELLATION_MISSES;
+const stats_index<31> CANCELLATION_COMPARISONS;
+const stats_index<32> CANCELLATION_COMPARISON_HITS;
+const stats_index<33> CANCELLATION_HIT_RATIO;
+const stats_index<34> LAZY_CANCELLATION_LPS;
+const stats_index<35> CANCELLATION_MODE_SWITCHES;
+const stats_index<36> ANNIHILATED_EVENTS;
+const stats_index<37> SCHEDULED_ANTI_MESSAGES;
+const stats_index<38> AGGREGATES_SENT;
+const stats_index<39> AGGREGATED_MESSAGES;
+const stats_index<40> AVERAGE_AGGREGATE_SIZE;
+const stats_index<41> GVT_PERIODS;
+const stats_index<42> AVERAGE_GVT_PERIOD;
+const stats_index<43> EARLY_GVT_STARTS;
+const stats_index<44> EVENTS_HELD_BACK;
+const stats_index<45> NUM_STATISTICS;
 
 class TimeWarpStatistics {
 public:
@@ -99,11 +141,17 @@ public:
         return local_stats_[thread_id][i];
     }
 
+    // Count of a thread so far. Only the thread itself may read its counts while it runs.
+    template <unsigned I>
+    uint64_t localCount(stats_index<I> i, unsigned int thread_id) {
+        return local_stats_[thread_id][i];
+    }
+
     template <unsigned I>
     void sumReduceLocal(stats_index<I> j, uint64_t *&recv_array) {
         uint64_t local_count = 0;
 
-        for (unsigned int i = 0; i < num_worker_threads_+1; i++) {
+        for (unsigned int i = 0; i < num_worker_threads_+2; i++) {
             local_count += local_stats_[i][j];
         }
 
@@ -121,8 +169,26 @@ public:
 
     void printStats();
 
+    // Records how the events sent again by a local lp compared with those sent before its
+    // rollbacks, and the cancellation it ended with
+    void addLPCancellation(const std::string& lp_name, bool is_lazy, uint64_t num_compared,
+                           uint64_t num_regenerated, unsigned int num_mode_switches);
+
+    // Every node writes the recorded lps to its own file next to the statistics file
+    void writeLPCancellationToFile();
+
 private:
 
+    struct LPCancellation {
+        std::string lp_name_;
+        bool is_lazy_;
+        uint64_t num_compared_;
+        uint64_t num_regenerated_;
+        unsigned int num_mode_switches_;
+    };
+
+    std::vector<LPCancellation> lp_cancellation_;
+
     std::unique_ptr<Stats []> local_stats_;
     Stats global_stats_;
 
@@ -141,6 +207,22 @@ private:
     uint64_t *starved_obj_events_by_node_;
     uint64_t *event_swaps_success_by_node_;
     uint64_t *event_swaps_failed_by_node_;
+    uint64_t *relaxed_queue_rollbacks_by_node_;
+    uint64_t *events_stolen_by_node_;
+    uint64_t *checkpoint_intervals_by_node_;
+    uint64_t *lazy_cancellation_hits_by_node_;
+    uint64_t *lazy_cancellation_misses_by_node_;
+    uint64_t *cancellation_comparisons_by_node_;
+    uint64_t *cancellation_comparison_hits_by_node_;
+    uint64_t *lazy_cancellation_lps_by_node_;
+    uint64_t *cancellation_mode_switches_by_node_;
+    uint64_t *annihilated_events_by_node_;
+    uint64_t *scheduled_anti_messages_by_node_;
+    uint64_t *aggregates_sent_by_node_;
+    uint64_t *aggregated_messages_by_node_;
+    uint64_t *early_gvt_starts_by_node_;
+    uint64_t *rolled_back_events_by_node_;
+    uint64_t *events_held_back_by_node_;
 
     std::shared_ptr<TimeWarpCommunicationManager> comm_manager_;
 
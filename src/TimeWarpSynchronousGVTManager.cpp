@@ -2,6 +2,7 @@
 #include <cassert>
 
 #include "TimeWarpSynchronousGVTManager.hpp"
+#include "utility/atomic.hpp"
 #include "utility/warnings.hpp"
 #include "utility/memory.hpp"           // for make_unique
 
@@ -10,85 +11,103 @@ namespace warped {
 enum class Color;
 
 void TimeWarpSynchronousGVTManager::initialize() {
-    pthread_barrier_init(&min_report_barrier_, NULL, num_worker_threads_+1);
-
-    local_min_ = make_unique<unsigned int []>(num_worker_threads_+1);
-    send_min_ = make_unique<unsigned int []>(num_worker_threads_+1);
-
-    for (unsigned int i = 0; i <= num_worker_threads_; i++) {
-        local_min_[i] = std::numeric_limits<unsigned int>::max();
-        send_min_[i] = std::numeric_limits<unsigned int>::max();
-    }
-
     recv_min_ = std::numeric_limits<unsigned int>::max();
+    red_send_min_ = std::numeric_limits<unsigned int>::max();
 
     TimeWarpGVTManager::initialize();
 }
 
 bool TimeWarpSynchronousGVTManager::readyToStart() {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - gvt_stop).count();
-    return  (elapsed >= gvt_period_);
+    return periodElapsed(gvt_stop);
 }
 
 void TimeWarpSynchronousGVTManager::progressGVT() {
+
     if (gvt_state_ == GVTState::LOCAL) {
 
-        color_.store(Color::RED);
-        local_gvt_flag_.store(1);
-        pthread_barrier_wait(&min_report_barrier_);
+        // Start the calculation with the first cut
+        if (!started_local_gvt_) {
+            recv_min_.store(std::numeric_limits<unsigned int>::max());
+            red_send_min_.store(std::numeric_limits<unsigned int>::max());
+            color_.store((color_.load() == Color::WHITE) ? Color::RED : Color::WHITE);
+
+            startLocalReports();
+            started_local_gvt_ = true;
+
+        // Once all worker threads have reported, the nodes reduce their minimums
+        } else if (collectLocalReports(worker_min_)) {
+            started_local_gvt_ = false;
+
+            if (comm_manager_->getNumProcesses() > 1) {
+                startGlobalStep();
+                gvt_state_ = GVTState::GLOBAL;
+            } else {
+                finishCalculation(localMinimum());
+            }
+        }
 
-        gvt_state_ = GVTState::GLOBAL;
+    } else if ((gvt_state_ == GVTState::GLOBAL) && testReduction()) {
 
-        int64_t total_msg_count;
-        while (true) {
-            comm_manager_->flushMessages();
-            comm_manager_->handleMessages();
-            int64_t local_msg_count = white_msg_count_.load();
-            comm_manager_->sumAllReduceInt64(&local_msg_count, &total_msg_count);
-            if(total_msg_count == 0)
-                break;
+        // Messages of the initial color are still in transit, so reduce again
+        if (reduced_msg_count_ != 0) {
+            startGlobalStep();
+        } else {
+            finishCalculation(reduced_min_);
         }
+    }
+}
 
-        unsigned int local_min = recv_min_;
-        recv_min_ = std::numeric_limits<unsigned int>::max();
-        for (unsigned int i = 0; i <= num_worker_threads_; i++) {
-            local_min = std::min(local_min, std::min(local_min_[i], send_min_[i]));
-            local_min_[i] = std::numeric_limits<unsigned int>::max();
-            send_min_[i] = std::numeric_limits<unsigned int>::max();
-        }
+void TimeWarpSynchronousGVTManager::finalize() {
+    if (comm_manager_->getNumProcesses() > 1) {
+        completeReductions();
+    }
+    gvt_state_ = GVTState::IDLE;
+}
 
-        comm_manager_->minAllReduceUint(&local_min, &gVT_);
+// NOTE: A worker thread reports its minimum only after the messages it sent before, so all
+//       messages of the initial color have been counted once the worker threads have reported.
+//       The count is read before the minimum, so the messages it has counted as received are
+//       in recv_min_.
+void TimeWarpSynchronousGVTManager::startGlobalStep() {
+    int64_t msg_count = msg_count_[static_cast<int>(initial_color_.load())].load();
+    startReduction(localMinimum(), msg_count);
+}
 
-        gvt_updated_ = true;
+unsigned int TimeWarpSynchronousGVTManager::localMinimum() {
+    return std::min(worker_min_, std::min(recv_min_.load(), red_send_min_.load()));
+}
 
-        color_.store(Color::WHITE);
-        local_gvt_flag_.store(0);
-        pthread_barrier_wait(&min_report_barrier_);
+void TimeWarpSynchronousGVTManager::finishCalculation(unsigned int gvt) {
+    setGVT(gvt);
+    gvt_updated_ = true;
 
-        gvt_stop = std::chrono::steady_clock::now();
-        gvt_state_ = GVTState::IDLE;
-    }
+    initial_color_.store(color_.load());
+
+    gvt_stop = std::chrono::steady_clock::now();
+    gvt_state_ = GVTState::IDLE;
 }
 
-Color TimeWarpSynchronousGVTManager::sendEventUpdate(std::shared_ptr<Event>& event) {
-    unused(event);
+Color TimeWarpSynchronousGVTManager::sendEventUpdate(const std::shared_ptr<Event>& event,
+    unsigned int thread_id) {
+    unused(thread_id);
 
     Color color = color_.load();
+    msg_count_[static_cast<int>(color)]++;
 
-    if (color == Color::WHITE) {
-        white_msg_count_++;
+    if (color != initial_color_.load()) {
+        atomicMin(red_send_min_, event->timestamp());
     }
 
     return color;
 }
 
-void TimeWarpSynchronousGVTManager::receiveEventUpdate(std::shared_ptr<Event>& event, Color color) {
+void TimeWarpSynchronousGVTManager::receiveEventUpdate(const std::shared_ptr<Event>& event,
+    Color color) {
+
+    msg_count_[static_cast<int>(color)]--;
 
-    if (color == Color::WHITE) {
-        white_msg_count_--;
-    } else {
-        recv_min_ = std::min(recv_min_, event->timestamp());
+    if (color == initial_color_.load()) {
+        atomicMin(recv_min_, event->timestamp());
     }
 }
 
@@ -100,24 +119,4 @@ bool TimeWarpSynchronousGVTManager::gvtUpdated() {
     return false;
 }
 
-void TimeWarpSynchronousGVTManager::reportThreadMin(unsigned int timestamp, unsigned int thread_id,
-                                                    unsigned int local_gvt_flag) {
-    if (local_gvt_flag > 0) {
-        local_min_[thread_id] = timestamp;
-
-        pthread_barrier_wait(&min_report_barrier_);
-        pthread_barrier_wait(&min_report_barrier_);
-    }
-}
-
-void TimeWarpSynchronousGVTManager::reportThreadSendMin(unsigned int timestamp, unsigned int thread_id) {
-    if (local_gvt_flag_.load() > 0) {
-        send_min_[thread_id] = std::min(timestamp, send_min_[thread_id]);
-    }
-}
-
-unsigned int TimeWarpSynchronousGVTManager::getLocalGVTFlag() {
-    return local_gvt_flag_.load();
-}
-
 } // namespace warped
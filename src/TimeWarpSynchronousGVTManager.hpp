@@ -4,11 +4,22 @@
 #include <memory> // for shared_ptr
 #include <atomic>
 
-#include <pthread.h>
-
 #include "TimeWarpEventDispatcher.hpp"
 #include "TimeWarpGVTManager.hpp"
 
+/* GVT manager which computes the GVT on all nodes at the same time, with reductions of the
+ * node minimums and message counts. No thread waits for it: when a GVT calculation starts,
+ * each worker thread reports its local minimum once and goes on processing events, and the
+ * master thread goes on handling messages while a reduction is pending.
+ *
+ * Since events are sent while the GVT is calculated, messages are colored as in Mattern's
+ * algorithm. Starting a calculation toggles the color, and the reductions are repeated until
+ * every message of the initial color has been received, so a single one is enough if none
+ * are in transit. The timestamps of the messages of the other color sent and of the initial
+ * color received since the start are part of the local minimum. Once the GVT is known the
+ * initial color is toggled, so the messages of this calculation are counted by the next one.
+ */
+
 namespace warped {
 
 class TimeWarpSynchronousGVTManager : public TimeWarpGVTManager {
@@ -25,39 +36,44 @@ public:
 
     void progressGVT() override;
 
-    void receiveEventUpdate(std::shared_ptr<Event>& event, Color color) override;
+    void receiveEventUpdate(const std::shared_ptr<Event>& event, Color color) override;
 
-    Color sendEventUpdate(std::shared_ptr<Event>& event) override;
+    Color sendEventUpdate(const std::shared_ptr<Event>& event, unsigned int thread_id) override;
 
     bool gvtUpdated() override;
 
     inline int64_t getMessageCount() override {
-        return white_msg_count_.load();
+        return msg_count_[static_cast<int>(initial_color_.load())].load();
     }
 
-    void reportThreadMin(unsigned int timestamp, unsigned int thread_id,
-                                 unsigned int local_gvt_flag) override;
+    void finalize() override;
+
+protected:
+    // Starts a reduction of the message count of the initial color and the local minimum
+    void startGlobalStep();
 
-    void reportThreadSendMin(unsigned int timestamp, unsigned int thread_id) override;
+    unsigned int localMinimum();
 
-    unsigned int getLocalGVTFlag() override;
+    void finishCalculation(unsigned int gvt);
 
-protected:
     bool gvt_updated_ = false;
 
-    std::atomic<int64_t> white_msg_count_ = ATOMIC_VAR_INIT(0);
+    // Messages of each color sent minus those received
+    std::atomic<int64_t> msg_count_[2] {};
 
     std::atomic<Color> color_ = ATOMIC_VAR_INIT(Color::WHITE);
 
-    std::atomic<unsigned int> local_gvt_flag_ = ATOMIC_VAR_INIT(0);
-
-    std::unique_ptr<unsigned int []> local_min_;
+    std::atomic<Color> initial_color_ = ATOMIC_VAR_INIT(Color::WHITE);
 
-    std::unique_ptr<unsigned int []> send_min_;
+    bool started_local_gvt_ = false;
 
-    unsigned int recv_min_;
+    // Minimum reported by the worker threads for this calculation
+    unsigned int worker_min_;
 
-    pthread_barrier_t min_report_barrier_;
+    // Minimum timestamp of the messages of the initial color received and of the other color
+    // sent since the calculation started. Written by any thread.
+    std::atomic<unsigned int> recv_min_;
+    std::atomic<unsigned int> red_send_min_;
 
 };
 
@@ -13,6 +13,7 @@ void TimeWarpTerminationManager::initialize(unsigned int num_worker_threads) {
     std::memset(state_by_thread_.get(), 0, num_worker_threads*sizeof(State));
 
     active_thread_count_ = num_worker_threads;
+    num_worker_threads_ = num_worker_threads;
 
     if (comm_manager_->getID() == 0) {
         is_master_ = true;
@@ -25,6 +26,18 @@ void TimeWarpTerminationManager::initialize(unsigned int num_worker_threads) {
 void TimeWarpTerminationManager::updateMsgCount(int delta) {
     state_lock_.lock();
     msg_count_ += delta;
+
+    // A received message is work for the worker threads, so the node stays active until they
+    // have all looked for events again
+    if (delta < 0) {
+        num_received_++;
+        for (unsigned int i = 0; i < num_worker_threads_; i++) {
+            state_by_thread_[i] = State::ACTIVE;
+        }
+        active_thread_count_ = num_worker_threads_;
+        state_ = State::ACTIVE;
+        sticky_state_ = State::ACTIVE;
+    }
     state_lock_.unlock();
 }
 
@@ -56,23 +69,38 @@ void TimeWarpTerminationManager::receiveTerminationToken(std::unique_ptr<TimeWar
     // We received a token, which means we are master
     is_master_ = true;
 
+    // Take the sticky state and reset it together, so a message received by another thread
+    //  while the token is handled keeps the node active for the next token
+    state_lock_.lock();
+    auto sticky_state = sticky_state_;
+    sticky_state_ = state_;
+    state_lock_.unlock();
+
     // If sticky state is passive, and the token has reached it's originator, then the token
     //  has circulated twice with no change state and we must terminate.
-    if ((sticky_state_ == State::PASSIVE) && (msg->receiver_id == msg->initiator_)) {
+    if ((sticky_state == State::PASSIVE) && (msg->receiver_id == msg->initiator_)) {
         if ((msg->state_ == State::PASSIVE) && (msg->count_ == 0)) {
             // Signal termination to all nodes including self
             sendTerminator();
+        } else {
+            // remain master until this node becomes passive
+            holdTokenCount(msg->count_);
         }
-        // else {
-        //     remain master until this node becomes passive
-        // }
 
-    } else if (sticky_state_ == State::PASSIVE) {
+    } else if (sticky_state == State::PASSIVE) {
         sendTerminationToken(msg->state_, msg->initiator_, msg->count_);
+
+    } else {
+        holdTokenCount(msg->count_);
     }
+}
 
-    // Set sticky_state AFTER sending token
-    sticky_state_ = state_;
+// The messages counted by a token which is not passed on are still in transit, so they must be
+//  counted by the next token this node sends
+void TimeWarpTerminationManager::holdTokenCount(int msg_count) {
+    state_lock_.lock();
+    msg_count_ += msg_count;
+    state_lock_.unlock();
 }
 
 void TimeWarpTerminationManager::sendTerminator() {
@@ -89,10 +117,12 @@ void TimeWarpTerminationManager::receiveTerminator(std::unique_ptr<TimeWarpKerne
     terminate_ = true;
 }
 
-void TimeWarpTerminationManager::setThreadPassive(unsigned int thread_id) {
+void TimeWarpTerminationManager::setThreadPassive(unsigned int thread_id,
+    uint64_t num_received) {
+
     state_lock_.lock();
 
-    if (state_by_thread_[thread_id] != State::PASSIVE) {
+    if ((state_by_thread_[thread_id] != State::PASSIVE) && (num_received == num_received_)) {
         state_by_thread_[thread_id] = State::PASSIVE;
         active_thread_count_--;
 
@@ -1,6 +1,8 @@
 #ifndef TERMINATION_HPP
 #define TERMINATION_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 
@@ -30,8 +32,9 @@ public:
     // Message handler for the terminator
     void receiveTerminator(std::unique_ptr<TimeWarpKernelMessage> kmsg);
 
-    // Report thread passive
-    void setThreadPassive(unsigned int thread_id);
+    // Report thread passive. num_received is the value of numReceived() read before the thread
+    // last looked for an event; the thread stays active if a message arrived since.
+    void setThreadPassive(unsigned int thread_id, uint64_t num_received);
 
     // Report thread active
     void setThreadActive(unsigned int thread_id);
@@ -47,7 +50,12 @@ public:
 
     void updateMsgCount(int delta);
 
+    // Number of messages received so far
+    uint64_t numReceived() { return num_received_.load(); }
+
 private:
+    // Keeps the message count of a token which this node holds back
+    void holdTokenCount(int msg_count);
 
     State state_ = State::ACTIVE;
     std::mutex state_lock_;
@@ -57,6 +65,9 @@ private:
 
     std::unique_ptr<State []> state_by_thread_;
     unsigned int active_thread_count_;
+    unsigned int num_worker_threads_;
+
+    std::atomic<uint64_t> num_received_ {0};
 
     int msg_count_ = 0;
 
@@ -0,0 +1,17 @@
+#ifndef WARPED_UTILITY_ATOMIC_HPP
+#define WARPED_UTILITY_ATOMIC_HPP
+
+#include <atomic>
+
+namespace warped {
+
+// Lowers the value of an atomic minimum to value if it is smaller, without a lock
+template<class T>
+void atomicMin(std::atomic<T>& minimum, T value) {
+    T current = minimum.load(std::memory_order_relaxed);
+    while ((value < current) && !minimum.compare_exchange_weak(current, value)) {}
+}
+
+} // namespace warped
+
+#endif
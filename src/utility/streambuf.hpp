@@ -0,0 +1,69 @@
+#ifndef WARPED_UTILITY_STREAMBUF_HPP
+#define WARPED_UTILITY_STREAMBUF_HPP
+
+// Stream buffers over a block of memory owned by the caller. They let a serializer write into
+// or read from a message buffer directly, without the copies made by string streams.
+
+#include <algorithm> // for std::min
+#include <cstring>   // for std::memcpy
+#include <streambuf>
+
+namespace warped {
+
+// Writes into [begin, begin + capacity). Writes past the end are dropped but still counted, so
+// the caller can tell that the output did not fit and how large a block it needs.
+class MemoryOutputBuffer : public std::streambuf {
+public:
+    MemoryOutputBuffer(char* begin, std::size_t capacity) {
+        setp(begin, begin + capacity);
+    }
+
+    // Number of bytes written so far, including the ones which did not fit
+    std::size_t size() const { return (pptr() - pbase()) + dropped_; }
+
+    bool overflowed() const { return dropped_ > 0; }
+
+protected:
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        std::streamsize count = std::min<std::streamsize>(n, epptr() - pptr());
+        std::memcpy(pptr(), s, count);
+        pbump(static_cast<int>(count));
+        dropped_ += n - count;
+        return n;
+    }
+
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            dropped_++;
+        }
+        return traits_type::not_eof(ch);
+    }
+
+private:
+    std::size_t dropped_ = 0;
+};
+
+// Reads from [begin, begin + size)
+class MemoryInputBuffer : public std::streambuf {
+public:
+    MemoryInputBuffer(const char* begin, std::size_t size) {
+        // NOTE: The get area is never written to
+        char* data = const_cast<char*>(begin);
+        setg(data, data, data + size);
+    }
+
+    // Number of bytes read so far
+    std::size_t position() const { return gptr() - eback(); }
+
+protected:
+    std::streamsize xsgetn(char* s, std::streamsize n) override {
+        std::streamsize count = std::min<std::streamsize>(n, egptr() - gptr());
+        std::memcpy(s, gptr(), count);
+        gbump(static_cast<int>(count));
+        return count;
+    }
+};
+
+} // namespace warped
+
+#endif
@@ -42,17 +42,22 @@ WARPED_DEFINE_LP_STATE_STRUCT(test_LPState) {
 struct test_Event : public warped::Event {
     test_Event() = default;
     test_Event(const std::string& receiver_name, unsigned int receive_time)
-        : receiver_name_(receiver_name), receive_time_(receive_time) {}
+        : receiver_name_(receiver_name), receive_time_(receive_time) {
+        stampKey();
+    }
 
     test_Event(const std::string& receiver_name, unsigned int receive_time, bool is_positive)
                 : receiver_name_(receiver_name), receive_time_(receive_time) {
         event_type_ = is_positive ? warped::EventType::POSITIVE : warped::EventType::NEGATIVE;
+        stampKey();
     }
 
     const std::string& receiverName() const {return receiver_name_;}
 
     unsigned int timestamp() const {return receive_time_;}
 
+    unsigned int size() const {return receiver_name_.length() + sizeof(receive_time_);}
+
     std::string receiver_name_;
     unsigned int receive_time_;
 
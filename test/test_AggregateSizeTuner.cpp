@@ -0,0 +1,60 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include "AggregateSizeTuner.hpp"
+
+TEST_CASE("Aggregate size tuner with a static size") {
+
+    warped::AggregateSizeTuner tuner(8);
+    tuner.initialize(2);
+    CHECK(!tuner.isAdaptive());
+    CHECK(tuner.size(0) == 8);
+    CHECK(tuner.size(1) == 8);
+
+    tuner.aggregateExpired(0, 3);
+    tuner.stragglersReported(1);
+    CHECK(tuner.size(0) == 8);
+    CHECK(tuner.size(1) == 8);
+}
+
+TEST_CASE("Aggregate size tuner with an adaptive size") {
+
+    const unsigned int max_size = 8;
+    warped::AggregateSizeTuner tuner(max_size, true);
+    tuner.initialize(2);
+    CHECK(tuner.isAdaptive());
+
+    // Every receiver starts at the largest size
+    CHECK(tuner.size(0) == max_size);
+    CHECK(tuner.size(1) == max_size);
+
+    SECTION("The size is halved on straggler reports, but never below 1") {
+        tuner.stragglersReported(0);
+        CHECK(tuner.size(0) == 4);
+        CHECK(tuner.size(1) == max_size);
+
+        tuner.stragglersReported(0);
+        tuner.stragglersReported(0);
+        CHECK(tuner.size(0) == 1);
+        tuner.stragglersReported(0);
+        CHECK(tuner.size(0) == 1);
+
+        SECTION("A full aggregate grows the size by one up to the largest size") {
+            for (unsigned int size = 2; size <= max_size; size++) {
+                tuner.aggregateFilled(0);
+                CHECK(tuner.size(0) == size);
+            }
+            tuner.aggregateFilled(0);
+            CHECK(tuner.size(0) == max_size);
+        }
+    }
+
+    SECTION("An expired aggregate cuts the size to the messages it held") {
+        tuner.aggregateExpired(1, 3);
+        CHECK(tuner.size(1) == 3);
+        CHECK(tuner.size(0) == max_size);
+
+        tuner.aggregateFilled(1);
+        CHECK(tuner.size(1) == 4);
+    }
+}
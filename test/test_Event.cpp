@@ -61,3 +61,25 @@ TEST_CASE("Events can be compared from base class", "[Compare][Event]") {
 }
 
 
+
+TEST_CASE("Events with equal times are ordered by sender id", "[Compare][Event]") {
+    std::shared_ptr<warped::Event> e1 = warped::make_unique<test_Event>("receiver1", 1);
+    std::shared_ptr<warped::Event> e2 = warped::make_unique<test_Event>("receiver1", 1);
+    e1->sender_id_ = 1;
+    e2->sender_id_ = 2;
+    e1->stampKey();
+    e2->stampKey();
+
+    CHECK(*e1 < *e2);
+    CHECK_FALSE(*e1 == *e2);
+    CHECK(warped::compareEvents()(e1, e2));
+
+    SECTION("The initial event is smaller than any sent event", "[Compare][Event]") {
+        std::shared_ptr<warped::Event> initial_event = std::make_shared<warped::InitialEvent>();
+        std::shared_ptr<warped::Event> e3 = warped::make_unique<test_Event>("receiver1", 0);
+        e3->generation_ = 1;
+        e3->stampKey();
+
+        CHECK(*initial_event < *e3);
+    }
+}
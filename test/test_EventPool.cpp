@@ -0,0 +1,129 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <malloc.h>  // for malloc_usable_size()
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "EventPool.hpp"
+#include "Event.hpp"
+#include "mocks.hpp"
+
+namespace {
+
+// Allocates a block from its destructor, which runs after the pool of the thread is closed
+// when the object was constructed before the thread first used the pool
+struct LateAllocator {
+    ~LateAllocator() { *block_ = warped::EventPool::allocate(size_); }
+
+    void** block_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // anonymous namespace
+
+TEST_CASE("Event pool operations") {
+
+    SECTION("Events can be created from the pool") {
+        std::shared_ptr<warped::Event> e = warped::makeEvent<test_Event>("a", 10);
+        REQUIRE(e != nullptr);
+        CHECK(e->receiverName() == "a");
+        CHECK(e->timestamp() == 10);
+
+        auto neg_event = warped::makeEvent<warped::NegativeEvent>(e);
+        CHECK(neg_event->receiverName() == "a");
+        CHECK(neg_event->timestamp() == 10);
+        CHECK(neg_event->event_type_ == warped::EventType::NEGATIVE);
+        CHECK(*neg_event == *e);
+    }
+
+    SECTION("Freed blocks are reused by the same thread") {
+        void* block = warped::EventPool::allocate(100);
+        warped::EventPool::deallocate(block, 100);
+
+        // Same size class
+        void* block2 = warped::EventPool::allocate(120);
+        CHECK(block2 == block);
+        warped::EventPool::deallocate(block2, 120);
+
+        // Different size class
+        void* block3 = warped::EventPool::allocate(200);
+        CHECK(block3 != block);
+        warped::EventPool::deallocate(block3, 200);
+    }
+
+    SECTION("Blocks too large for the pool are not reused") {
+        void* block = warped::EventPool::allocate(warped::EventPool::MAX_BLOCK_SIZE + 1);
+        REQUIRE(block != nullptr);
+        warped::EventPool::deallocate(block, warped::EventPool::MAX_BLOCK_SIZE + 1);
+    }
+
+    SECTION("Events can be freed by a different thread") {
+        std::shared_ptr<warped::Event> e = warped::makeEvent<test_Event>("b", 20);
+        std::thread t([&e]() { e.reset(); });
+        t.join();
+        CHECK(e == nullptr);
+
+        std::shared_ptr<warped::Event> e2 = warped::makeEvent<test_Event>("c", 30);
+        CHECK(e2->receiverName() == "c");
+    }
+
+    SECTION("Blocks freed by another thread go back to the allocating thread") {
+        const std::size_t size = 64;
+        const std::size_t num_blocks = 2 * warped::EventPool::MAX_FREE_BLOCKS;
+
+        std::vector<void*> blocks;
+        for (std::size_t i = 0; i < num_blocks; i++) {
+            blocks.push_back(warped::EventPool::allocate(size));
+        }
+
+        // The freeing thread keeps no more than its limit, the rest is shared
+        std::size_t num_kept = 0;
+        std::thread t([&]() {
+            for (auto block : blocks) {
+                warped::EventPool::deallocate(block, size);
+            }
+            num_kept = warped::EventPool::numFreeBlocks(size);
+        });
+        t.join();
+        CHECK(num_kept <= warped::EventPool::MAX_FREE_BLOCKS);
+
+        std::set<void*> freed(blocks.begin(), blocks.end());
+        std::size_t num_reused = 0;
+        std::vector<void*> new_blocks;
+        for (std::size_t i = 0; i < num_blocks; i++) {
+            new_blocks.push_back(warped::EventPool::allocate(size));
+            num_reused += freed.count(new_blocks.back());
+        }
+        CHECK(num_reused >= num_blocks - num_kept);
+
+        for (auto block : new_blocks) {
+            warped::EventPool::deallocate(block, size);
+        }
+        CHECK(warped::EventPool::numFreeBlocks(size) <= warped::EventPool::MAX_FREE_BLOCKS);
+    }
+
+    SECTION("Blocks allocated after the pool is closed have the full block size") {
+        const std::size_t size = 40;
+        const std::size_t block_size = 2 * warped::EventPool::GRANULARITY;
+        void* block = nullptr;
+
+        std::thread t([&]() {
+            thread_local LateAllocator late_allocator;
+            late_allocator.block_ = &block;
+            late_allocator.size_ = size;
+            warped::EventPool::deallocate(warped::EventPool::allocate(size), size);
+        });
+        t.join();
+        REQUIRE(block != nullptr);
+        CHECK(malloc_usable_size(block) >= block_size);
+
+        // Freed into this thread's pool, where it is reused for the largest size of its class
+        warped::EventPool::deallocate(block, size);
+        void* block2 = warped::EventPool::allocate(block_size);
+        CHECK(block2 == block);
+        warped::EventPool::deallocate(block2, block_size);
+    }
+}
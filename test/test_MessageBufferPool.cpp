@@ -0,0 +1,59 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <vector>
+
+#include "MessageBufferPool.hpp"
+
+TEST_CASE("Message buffer pool operations") {
+
+    warped::MessageBufferPool pool;
+    const std::size_t min_size = warped::MessageBufferPool::MIN_BUFFER_SIZE;
+
+    SECTION("Buffers are at least as large as requested") {
+        CHECK(pool.acquire(0).size() == min_size);
+        CHECK(pool.acquire(min_size).size() == min_size);
+        CHECK(pool.acquire(min_size + 1).size() == 2*min_size);
+        CHECK(pool.acquire(5*min_size).size() == 8*min_size);
+        CHECK(pool.numFree() == 0);
+    }
+
+    SECTION("Released buffers are reused for messages which fit") {
+        auto buffer = pool.acquire(3*min_size);
+        auto data = buffer.data();
+        pool.release(std::move(buffer));
+        CHECK(pool.numFree() == 1);
+
+        // Too large
+        CHECK(pool.acquire(5*min_size).data() != data);
+        CHECK(pool.numFree() == 1);
+
+        auto buffer2 = pool.acquire(4*min_size);
+        CHECK(buffer2.data() == data);
+        CHECK(buffer2.size() == 4*min_size);
+        CHECK(pool.numFree() == 0);
+    }
+
+    SECTION("Buffers not from the pool are kept with the size they can hold") {
+        pool.release(std::vector<uint8_t>(3*min_size));
+        CHECK(pool.numFree() == 1);
+
+        CHECK(pool.acquire(3*min_size).size() == 4*min_size);
+        CHECK(pool.numFree() == 1);
+
+        auto buffer = pool.acquire(2*min_size);
+        CHECK(buffer.size() == 3*min_size);
+        CHECK(pool.numFree() == 0);
+
+        // Too small to be pooled
+        pool.release(std::vector<uint8_t>(min_size - 1));
+        CHECK(pool.numFree() == 0);
+    }
+
+    SECTION("The number of free buffers of each size is bounded") {
+        for (std::size_t i = 0; i < warped::MessageBufferPool::MAX_FREE_BUFFERS + 1; i++) {
+            pool.release(std::vector<uint8_t>(min_size));
+        }
+        CHECK(pool.numFree() == warped::MessageBufferPool::MAX_FREE_BUFFERS);
+    }
+}
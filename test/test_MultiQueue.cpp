@@ -0,0 +1,112 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "MultiQueue.hpp"
+#include "Event.hpp"
+#include "mocks.hpp"
+
+namespace {
+
+std::shared_ptr<warped::Event> makeTestEvent(unsigned int receiver_id, unsigned int timestamp) {
+    auto e = std::make_shared<test_Event>("lp" + std::to_string(receiver_id), timestamp);
+    e->receiver_id_ = receiver_id;
+    return e;
+}
+
+} // anonymous namespace
+
+TEST_CASE("Multi-queue operations") {
+
+    warped::MultiQueue q(4);
+    REQUIRE(q.numSubqueues() == 4);
+    REQUIRE(q.dequeue() == nullptr);
+    REQUIRE(q.lowestTimestamp() == (unsigned int)-1);
+
+    SECTION("Insert, erase and dequeue") {
+        auto e1 = makeTestEvent(0, 10);
+        auto e2 = makeTestEvent(1, 5);
+        auto e3 = makeTestEvent(2, 7);
+        q.insert(e1);
+        q.insert(e2);
+        q.insert(e3);
+        CHECK(q.lowestTimestamp() == 5);
+
+        REQUIRE(q.erase(e2));
+        CHECK_FALSE(q.erase(e2));
+        CHECK(q.lowestTimestamp() == 7);
+
+        // Events come out in relaxed order, but none are lost
+        unsigned int count = 0;
+        while (auto e = q.dequeue()) {
+            CHECK((e == e1 || e == e3));
+            count++;
+        }
+        CHECK(count == 2);
+        CHECK(q.lowestTimestamp() == (unsigned int)-1);
+    }
+
+    SECTION("Events of one sub-queue are dequeued in order") {
+        warped::MultiQueue single(1);
+        single.insert(makeTestEvent(0, 3));
+        single.insert(makeTestEvent(0, 1));
+        single.insert(makeTestEvent(0, 2));
+        for (unsigned int ts = 1; ts <= 3; ts++) {
+            auto e = single.dequeue();
+            REQUIRE(e != nullptr);
+            CHECK(e->timestamp() == ts);
+        }
+        CHECK(single.dequeue() == nullptr);
+    }
+
+    SECTION("Positive events above the largest timestamp stay in the queue") {
+        auto e5 = makeTestEvent(0, 5);
+        auto e20 = makeTestEvent(1, 20);
+        q.insert(e5);
+        q.insert(e20);
+
+        unsigned int held_timestamp = (unsigned int)-1;
+        CHECK(q.dequeue(10, held_timestamp) == e5);
+        CHECK(q.dequeue(10, held_timestamp) == nullptr);
+        CHECK(held_timestamp == 20);
+
+        // Still there for erase and for a later dequeue
+        CHECK(q.lowestTimestamp() == 20);
+        REQUIRE(q.erase(e20));
+        q.insert(e20);
+        CHECK(q.dequeue(20, held_timestamp) == e20);
+    }
+}
+
+TEST_CASE("Multi-queue concurrent insert and dequeue") {
+
+    const unsigned int num_threads = 4;
+    const unsigned int events_per_thread = 1000;
+
+    warped::MultiQueue q(2*num_threads);
+    std::atomic<unsigned int> dequeued(0);
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            for (unsigned int i = 0; i < events_per_thread; i++) {
+                q.insert(makeTestEvent(t*events_per_thread + i, i));
+                if (q.dequeue() != nullptr) {
+                    dequeued++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    while (q.dequeue() != nullptr) {
+        dequeued++;
+    }
+    CHECK(dequeued.load() == num_threads*events_per_thread);
+}
@@ -0,0 +1,81 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <limits>
+
+#include "OptimismThrottle.hpp"
+
+TEST_CASE("Optimism throttle with a static window") {
+
+    SECTION("A window of 0 disables throttling") {
+        warped::OptimismThrottle throttle;
+        CHECK(!throttle.isEnabled());
+    }
+
+    warped::OptimismThrottle throttle(100);
+    throttle.initialize(2);
+    CHECK(throttle.isEnabled());
+    CHECK(!throttle.isAdaptive());
+
+    SECTION("Events more than the window above the GVT are held back") {
+        CHECK(throttle.maxTimestamp(0, 0) == 100);
+        CHECK(throttle.maxTimestamp(1, 50) == 150);
+    }
+
+    SECTION("The window does not overflow near the largest timestamp") {
+        const unsigned int max = std::numeric_limits<unsigned int>::max();
+        CHECK(throttle.maxTimestamp(0, max - 10) == max);
+    }
+
+    SECTION("A static window is not adapted") {
+        throttle.update(0, 10, 1000, 1000);
+        CHECK(throttle.window(0) == 100);
+    }
+}
+
+TEST_CASE("Optimism throttle with an adaptive window") {
+
+    warped::OptimismThrottle throttle(100, true, 20, 300);
+    throttle.initialize(2);
+    CHECK(throttle.isAdaptive());
+
+    SECTION("The window is halved while most events are rolled back") {
+        throttle.update(0, 10, 1000, 600);
+        CHECK(throttle.window(0) == 50);
+        throttle.update(0, 20, 2000, 1200);
+        CHECK(throttle.window(0) == 25);
+        throttle.update(0, 30, 3000, 1800);
+        CHECK(throttle.window(0) == 20);
+
+        // Each thread has its own window
+        CHECK(throttle.window(1) == 100);
+    }
+
+    SECTION("The window is doubled while few events are rolled back") {
+        throttle.update(1, 10, 1000, 50);
+        CHECK(throttle.window(1) == 200);
+        throttle.update(1, 20, 2000, 100);
+        CHECK(throttle.window(1) == 300);
+    }
+
+    SECTION("The window is kept in between") {
+        throttle.update(0, 10, 1000, 300);
+        CHECK(throttle.window(0) == 100);
+    }
+
+    SECTION("The window is only adapted on a new GVT") {
+        throttle.update(0, 0, 1000, 1000);
+        CHECK(throttle.window(0) == 100);
+        throttle.update(0, 10, 1000, 1000);
+        CHECK(throttle.window(0) == 50);
+        throttle.update(0, 10, 2000, 2000);
+        CHECK(throttle.window(0) == 50);
+    }
+
+    SECTION("Events are counted over several GVTs until there are enough of them") {
+        throttle.update(0, 10, 10, 10);
+        CHECK(throttle.window(0) == 100);
+        throttle.update(0, 20, 1000, 10);
+        CHECK(throttle.window(0) == 200);
+    }
+}
@@ -0,0 +1,81 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <memory>
+#include <vector>
+
+#include "PendingEventQueue.hpp"
+#include "Event.hpp"
+#include "mocks.hpp"
+
+TEST_CASE("Pending event queue operations") {
+
+    warped::PendingEventQueue q;
+    REQUIRE(q.empty());
+    REQUIRE(q.size() == 0);
+    REQUIRE(q.begin() == q.end());
+
+    SECTION("Events are kept in order") {
+        q.insert(std::make_shared<test_Event>("a", 10));
+        q.insert(std::make_shared<test_Event>("a", 30));
+        q.insert(std::make_shared<test_Event>("a", 20));
+        q.insert(std::make_shared<test_Event>("a", 5));
+        REQUIRE(q.size() == 4);
+
+        std::vector<unsigned int> timestamps;
+        for (auto it = q.begin(); it != q.end(); it++) {
+            timestamps.push_back((*it)->timestamp());
+        }
+        CHECK(timestamps == std::vector<unsigned int>({5, 10, 20, 30}));
+    }
+
+    SECTION("Erase the lowest event and reinsert below it") {
+        auto e1 = std::make_shared<test_Event>("a", 10);
+        auto e2 = std::make_shared<test_Event>("a", 20);
+        auto e3 = std::make_shared<test_Event>("a", 30);
+        q.insert(e1);
+        q.insert(e2);
+        q.insert(e3);
+
+        REQUIRE(q.erase(e1) == 1);
+        REQUIRE(q.erase(e1) == 0);
+        CHECK(*q.begin() == e2);
+        CHECK(q.size() == 2);
+
+        // Rollback puts events back in front of the head
+        q.insert(e1);
+        CHECK(*q.begin() == e1);
+        CHECK(q.size() == 3);
+
+        REQUIRE(q.erase(e2) == 1);
+        CHECK(*q.begin() == e1);
+        CHECK(*std::next(q.begin()) == e3);
+
+        REQUIRE(q.erase(e1) == 1);
+        REQUIRE(q.erase(e3) == 1);
+        CHECK(q.empty());
+    }
+
+    SECTION("Find the exact event and pair it with its anti-message") {
+        auto pos = std::make_shared<test_Event>("a", 10, true);
+        auto neg = std::make_shared<test_Event>("a", 10, false);
+        auto other = std::make_shared<test_Event>("a", 10, true);
+        q.insert(pos);
+        q.insert(other);
+        q.insert(neg);
+
+        auto neg_it = q.find(neg);
+        REQUIRE(neg_it != q.end());
+        CHECK(*neg_it == neg);
+        CHECK(q.find(other) != q.end());
+
+        auto pos_it = std::next(neg_it);
+        REQUIRE(pos_it != q.end());
+        CHECK(**pos_it == **neg_it);
+
+        q.erase(pos_it);
+        q.erase(neg_it);
+        CHECK(q.size() == 1);
+        CHECK(q.find(neg) == q.end());
+    }
+}
@@ -0,0 +1,77 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <memory>
+#include <vector>
+
+#include "ProcessedEventHistory.hpp"
+#include "PendingEventQueue.hpp"
+#include "Event.hpp"
+#include "mocks.hpp"
+
+TEST_CASE("Processed event history operations") {
+
+    warped::ProcessedEventHistory h;
+    REQUIRE(h.empty());
+    REQUIRE(h.lowerBound(10) == 0);
+
+    // Enough events to wrap around the ring buffer a few times
+    for (unsigned int ts = 1; ts <= 20; ts++) {
+        h.push_back(std::make_shared<test_Event>("a", ts));
+    }
+    REQUIRE(h.size() == 20);
+    REQUIRE(h.back()->timestamp() == 20);
+
+    SECTION("Binary search and ranges") {
+        test_Event e {"a", 7};
+        CHECK(h.lowerBound(e) == 6);
+        CHECK(h.lowerBound(7) == 6);
+        CHECK(h.lowerBound(100) == 20);
+
+        auto r = h.range(6, 9);
+        REQUIRE(r.size() == 3);
+        CHECK(r[0]->timestamp() == 7);
+        CHECK(r[2]->timestamp() == 9);
+        CHECK(h.range(20, 20).empty());
+    }
+
+    SECTION("Fossil collect from the front and add to the back") {
+        h.pop_front(15);
+        REQUIRE(h.size() == 5);
+        CHECK(h[0]->timestamp() == 16);
+
+        for (unsigned int ts = 21; ts <= 30; ts++) {
+            h.push_back(std::make_shared<test_Event>("a", ts));
+        }
+        REQUIRE(h.size() == 15);
+        for (unsigned int i = 0; i < h.size(); i++) {
+            CHECK(h[i]->timestamp() == 16 + i);
+        }
+
+        h.clear();
+        CHECK(h.empty());
+    }
+
+    SECTION("Truncate moves the rolled back events into the input queue") {
+        warped::PendingEventQueue q;
+        q.insert(std::make_shared<test_Event>("a", 12));
+        q.insert(std::make_shared<test_Event>("a", 25));
+
+        h.truncate(h.lowerBound(10), [&q](std::shared_ptr<warped::Event>&& event) {
+            q.append(std::move(event));
+        });
+        q.mergeAppended();
+
+        REQUIRE(h.size() == 9);
+        CHECK(h.back()->timestamp() == 9);
+
+        REQUIRE(q.size() == 13);
+        unsigned int last = 0;
+        for (auto it = q.begin(); it != q.end(); it++) {
+            CHECK((*it)->timestamp() >= last);
+            last = (*it)->timestamp();
+        }
+        CHECK((*q.begin())->timestamp() == 10);
+        CHECK(last == 25);
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <list>
 #include <random>
+#include <vector>
 
 #include "RandomNumberGenerator.hpp"
 #include "utility/memory.hpp"
@@ -131,3 +132,60 @@ TEST_CASE("Save and restore random number generator states") {
 }
 
 
+
+namespace {
+
+// A generator that is not trivially copyable, saved through its text state
+struct text_rng {
+    unsigned int operator()() { return values->at(next++ % values->size()); }
+
+    std::shared_ptr<std::vector<unsigned int>> values =
+        std::make_shared<std::vector<unsigned int>>(std::vector<unsigned int>{3, 1, 4, 1, 5});
+    unsigned int next = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const text_rng& rng) { return os << rng.next; }
+std::istream& operator>>(std::istream& is, text_rng& rng) { return is >> rng.next; }
+
+} // anonymous namespace
+
+TEST_CASE("Save and restore binary random number generator snapshots") {
+    std::list<std::shared_ptr<warped::RandomNumberGenerator>> rng_list;
+
+    auto model_rng1 = std::make_shared<std::minstd_rand0>();
+    auto model_rng2 = std::make_shared<std::mt19937>();
+    auto model_rng3 = std::make_shared<text_rng>();
+    rng_list.push_back(std::make_shared<warped::RNGDerived<std::minstd_rand0>>(model_rng1));
+    rng_list.push_back(std::make_shared<warped::RNGDerived<std::mt19937>>(model_rng2));
+    rng_list.push_back(std::make_shared<warped::RNGDerived<text_rng>>(model_rng3));
+
+    (*model_rng1)();
+    (*model_rng2)();
+    (*model_rng3)();
+
+    std::vector<unsigned char> snapshot;
+    for (auto& rng : rng_list) {
+        rng->saveSnapshot(snapshot);
+    }
+
+    // Standard engines are saved as a fixed size copy
+    CHECK(snapshot.size() ==
+        sizeof(std::minstd_rand0) + sizeof(std::mt19937) + sizeof(std::size_t) + 1);
+
+    auto num1 = (*model_rng1)();
+    auto num2 = (*model_rng2)();
+    auto num3 = (*model_rng3)();
+
+    // A snapshot can be restored more than once
+    for (unsigned int i = 0; i < 2; i++) {
+        const unsigned char *position = snapshot.data();
+        for (auto& rng : rng_list) {
+            rng->restoreSnapshot(position);
+        }
+        CHECK(position == snapshot.data() + snapshot.size());
+
+        CHECK((*model_rng1)() == num1);
+        CHECK((*model_rng2)() == num2);
+        CHECK((*model_rng3)() == num3);
+    }
+}
@@ -0,0 +1,66 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <memory>
+#include <thread>
+
+#include "SPSCQueue.hpp"
+
+TEST_CASE("Single producer single consumer queue operations") {
+
+    warped::SPSCQueue<std::unique_ptr<int>> queue;
+
+    SECTION("An empty queue has no front") {
+        std::unique_ptr<int> value;
+        CHECK(queue.front() == nullptr);
+        CHECK_FALSE(queue.pop(value));
+    }
+
+    SECTION("Elements are taken in the order they were pushed") {
+        const int num_elements = 3*warped::SPSCQueue<std::unique_ptr<int>>::BLOCK_SIZE + 7;
+        for (int i = 0; i < num_elements; i++) {
+            queue.push(std::unique_ptr<int>(new int(i)));
+        }
+
+        REQUIRE(queue.front() != nullptr);
+        CHECK(**queue.front() == 0);
+
+        for (int i = 0; i < num_elements; i++) {
+            std::unique_ptr<int> value;
+            REQUIRE(queue.pop(value));
+            CHECK(*value == i);
+        }
+        CHECK(queue.front() == nullptr);
+
+        // The queue can be reused once drained
+        queue.push(std::unique_ptr<int>(new int(42)));
+        REQUIRE(queue.front() != nullptr);
+        CHECK(**queue.front() == 42);
+        queue.pop();
+        CHECK(queue.front() == nullptr);
+    }
+
+    SECTION("Elements are passed between threads in order") {
+        const int num_elements = 100000;
+
+        std::thread producer([&queue]() {
+            for (int i = 0; i < num_elements; i++) {
+                queue.push(std::unique_ptr<int>(new int(i)));
+            }
+        });
+
+        int expected = 0;
+        bool in_order = true;
+        while (expected < num_elements) {
+            std::unique_ptr<int> value;
+            if (queue.pop(value)) {
+                in_order = in_order && (*value == expected);
+                expected++;
+            }
+        }
+        producer.join();
+
+        CHECK(in_order);
+        CHECK(queue.front() == nullptr);
+    }
+}
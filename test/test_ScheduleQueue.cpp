@@ -0,0 +1,88 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <memory>
+#include <vector>
+
+#include "ScheduleQueue.hpp"
+#include "Event.hpp"
+#include "mocks.hpp"
+
+TEST_CASE("Schedule queue type is parsed from the configuration string") {
+
+    warped::ScheduleQueueType type = warped::ScheduleQueueType::MultiSet;
+
+    REQUIRE(warped::scheduleQueueTypeFromString("ladder-queue", type));
+    CHECK(type == warped::ScheduleQueueType::LadderQueue);
+    REQUIRE(warped::scheduleQueueTypeFromString("partially-sorted-ladder-queue", type));
+    CHECK(type == warped::ScheduleQueueType::PartiallySortedLadderQueue);
+    REQUIRE(warped::scheduleQueueTypeFromString("splay-tree", type));
+    CHECK(type == warped::ScheduleQueueType::SplayTree);
+    REQUIRE(warped::scheduleQueueTypeFromString("circular-queue", type));
+    CHECK(type == warped::ScheduleQueueType::CircularQueue);
+    REQUIRE(warped::scheduleQueueTypeFromString("multi-queue", type));
+    CHECK(type == warped::ScheduleQueueType::MultiQueue);
+    REQUIRE(warped::scheduleQueueTypeFromString("multiset", type));
+    CHECK(type == warped::ScheduleQueueType::MultiSet);
+
+    CHECK_FALSE(warped::scheduleQueueTypeFromString("heap", type));
+    CHECK(type == warped::ScheduleQueueType::MultiSet);
+}
+
+TEST_CASE("All schedule queue types return the lowest event") {
+
+    std::vector<warped::ScheduleQueueType> types = {
+        warped::ScheduleQueueType::MultiSet,
+        warped::ScheduleQueueType::LadderQueue,
+        warped::ScheduleQueueType::SplayTree,
+        warped::ScheduleQueueType::CircularQueue
+    };
+
+    for (auto type : types) {
+        warped::ScheduleQueue q(type, 4);
+        CHECK(q.type() == type);
+        CHECK_FALSE(q.isPartiallySorted());
+        REQUIRE(q.pop() == nullptr);
+
+        auto e1 = std::make_shared<test_Event>("a", 20);
+        auto e2 = std::make_shared<test_Event>("b", 5);
+        auto e3 = std::make_shared<test_Event>("c", 12);
+        auto e4 = std::make_shared<test_Event>("d", 30);
+        q.insert(e1);
+        q.insert(e2);
+        q.insert(e3);
+        q.insert(e4);
+
+        REQUIRE(q.erase(e3));
+
+        auto e = q.pop();
+        REQUIRE(e != nullptr);
+        CHECK(e->timestamp() == 5);
+        e = q.pop();
+        REQUIRE(e != nullptr);
+        CHECK(e->timestamp() == 20);
+        e = q.pop();
+        REQUIRE(e != nullptr);
+        CHECK(e->timestamp() == 30);
+        CHECK(q.pop() == nullptr);
+    }
+}
+
+TEST_CASE("Partially sorted ladder queue reports a lower bound") {
+
+    warped::ScheduleQueue q(warped::ScheduleQueueType::PartiallySortedLadderQueue, 3);
+    REQUIRE(q.isPartiallySorted());
+
+    q.insert(std::make_shared<test_Event>("a", 7));
+    q.insert(std::make_shared<test_Event>("b", 3));
+    q.insert(std::make_shared<test_Event>("c", 9));
+
+    unsigned int count = 0;
+    unsigned int lowest = q.lowestTimestamp();
+    CHECK(lowest <= 3);
+    while (auto e = q.pop()) {
+        CHECK(e->timestamp() >= lowest);
+        count++;
+    }
+    CHECK(count == 3);
+}
@@ -0,0 +1,69 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <vector>
+
+#include "ThreadAffinity.hpp"
+
+TEST_CASE("Thread affinity policy is parsed from the configuration string") {
+
+    warped::ThreadAffinityPolicy policy = warped::ThreadAffinityPolicy::None;
+
+    REQUIRE(warped::threadAffinityPolicyFromString("core", policy));
+    CHECK(policy == warped::ThreadAffinityPolicy::Core);
+    REQUIRE(warped::threadAffinityPolicyFromString("numa-node", policy));
+    CHECK(policy == warped::ThreadAffinityPolicy::NumaNode);
+    REQUIRE(warped::threadAffinityPolicyFromString("none", policy));
+    CHECK(policy == warped::ThreadAffinityPolicy::None);
+
+    CHECK_FALSE(warped::threadAffinityPolicyFromString("socket", policy));
+    CHECK(policy == warped::ThreadAffinityPolicy::None);
+}
+
+TEST_CASE("Worker threads are placed on the node of their schedule queue") {
+
+    // Two nodes with interleaved core numbers, as on many 2-socket machines
+    std::vector<std::vector<unsigned int>> nodes = {{0, 2, 4, 6}, {1, 3, 5, 7}};
+
+    // Six worker threads sharing two schedule queues
+    std::vector<unsigned int> scheduler_map = {0, 1, 0, 1, 0, 1};
+
+    SECTION("One core per thread") {
+        warped::ThreadAffinity affinity(warped::ThreadAffinityPolicy::Core);
+        REQUIRE(affinity.isEnabled());
+        affinity.initialize(scheduler_map, nodes);
+        REQUIRE(affinity.numNumaNodes() == 2);
+
+        std::vector<unsigned int> expected = {0, 1, 2, 3, 4, 5};
+        for (unsigned int thread_id = 0; thread_id < scheduler_map.size(); thread_id++) {
+            CHECK(affinity.numaNode(thread_id) == scheduler_map[thread_id]);
+            REQUIRE(affinity.cores(thread_id).size() == 1);
+            CHECK(affinity.cores(thread_id)[0] == expected[thread_id]);
+        }
+    }
+
+    SECTION("All cores of the node") {
+        warped::ThreadAffinity affinity(warped::ThreadAffinityPolicy::NumaNode);
+        affinity.initialize(scheduler_map, nodes);
+
+        for (unsigned int thread_id = 0; thread_id < scheduler_map.size(); thread_id++) {
+            CHECK(affinity.cores(thread_id) == nodes[scheduler_map[thread_id]]);
+        }
+    }
+
+    SECTION("More threads than cores wrap around") {
+        warped::ThreadAffinity affinity(warped::ThreadAffinityPolicy::Core);
+        affinity.initialize({0, 0, 0}, {{8, 9}});
+        CHECK(affinity.cores(0)[0] == 8);
+        CHECK(affinity.cores(1)[0] == 9);
+        CHECK(affinity.cores(2)[0] == 8);
+    }
+}
+
+TEST_CASE("Pinning is skipped without a policy") {
+
+    warped::ThreadAffinity affinity;
+    CHECK_FALSE(affinity.isEnabled());
+    affinity.initialize({0, 0});
+    CHECK_FALSE(affinity.pinThread(0));
+}
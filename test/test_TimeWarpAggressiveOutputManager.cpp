@@ -40,6 +40,7 @@ TEST_CASE("Aggressive output manager is aggressive", "[output][queues]") {
 
         SECTION("Correct events are removed on rollback", "[output][queue][rollback]") {
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 39;
+            e->stampKey();
             auto events_to_cancel = om.rollback(e, 2);
             CHECK(om.size(2) == 5);
             REQUIRE(events_to_cancel->size() == 2);
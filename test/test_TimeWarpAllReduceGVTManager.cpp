@@ -0,0 +1,164 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <memory>
+
+#include "TimeWarpAllReduceGVTManager.hpp"
+#include "TimeWarpCommunicationManager.hpp"
+#include "mocks.hpp"
+
+// Keeps the values of a reduction, which completes with the results set by the test
+class TestCommunicationManager : public warped::TimeWarpCommunicationManager {
+public:
+    TestCommunicationManager(unsigned int num_processes) : num_processes_(num_processes) {}
+
+    unsigned int initialize() override { return num_processes_; }
+    void finalize() override {}
+    unsigned int getNumProcesses() override { return num_processes_; }
+    unsigned int getID() override { return 0; }
+    int waitForAllProcesses() override { return 0; }
+    int sumReduceUint64(uint64_t*, uint64_t*) override { return 0; }
+    int gatherUint64(uint64_t*, uint64_t*) override { return 0; }
+    int sumAllReduceInt64(int64_t*, int64_t*) override { return 0; }
+    int minAllReduceUint(unsigned int*, unsigned int*) override { return 0; }
+    void startAllReduce(unsigned int* send_min, unsigned int* recv_min,
+                        int64_t* send_sum, int64_t* recv_sum) override {
+        num_reductions_++;
+        sent_min_ = *send_min;
+        sent_sum_ = *send_sum;
+        recv_min_ = recv_min;
+        recv_sum_ = recv_sum;
+        is_complete_ = false;
+    }
+    bool testAllReduce() override {
+        if (is_complete_) {
+            *recv_min_ = reduced_min_;
+            *recv_sum_ = reduced_sum_;
+        }
+        return is_complete_;
+    }
+    void insertMessage(std::unique_ptr<warped::TimeWarpKernelMessage>) override {}
+    void handleMessages() override {}
+    void flushMessages() override {}
+    void startMessageThread(std::function<void()>) override {}
+    void stopMessageThread() override {}
+    void reportStraggler(unsigned int) override {}
+    uint64_t numAggregatesSent() override { return 0; }
+    uint64_t numAggregatedMessages() override { return 0; }
+
+    // Completes the pending reduction with the values of all nodes
+    void completeReduction(unsigned int reduced_min, int64_t reduced_sum) {
+        reduced_min_ = reduced_min;
+        reduced_sum_ = reduced_sum;
+        is_complete_ = true;
+    }
+
+    unsigned int num_reductions_ = 0;
+    unsigned int sent_min_ = 0;
+    int64_t sent_sum_ = 0;
+
+private:
+    unsigned int num_processes_;
+    unsigned int* recv_min_ = nullptr;
+    int64_t* recv_sum_ = nullptr;
+    unsigned int reduced_min_ = 0;
+    int64_t reduced_sum_ = 0;
+    bool is_complete_ = false;
+};
+
+class TestGVTManager : public warped::TimeWarpAllReduceGVTManager {
+public:
+    TestGVTManager(std::shared_ptr<warped::TimeWarpCommunicationManager> comm_manager,
+                   unsigned int num_worker_threads) :
+        warped::TimeWarpAllReduceGVTManager(comm_manager, 0, num_worker_threads) {}
+
+    using warped::TimeWarpAllReduceGVTManager::round_msg_count_;
+
+    warped::GVTState state() { return gvt_state_; }
+    warped::Color color() { return color_.load(); }
+    warped::Color initialColor() { return initial_color_.load(); }
+};
+
+TEST_CASE("A round of the all-reduce GVT takes steps until no messages are in transit") {
+
+    auto comm_manager = std::make_shared<TestCommunicationManager>(2);
+    TestGVTManager gvt_manager(comm_manager, 1);
+    gvt_manager.initialize();
+
+    // Two messages sent before the cut, which other nodes have not received yet
+    auto e10 = std::make_shared<test_Event>("a", 10);
+    CHECK(gvt_manager.sendEventUpdate(e10, 0) == warped::Color::WHITE);
+    CHECK(gvt_manager.sendEventUpdate(e10, 0) == warped::Color::WHITE);
+
+    // The cut
+    gvt_manager.checkProgressGVT();
+    CHECK(gvt_manager.state() == warped::GVTState::LOCAL);
+    CHECK(gvt_manager.color() == warped::Color::RED);
+    CHECK(gvt_manager.round_msg_count_ == 0);
+
+    // A message sent after the cut counts towards the minimum of the step
+    auto e7 = std::make_shared<test_Event>("a", 7);
+    CHECK(gvt_manager.sendEventUpdate(e7, 0) == warped::Color::RED);
+
+    gvt_manager.reportThreadMin(20, 0, gvt_manager.getLocalGVTFlag());
+    gvt_manager.checkProgressGVT();
+    REQUIRE(comm_manager->num_reductions_ == 1);
+    CHECK(comm_manager->sent_min_ == 7);
+    CHECK(comm_manager->sent_sum_ == 2);
+    CHECK(gvt_manager.state() == warped::GVTState::GLOBAL);
+
+    // Nothing happens while the reduction is pending
+    gvt_manager.checkProgressGVT();
+    CHECK(gvt_manager.state() == warped::GVTState::GLOBAL);
+    CHECK(comm_manager->num_reductions_ == 1);
+
+    // One of the messages was received by another node, the other one is still in transit
+    comm_manager->completeReduction(5, 1);
+    gvt_manager.checkProgressGVT();
+    CHECK(gvt_manager.round_msg_count_ == 1);
+    CHECK(gvt_manager.state() == warped::GVTState::LOCAL);
+    CHECK_FALSE(gvt_manager.gvtUpdated());
+
+    SECTION("The round ends once the sum of the counts is zero") {
+        // A message of the initial color received in the second step
+        auto e4 = std::make_shared<test_Event>("b", 4);
+        gvt_manager.receiveEventUpdate(e4, warped::Color::WHITE);
+
+        // The next step does not cut again
+        gvt_manager.checkProgressGVT();
+        CHECK(gvt_manager.color() == warped::Color::RED);
+        gvt_manager.reportThreadMin(30, 0, gvt_manager.getLocalGVTFlag());
+        gvt_manager.checkProgressGVT();
+        REQUIRE(comm_manager->num_reductions_ == 2);
+        CHECK(comm_manager->sent_min_ == 4);
+        CHECK(comm_manager->sent_sum_ == -1);
+
+        comm_manager->completeReduction(4, -1);
+        gvt_manager.checkProgressGVT();
+        CHECK(gvt_manager.round_msg_count_ == 0);
+        CHECK(gvt_manager.state() == warped::GVTState::IDLE);
+        CHECK(gvt_manager.gvtUpdated());
+        CHECK(gvt_manager.getGVT() == 4);
+        CHECK(gvt_manager.initialColor() == warped::Color::RED);
+
+        // The next round starts with a new cut and a new sum
+        gvt_manager.checkProgressGVT();
+        CHECK(gvt_manager.color() == warped::Color::WHITE);
+        CHECK(gvt_manager.round_msg_count_ == 0);
+    }
+
+    SECTION("A step with messages still in transit does not end the round") {
+        gvt_manager.checkProgressGVT();
+        gvt_manager.reportThreadMin(30, 0, gvt_manager.getLocalGVTFlag());
+        gvt_manager.checkProgressGVT();
+        REQUIRE(comm_manager->num_reductions_ == 2);
+        CHECK(comm_manager->sent_sum_ == 0);
+
+        comm_manager->completeReduction(3, 0);
+        gvt_manager.checkProgressGVT();
+        CHECK(gvt_manager.round_msg_count_ == 1);
+        CHECK(gvt_manager.state() == warped::GVTState::LOCAL);
+        CHECK_FALSE(gvt_manager.gvtUpdated());
+        CHECK(gvt_manager.getGVT() == 0);
+    }
+}
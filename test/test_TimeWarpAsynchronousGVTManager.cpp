@@ -11,7 +11,7 @@
 TEST_CASE("Mattern GVT messages can be serialized", "[serialization][mattern][message]") {
     std::stringstream ss;
     std::unique_ptr<warped::MatternGVTToken> msg = warped::make_unique<warped::MatternGVTToken>
-        (2, 3, 1, 5, 10);
+        (2, 3, 1, 5, 10, true);
 
     std::unique_ptr<warped::MatternGVTToken> msg2;
 
@@ -32,11 +32,12 @@ TEST_CASE("Mattern GVT messages can be serialized", "[serialization][mattern][me
     REQUIRE(m->m_clock == 1);
     REQUIRE(m->m_send == 5);
     REQUIRE(m->count == 10);
+    REQUIRE(m->pressure);
 }
 
 TEST_CASE("Returns correct type", "[mattern][message][type]") {
     std::unique_ptr<warped::MatternGVTToken> msg = warped::make_unique<warped::MatternGVTToken>
-        (2, 3, 1, 5, 10);
+        (2, 3, 1, 5, 10, true);
 
     REQUIRE(msg->get_type() == warped::MessageType::MatternGVTToken);
 }
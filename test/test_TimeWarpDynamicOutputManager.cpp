@@ -0,0 +1,104 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include "TimeWarpDynamicOutputManager.hpp"
+#include "mocks.hpp"
+#include "utility/memory.hpp"
+
+namespace {
+
+// Sends one event for each input event, rolls back to the first one and processes the input
+// events again, sending the same events if regenerate is true
+std::size_t rollbackAndReprocess(warped::TimeWarpDynamicOutputManager& om, unsigned int first,
+    unsigned int num_inputs, bool regenerate) {
+
+    std::vector<std::shared_ptr<warped::Event>> inputs;
+    for (unsigned int i = 0; i < num_inputs; i++) {
+        inputs.push_back(std::make_shared<test_Event>("receiver_name", first + i));
+        om.insertEvent(inputs.back(), std::make_shared<test_Event>("receiver_name", first + i + 5), 1);
+    }
+
+    auto events_to_cancel = om.rollback(inputs.front(), 1);
+
+    for (auto& input: inputs) {
+        auto name = regenerate ? "receiver_name" : "other_name";
+        std::shared_ptr<warped::Event> e = std::make_shared<test_Event>(name, input->timestamp() + 5);
+        if (!om.isRegenerated(input, e, 1)) {
+            om.insertEvent(input, e, 1);
+        }
+        om.eventsNotRegenerated(input, 1);
+    }
+
+    return events_to_cancel->size();
+}
+
+} // anonymous namespace
+
+TEST_CASE("Dynamic output manager switches cancellation per lp", "[output][queues][dynamic]") {
+    unsigned int num_objects = 4;
+    warped::TimeWarpDynamicOutputManager om;
+    om.initialize(num_objects);
+
+    auto window = warped::TimeWarpDynamicOutputManager::HIT_RATIO_WINDOW;
+
+    for (unsigned int i = 0; i < num_objects; i++) {
+        CHECK_FALSE(om.isLazy(i));
+        CHECK(om.hitRatio(i) == 0.0);
+    }
+
+    SECTION("Aggressive mode cancels right away and measures the hit ratio", "[output][dynamic]") {
+        CHECK(rollbackAndReprocess(om, 10, window / 2, true) == window / 2);
+        CHECK(om.size(1) == window / 2);
+        CHECK(om.hitRatio(1) == 1.0);
+        CHECK(om.numComparedEvents(1) == window / 2);
+        CHECK(om.numRegeneratedEvents(1) == window / 2);
+        CHECK_FALSE(om.isLazy(1));
+
+        SECTION("Regenerated events switch the lp to lazy", "[output][dynamic]") {
+            rollbackAndReprocess(om, 100, window / 2, true);
+            CHECK(om.isLazy(1));
+            CHECK(om.numModeSwitches(1) == 1);
+            CHECK_FALSE(om.isLazy(0));
+
+            // Nothing is cancelled on rollback now
+            CHECK(rollbackAndReprocess(om, 200, window, false) == 0);
+
+            SECTION("Events that are not regenerated switch the lp back", "[output][dynamic]") {
+                CHECK_FALSE(om.isLazy(1));
+                CHECK(om.numModeSwitches(1) == 2);
+                CHECK(om.hitRatio(1) == Approx(0.5));
+                CHECK(om.numComparedEvents(1) == 2 * window);
+                CHECK(om.heldSize(1) == 0);
+            }
+        }
+    }
+
+    SECTION("Events of cancelled input events do not change the hit ratio", "[output][dynamic]") {
+        std::vector<std::shared_ptr<warped::Event>> inputs;
+        for (unsigned int i = 0; i < window; i++) {
+            inputs.push_back(std::make_shared<test_Event>("receiver_name", 10 + i));
+            om.insertEvent(inputs.back(), std::make_shared<test_Event>("receiver_name", 15 + i), 1);
+        }
+        CHECK(om.rollback(inputs.front(), 1)->size() == window);
+
+        // Only the first input event is processed again, the others are cancelled
+        std::shared_ptr<warped::Event> e = std::make_shared<test_Event>("receiver_name", 15);
+        CHECK_FALSE(om.isRegenerated(inputs.front(), e, 1));
+        om.insertEvent(inputs.front(), e, 1);
+        CHECK(om.eventsNotRegenerated(inputs.front(), 1) == nullptr);
+        for (unsigned int i = 1; i < window; i++) {
+            CHECK(om.eventsSentByCancelledEvent(inputs[i], 1) == nullptr);
+        }
+
+        CHECK(om.numComparedEvents(1) == 1);
+        CHECK(om.hitRatio(1) == 1.0);
+        CHECK_FALSE(om.isLazy(1));
+    }
+
+    SECTION("Events that are not regenerated keep the lp aggressive", "[output][dynamic]") {
+        CHECK(rollbackAndReprocess(om, 10, window, false) == window);
+        CHECK_FALSE(om.isLazy(1));
+        CHECK(om.numModeSwitches(1) == 0);
+        CHECK(om.hitRatio(1) == 0.0);
+    }
+}
@@ -0,0 +1,169 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Event.hpp"
+#include "EventPool.hpp"
+#include "LogicalProcess.hpp"
+#include "LPState.hpp"
+#include "Simulation.hpp"
+#include "serialization.hpp"
+
+// A PHOLD model in which the events an lp sends depend on its state. An lp which processes its
+// events again after a rollback can therefore send different events, which lazy cancellation
+// must cancel. The state only depends on events at earlier timestamps, so the results do not
+// depend on how events with the same timestamp are ordered.
+
+namespace {
+
+const unsigned int NUM_LPS = 32;
+const unsigned int NUM_INITIAL_EVENTS = 3;
+const unsigned int MAX_SIM_TIME = 1000;
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+std::string lpName(unsigned int index) {
+    return "lp" + std::to_string(index);
+}
+
+struct ModelState {
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+
+    // Sum before the first event at cur_ts_
+    uint64_t before_ = 0;
+    unsigned int cur_ts_ = 0;
+
+    // Returns the seed and receiver of the event sent for an event with the given seed
+    std::pair<uint64_t, unsigned int> receive(unsigned int index, unsigned int ts,
+                                              uint64_t seed) {
+        if (ts != cur_ts_) {
+            before_ = sum_;
+            cur_ts_ = ts;
+        }
+        count_++;
+        sum_ += mix(seed ^ ts);
+
+        uint64_t new_seed = mix(seed + index + before_);
+        return {new_seed, ts + 1 + (unsigned int)((new_seed >> 20) % 10)};
+    }
+};
+
+class ModelEvent : public warped::Event {
+public:
+    ModelEvent() = default;
+    ModelEvent(const std::string& receiver_name, unsigned int timestamp, uint64_t seed)
+        : receiver_name_(receiver_name), timestamp_(timestamp), seed_(seed) {}
+
+    const std::string& receiverName() const { return receiver_name_; }
+    unsigned int timestamp() const { return timestamp_; }
+    unsigned int size() const { return receiver_name_.size() + sizeof(timestamp_); }
+
+    std::string receiver_name_;
+    unsigned int timestamp_;
+    uint64_t seed_;
+
+    WARPED_REGISTER_SERIALIZABLE_MEMBERS(cereal::base_class<warped::Event>(this),
+                                         receiver_name_, timestamp_, seed_)
+};
+
+WARPED_DEFINE_LP_STATE_STRUCT(ModelLPState) {
+    ModelState model_;
+};
+
+class ModelLP : public warped::LogicalProcess {
+public:
+    ModelLP(unsigned int index) : warped::LogicalProcess(lpName(index)), index_(index) {}
+
+    warped::LPState& getState() { return state_; }
+
+    std::vector<std::shared_ptr<warped::Event>> initializeLP() {
+        std::vector<std::shared_ptr<warped::Event>> events;
+        for (unsigned int i = 0; i < NUM_INITIAL_EVENTS; i++) {
+            events.push_back(warped::makeEvent<ModelEvent>(name_, 1 + i,
+                                                           mix(index_ * 7 + i + 1)));
+        }
+        return events;
+    }
+
+    std::vector<std::shared_ptr<warped::Event>> receiveEvent(const warped::Event& event) {
+        auto& model_event = static_cast<const ModelEvent&>(event);
+        auto sent = state_.model_.receive(index_, model_event.timestamp_, model_event.seed_);
+
+        std::vector<std::shared_ptr<warped::Event>> events;
+        events.push_back(warped::makeEvent<ModelEvent>(lpName(sent.first % NUM_LPS),
+                                                       sent.second, sent.first));
+        return events;
+    }
+
+    ModelLPState state_;
+    const unsigned int index_;
+};
+
+} // anonymous namespace
+
+WARPED_REGISTER_POLYMORPHIC_SERIALIZABLE_CLASS(ModelEvent)
+
+TEST_CASE("Lazy cancellation gives the sequential results when anti-messages annihilate") {
+
+    // Events of each timestamp in any order, with the same rules as the model
+    std::vector<ModelState> expected(NUM_LPS);
+    std::multimap<unsigned int, std::pair<unsigned int, uint64_t>> pending;
+    for (unsigned int index = 0; index < NUM_LPS; index++) {
+        for (unsigned int i = 0; i < NUM_INITIAL_EVENTS; i++) {
+            pending.emplace(1 + i, std::make_pair(index, mix(index * 7 + i + 1)));
+        }
+    }
+    while (!pending.empty() && (pending.begin()->first <= MAX_SIM_TIME)) {
+        auto ts = pending.begin()->first;
+        auto index = pending.begin()->second.first;
+        auto seed = pending.begin()->second.second;
+        pending.erase(pending.begin());
+
+        auto sent = expected[index].receive(index, ts, seed);
+        pending.emplace(sent.second, std::make_pair(sent.first % NUM_LPS, sent.first));
+    }
+
+    // Several worker threads on one node roll back often enough for anti-messages to reach
+    // rolled back events before the lp processes them again
+    const char* config_file_name = "test_lazy_cancellation.json";
+    {
+        std::ofstream config_file(config_file_name, std::ios_base::trunc);
+        config_file << "{\"max-sim-time\": " << MAX_SIM_TIME << ", \"time-warp\": "
+                    << "{\"worker-threads\": 4, \"cancellation\": \"lazy\"}}";
+    }
+
+    std::vector<ModelLP> lps;
+    std::vector<warped::LogicalProcess*> lp_pointers;
+    lps.reserve(NUM_LPS);
+    for (unsigned int index = 0; index < NUM_LPS; index++) {
+        lps.emplace_back(index);
+    }
+    for (auto& lp : lps) {
+        lp_pointers.push_back(&lp);
+    }
+
+    const char* argv[] = {"test_TimeWarpEventDispatcher", "--config", config_file_name};
+    warped::Simulation simulation("Lazy cancellation test", 3, argv);
+    simulation.simulate(lp_pointers);
+
+    for (unsigned int index = 0; index < NUM_LPS; index++) {
+        INFO("lp " << index);
+        CHECK(lps[index].state_.model_.count_ == expected[index].count_);
+        CHECK(lps[index].state_.model_.sum_ == expected[index].sum_);
+    }
+}
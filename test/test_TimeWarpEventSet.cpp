@@ -1,6 +1,7 @@
 #define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
 #include "catch.hpp"
 
+#include <limits>
 #include <memory>
 #include <sstream>
 
@@ -41,13 +42,9 @@ TEST_CASE("Test the event set operations") {
         twes.insertEvent(0, std::shared_ptr<warped::Event>(new test_Event {"a", 16}));
         twes.insertEvent(0, std::shared_ptr<warped::Event>(new test_Event {"a", 10}));
         twes.insertEvent(0, std::shared_ptr<warped::Event>(new test_Event {"a", 15}));
-        twes.insertEvent(0, std::shared_ptr<warped::Event>(new test_Event {"a", 10, false}));
-        spe = twes.getEvent(0);
-        CHECK(spe != nullptr);
-        CHECK(spe->timestamp() == 10);
-        CHECK(spe->event_type_ == warped::EventType::NEGATIVE);
-        twes.cancelEvent(0, spe);
-        twes.startScheduling(0);
+        // The positive event is still unprocessed, so the anti-message cancels it right away
+        CHECK(twes.insertEvent(0, std::shared_ptr<warped::Event>(new test_Event {"a", 10, false}))
+            == warped::InsertStatus::Annihilated);
 
         spe = twes.lastProcessedEvent(0);
         CHECK(spe != nullptr);
@@ -73,8 +70,8 @@ TEST_CASE("Test the event set operations") {
 
         twes.rollback(0, spe);
         auto list_obj = twes.getEventsForCoastForward(0, spe, restored_event);
-        CHECK(list_obj->size() == 1);
-        CHECK((*list_obj)[0]->timestamp() == 6);
+        CHECK(list_obj.size() == 1);
+        CHECK(list_obj[0]->timestamp() == 6);
         twes.startScheduling(0);
 
         spe = twes.getEvent(0);
@@ -88,4 +85,146 @@ TEST_CASE("Test the event set operations") {
         CHECK(spe->timestamp() == 15);
         CHECK(spe->event_type_ == warped::EventType::POSITIVE);
     }
+
+    SECTION("Anti-messages annihilate unprocessed events on insert") {
+
+        std::shared_ptr<warped::Event> e5 = std::make_shared<test_Event>("a", 5);
+        std::shared_ptr<warped::Event> e7 = std::make_shared<test_Event>("a", 7);
+        std::shared_ptr<warped::Event> e9 = std::make_shared<test_Event>("a", 9);
+        twes.insertEvent(0, e5);
+        twes.insertEvent(0, e7);
+        twes.insertEvent(0, e9);
+
+        // Not scheduled
+        CHECK(twes.insertEvent(0, std::make_shared<test_Event>("a", 7, false)) ==
+            warped::InsertStatus::Annihilated);
+
+        // Scheduled but not taken by a worker thread yet, the next event is scheduled instead
+        CHECK(twes.insertEvent(0, std::make_shared<test_Event>("a", 5, false)) ==
+            warped::InsertStatus::Annihilated);
+
+        spe = twes.getEvent(0);
+        CHECK(spe == e9);
+
+        // Already taken, so the anti-message is inserted and causes a rollback later
+        CHECK(twes.insertEvent(0, std::make_shared<test_Event>("a", 9, false)) ==
+            warped::InsertStatus::SchedEventSwapFailure);
+        twes.replenishScheduler(0);
+
+        spe = twes.getEvent(0);
+        REQUIRE(spe != nullptr);
+        CHECK(spe->timestamp() == 9);
+        CHECK(spe->event_type_ == warped::EventType::NEGATIVE);
+    }
+
+    SECTION("Scheduling of an lp is paused only while no worker thread has its event") {
+
+        // An lp without events can always be paused
+        CHECK(twes.pauseScheduling(0));
+        twes.resumeScheduling(0);
+
+        std::shared_ptr<warped::Event> e5 = std::make_shared<test_Event>("a", 5);
+        twes.insertEvent(0, e5);
+
+        CHECK(twes.pauseScheduling(0));
+        CHECK(twes.getEvent(0) == nullptr);
+        twes.resumeScheduling(0);
+
+        spe = twes.getEvent(0);
+        CHECK(spe == e5);
+        CHECK(!twes.pauseScheduling(0));
+    }
+
+    SECTION("Positive events above the largest timestamp are left in the schedule queue") {
+
+        std::shared_ptr<warped::Event> e5 = std::make_shared<test_Event>("a", 5);
+        twes.insertEvent(0, e5);
+
+        bool is_stolen;
+        unsigned int held_timestamp = std::numeric_limits<unsigned int>::max();
+        spe = twes.getEvent(0, is_stolen, 4, held_timestamp);
+        CHECK(spe == nullptr);
+        CHECK(held_timestamp == 5);
+
+        // No worker thread has it, and it is taken once the largest timestamp has advanced
+        CHECK(twes.pauseScheduling(0));
+        twes.resumeScheduling(0);
+        spe = twes.getEvent(0, is_stolen, 5, held_timestamp);
+        CHECK(spe == e5);
+    }
+}
+
+TEST_CASE("Rolled back events are not annihilated while their sent events may be held") {
+
+    unsigned int num_lps = 1, num_threads = 1;
+    warped::TimeWarpEventSet twes;
+    std::vector<std::vector<warped::LogicalProcess*>> lps = {{nullptr}};
+    twes.initialize(lps, num_lps, false, num_threads, true);
+
+    std::shared_ptr<warped::Event> e5 = std::make_shared<test_Event>("a", 5);
+    std::shared_ptr<warped::Event> e9 = std::make_shared<test_Event>("a", 9);
+    twes.insertEvent(0, e5);
+    twes.insertEvent(0, e9);
+
+    // e5 is processed, then rolled back by a straggler
+    REQUIRE(twes.getEvent(0) == e5);
+    twes.replenishScheduler(0);
+    auto straggler = std::make_shared<test_Event>("a", 3);
+    twes.insertEvent(0, straggler);
+    REQUIRE(twes.getEvent(0) == straggler);
+    CHECK(twes.rollback(0, straggler) == 1);
+    twes.replenishScheduler(0);
+
+    // The anti-message of e5 has to be processed, the one of e9 which was never processed
+    // annihilates it
+    CHECK(twes.insertEvent(0, std::make_shared<test_Event>("a", 5, false)) !=
+        warped::InsertStatus::Annihilated);
+    CHECK(twes.insertEvent(0, std::make_shared<test_Event>("a", 9, false)) ==
+        warped::InsertStatus::Annihilated);
+}
+
+TEST_CASE("Idle worker threads steal events from other schedule queues") {
+
+    unsigned int num_lps = 2, num_threads = 2;
+    std::vector<std::vector<warped::LogicalProcess*>> lps = {{nullptr}, {nullptr}};
+    bool is_stolen = true;
+
+    SECTION("No stealing by default") {
+        warped::TimeWarpEventSet twes;
+        twes.initialize(lps, num_lps, false, num_threads);
+
+        twes.insertEvent(1, std::shared_ptr<warped::Event>(new test_Event {"b", 5}));
+        CHECK(twes.getEvent(0, is_stolen) == nullptr);
+        CHECK_FALSE(is_stolen);
+
+        auto spe = twes.getEvent(1, is_stolen);
+        REQUIRE(spe != nullptr);
+        CHECK(spe->timestamp() == 5);
+        CHECK_FALSE(is_stolen);
+    }
+
+    SECTION("Steal the lowest event of a sibling schedule queue") {
+        warped::TimeWarpEventSet twes(warped::ScheduleQueueType::MultiSet,
+                                      warped::WorkStealingPolicy::Neighbor);
+        twes.initialize(lps, num_lps, false, num_threads);
+
+        twes.insertEvent(1, std::shared_ptr<warped::Event>(new test_Event {"b", 5}));
+        twes.insertEvent(1, std::shared_ptr<warped::Event>(new test_Event {"b", 8}));
+
+        auto spe = twes.getEvent(0, is_stolen);
+        REQUIRE(spe != nullptr);
+        CHECK(spe->timestamp() == 5);
+        CHECK(is_stolen);
+
+        // The next event of the lp is scheduled on its own queue again
+        twes.replenishScheduler(1);
+        spe = twes.getEvent(1, is_stolen);
+        REQUIRE(spe != nullptr);
+        CHECK(spe->timestamp() == 8);
+        CHECK_FALSE(is_stolen);
+        twes.replenishScheduler(1);
+
+        CHECK(twes.getEvent(0, is_stolen) == nullptr);
+        CHECK_FALSE(is_stolen);
+    }
 }
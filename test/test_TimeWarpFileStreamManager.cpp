@@ -62,6 +62,7 @@ TEST_CASE("Get filestreams, fossil collection, rollback operate correctly for ou
 
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 5;
+            e->stampKey();
             auto t1 = twfsm.getFileStream("test_out1.txt", std::ios_base::out, 1, e);
             CHECK(t1->size() == 0);
             *t1 << "Object " << 1 << " with timestamp " << 5 << "\n";
@@ -69,36 +70,42 @@ TEST_CASE("Get filestreams, fossil collection, rollback operate correctly for ou
 
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 10;
+            e->stampKey();
             auto t2 = twfsm.getFileStream("test_out1.txt", std::ios_base::out, 1, e);
             *t2 << "Object " << 1 << " with timestamp " << 10 << "\n";
             CHECK(t2->size() == 10);
 
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 15;
+            e->stampKey();
             auto t6 = twfsm.getFileStream("test_out1.txt", std::ios_base::out, 1, e);
             *t6 << "Object " << 1 << " with timestamp " << 15 << "\n";
             CHECK(t2->size() == 15);
 
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 20;
+            e->stampKey();
             auto t7 = twfsm.getFileStream("test_out1.txt", std::ios_base::out, 1, e);
             *t7 << "Object " << 1 << " with timestamp " << 20 << "\n";
             CHECK(t2->size() == 20);
 
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 25;
+            e->stampKey();
             auto t8 = twfsm.getFileStream("test_out1.txt", std::ios_base::out, 1, e);
             *t8 << "Object " << 1 << " with timestamp " << 25 << "\n";
             CHECK(t2->size() == 25);
 
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 30;
+            e->stampKey();
             auto t9 = twfsm.getFileStream("test_out1.txt", std::ios_base::out, 1, e);
             *t9 << "Object " << 1 << " with timestamp " << 30 << "\n";
             CHECK(t2->size() == 30);
 
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 35;
+            e->stampKey();
             auto t10 = twfsm.getFileStream("test_out1.txt", std::ios_base::out, 1, e);
             *t10 << "Object " << 1 << " with timestamp " << 35 << "\n";
             CHECK(t2->size() == 35);
@@ -107,22 +114,32 @@ TEST_CASE("Get filestreams, fossil collection, rollback operate correctly for ou
                 e = std::make_shared<test_Event>();
 
                 dynamic_cast<test_Event*>(e.get())->receive_time_ = 38;
+
+                e->stampKey();
                 twfsm.rollback(e, 1);
                 CHECK(t6->size() == 35);
 
                 dynamic_cast<test_Event*>(e.get())->receive_time_ = 28;
+
+                e->stampKey();
                 twfsm.rollback(e, 1);
                 CHECK(t9->size() == 25);
 
                 dynamic_cast<test_Event*>(e.get())->receive_time_ = 22;
+
+                e->stampKey();
                 twfsm.rollback(e, 1);
                 CHECK(t10->size() == 20);
 
                 dynamic_cast<test_Event*>(e.get())->receive_time_ = 8;
+
+                e->stampKey();
                 twfsm.rollback(e, 1);
                 CHECK(t2->size() == 5);
 
                 dynamic_cast<test_Event*>(e.get())->receive_time_ = 2;
+
+                e->stampKey();
                 twfsm.rollback(e, 1);
                 CHECK(t2->size() == 0);
             }
@@ -0,0 +1,198 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <limits>
+#include <memory>
+
+#include "Event.hpp"
+#include "TimeWarpEventSet.hpp"
+#include "TimeWarpGVTManager.hpp"
+#include "mocks.hpp"
+#include "utility/warnings.hpp"
+
+// Only the reports of the worker threads, without any calculation
+class TestGVTManager : public warped::TimeWarpGVTManager {
+public:
+    TestGVTManager(unsigned int num_worker_threads) :
+        warped::TimeWarpGVTManager(nullptr, 0, num_worker_threads) {}
+
+    bool readyToStart() override { return false; }
+    void progressGVT() override {}
+    void receiveEventUpdate(const std::shared_ptr<warped::Event>& event,
+                            warped::Color color) override {
+        unused(event, color);
+    }
+    warped::Color sendEventUpdate(const std::shared_ptr<warped::Event>& event,
+                                  unsigned int thread_id) override {
+        unused(event, thread_id);
+        return warped::Color::WHITE;
+    }
+    bool gvtUpdated() override { return false; }
+    int64_t getMessageCount() override { return 0; }
+
+    using warped::TimeWarpGVTManager::startLocalReports;
+    using warped::TimeWarpGVTManager::collectLocalReports;
+};
+
+TEST_CASE("Worker threads report their local minimums once per epoch") {
+
+    unsigned int num_threads = 2;
+    TestGVTManager gvt_manager(num_threads);
+    gvt_manager.initialize();
+    unsigned int local_min;
+    const unsigned int infinity = std::numeric_limits<unsigned int>::max();
+
+    // No epoch has started, so nothing is reported
+    CHECK(gvt_manager.getLocalGVTFlag() == 0);
+    gvt_manager.reportThreadMin(1, 0, gvt_manager.getLocalGVTFlag());
+
+    SECTION("The epoch ends once every thread has reported") {
+        gvt_manager.startLocalReports();
+        auto local_gvt_flag = gvt_manager.getLocalGVTFlag();
+        CHECK(local_gvt_flag != 0);
+
+        gvt_manager.reportThreadMin(20, 0, local_gvt_flag);
+        CHECK(!gvt_manager.collectLocalReports(local_min));
+
+        // A second report of the same thread is ignored
+        gvt_manager.reportThreadMin(5, 0, local_gvt_flag);
+        CHECK(!gvt_manager.collectLocalReports(local_min));
+
+        gvt_manager.reportThreadMin(30, 1, local_gvt_flag);
+        REQUIRE(gvt_manager.collectLocalReports(local_min));
+        CHECK(local_min == 20);
+        CHECK(gvt_manager.getLocalGVTFlag() == 0);
+    }
+
+    SECTION("A flag read in an earlier epoch is stale") {
+        gvt_manager.startLocalReports();
+        auto stale_flag = gvt_manager.getLocalGVTFlag();
+        gvt_manager.reportThreadMin(20, 0, stale_flag);
+        gvt_manager.reportThreadMin(30, 1, stale_flag);
+        REQUIRE(gvt_manager.collectLocalReports(local_min));
+
+        gvt_manager.startLocalReports();
+        auto local_gvt_flag = gvt_manager.getLocalGVTFlag();
+        CHECK(local_gvt_flag != stale_flag);
+
+        gvt_manager.reportThreadMin(10, 0, stale_flag);
+        gvt_manager.reportThreadMin(10, 1, stale_flag);
+        CHECK(!gvt_manager.collectLocalReports(local_min));
+
+        gvt_manager.reportThreadMin(40, 0, local_gvt_flag);
+        gvt_manager.reportThreadMin(50, 1, local_gvt_flag);
+        REQUIRE(gvt_manager.collectLocalReports(local_min));
+        CHECK(local_min == 40);
+    }
+
+    SECTION("Events sent before the report are included in it") {
+        gvt_manager.startLocalReports();
+        gvt_manager.reportThreadSendMin(2, 0);
+        gvt_manager.reportThreadMin(20, 0, gvt_manager.getLocalGVTFlag());
+        gvt_manager.reportThreadMin(30, 1, gvt_manager.getLocalGVTFlag());
+        REQUIRE(gvt_manager.collectLocalReports(local_min));
+        CHECK(local_min == 2);
+
+        // The send of the earlier epoch no longer counts
+        gvt_manager.startLocalReports();
+        auto local_gvt_flag = gvt_manager.getLocalGVTFlag();
+        gvt_manager.reportThreadSendMin(15, 0);
+        gvt_manager.reportThreadSendMin(12, 0);
+        gvt_manager.reportThreadMin(20, 0, local_gvt_flag);
+
+        // Sends after the report, or by a thread which is not a worker thread, do not count
+        gvt_manager.reportThreadSendMin(1, 0);
+        gvt_manager.reportThreadSendMin(1, num_threads);
+
+        gvt_manager.reportThreadMin(30, 1, local_gvt_flag);
+        REQUIRE(gvt_manager.collectLocalReports(local_min));
+        CHECK(local_min == 12);
+    }
+
+    SECTION("An idle thread reports infinity") {
+        gvt_manager.startLocalReports();
+        auto local_gvt_flag = gvt_manager.getLocalGVTFlag();
+        gvt_manager.reportThreadMin(infinity, 0, local_gvt_flag);
+        gvt_manager.reportThreadMin(25, 1, local_gvt_flag);
+        REQUIRE(gvt_manager.collectLocalReports(local_min));
+        CHECK(local_min == 25);
+
+        gvt_manager.startLocalReports();
+        local_gvt_flag = gvt_manager.getLocalGVTFlag();
+        gvt_manager.reportThreadMin(infinity, 0, local_gvt_flag);
+        gvt_manager.reportThreadMin(infinity, 1, local_gvt_flag);
+        REQUIRE(gvt_manager.collectLocalReports(local_min));
+        CHECK(local_min == infinity);
+    }
+}
+
+TEST_CASE("An event taken out of the schedule queue is reported by the thread which took it") {
+
+    // Two lps on a single schedule queue, processed by two worker threads
+    unsigned int num_lps = 2, num_threads = 2;
+    warped::TimeWarpEventSet twes;
+    std::vector<std::vector<warped::LogicalProcess*>> lps = {{nullptr, nullptr}};
+    twes.initialize(lps, num_lps, false, num_threads);
+
+    auto e5 = std::make_shared<test_Event>("a", 5);
+    auto e10 = std::make_shared<test_Event>("b", 10);
+    twes.insertEvent(0, e5);
+    twes.insertEvent(1, e10);
+
+    TestGVTManager gvt_manager(num_threads);
+    gvt_manager.initialize();
+    unsigned int local_min;
+
+    SECTION("The other thread reports a minimum while the lp is paused") {
+        gvt_manager.startLocalReports();
+
+        // Thread 0 claims lp 0 before it has reported
+        REQUIRE(gvt_manager.reportThreadClaimMin(e5->timestamp(), 0));
+        REQUIRE(twes.pauseScheduling(0));
+
+        // Thread 1 only sees the event of lp 1
+        auto local_gvt_flag = gvt_manager.getLocalGVTFlag();
+        auto event = twes.getEvent(1);
+        REQUIRE(event == e10);
+        gvt_manager.reportThreadMin(event->timestamp(), 1, local_gvt_flag);
+
+        twes.resumeScheduling(0);
+        gvt_manager.reportThreadSendMin(e5->timestamp(), 0);
+
+        // Thread 0 finds no event in its next pass
+        gvt_manager.reportThreadMin(std::numeric_limits<unsigned int>::max(), 0,
+            gvt_manager.getLocalGVTFlag());
+
+        REQUIRE(gvt_manager.collectLocalReports(local_min));
+        CHECK(local_min == 5);
+    }
+
+    SECTION("The epoch starts while the lp is paused") {
+        REQUIRE(gvt_manager.reportThreadClaimMin(e5->timestamp(), 0));
+        REQUIRE(twes.pauseScheduling(0));
+
+        gvt_manager.startLocalReports();
+
+        auto local_gvt_flag = gvt_manager.getLocalGVTFlag();
+        auto event = twes.getEvent(1);
+        REQUIRE(event == e10);
+        gvt_manager.reportThreadMin(event->timestamp(), 1, local_gvt_flag);
+
+        twes.resumeScheduling(0);
+        gvt_manager.reportThreadSendMin(e5->timestamp(), 0);
+
+        gvt_manager.reportThreadMin(std::numeric_limits<unsigned int>::max(), 0,
+            gvt_manager.getLocalGVTFlag());
+
+        REQUIRE(gvt_manager.collectLocalReports(local_min));
+        CHECK(local_min == 5);
+    }
+
+    SECTION("A thread which has already reported cannot claim an lp") {
+        gvt_manager.startLocalReports();
+        gvt_manager.reportThreadMin(20, 0, gvt_manager.getLocalGVTFlag());
+
+        CHECK(!gvt_manager.reportThreadClaimMin(e5->timestamp(), 0));
+        CHECK(gvt_manager.reportThreadClaimMin(e5->timestamp(), 1));
+    }
+}
@@ -0,0 +1,118 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include <memory>
+
+#include "TimeWarpIncrementalStateManager.hpp"
+#include "mocks.hpp"
+
+WARPED_DEFINE_LP_STATE_STRUCT(incremental_LPState) {
+    struct {
+        int counts[64];
+        double total;
+    } data;
+
+    void* incrementalStateData(std::size_t& size) override {
+        size = sizeof(data);
+        return &data;
+    }
+};
+
+class incremental_LogicalProcess : public warped::LogicalProcess {
+public:
+    incremental_LogicalProcess(const std::string& name) : LogicalProcess(name), state() {
+        for (auto& c : state.data.counts) c = 0;
+        state.data.total = 0;
+    }
+
+    warped::LPState& getState() { return state; }
+
+    std::vector<std::shared_ptr<warped::Event>> receiveEvent(const warped::Event&) {
+        return {};
+    }
+
+    incremental_LPState state;
+};
+
+namespace {
+
+std::shared_ptr<warped::Event> makeTestEvent(unsigned int timestamp) {
+    return std::make_shared<test_Event>("lp", timestamp);
+}
+
+} // anonymous namespace
+
+TEST_CASE("Incremental states saved and restored correctly", "[state][incremental]") {
+    unsigned int period = 1;
+    warped::TimeWarpIncrementalStateManager sm(period);
+    sm.initialize(1);
+
+    incremental_LogicalProcess lp("lp");
+    auto& data = lp.state.data;
+
+    // Each event changes one count at a different place in the state
+    for (unsigned int ts = 10; ts <= 60; ts += 10) {
+        data.counts[ts / 2]++;
+        data.total += ts;
+        sm.saveState(makeTestEvent(ts), 0, &lp);
+    }
+    REQUIRE(sm.size(0) == 6);
+
+    SECTION("State can be restored on rollback") {
+        auto restored_state_event = sm.restoreState(makeTestEvent(35), 0, &lp);
+        REQUIRE(sm.size(0) == 3);
+        REQUIRE(restored_state_event->timestamp() == 30);
+        CHECK(data.counts[5] == 1);
+        CHECK(data.counts[10] == 1);
+        CHECK(data.counts[15] == 1);
+        CHECK(data.counts[20] == 0);
+        CHECK(data.counts[30] == 0);
+        CHECK(data.total == 60);
+
+        SECTION("Saving and restoring continue from the restored state") {
+            data.counts[0] = 7;
+            sm.saveState(makeTestEvent(36), 0, &lp);
+            data.counts[0] = 8;
+            data.counts[63] = 9;
+
+            restored_state_event = sm.restoreState(makeTestEvent(36), 0, &lp);
+            REQUIRE(restored_state_event->timestamp() == 30);
+            CHECK(data.counts[0] == 0);
+            CHECK(data.counts[63] == 0);
+            CHECK(data.counts[15] == 1);
+            CHECK(data.total == 60);
+        }
+    }
+
+    SECTION("Rollback after fossil collection") {
+        sm.fossilCollect(45, 0);
+        REQUIRE(sm.size(0) == 3);
+
+        auto restored_state_event = sm.restoreState(makeTestEvent(45), 0, &lp);
+        REQUIRE(sm.size(0) == 1);
+        REQUIRE(restored_state_event->timestamp() == 40);
+        CHECK(data.counts[20] == 1);
+        CHECK(data.counts[25] == 0);
+        CHECK(data.total == 100);
+    }
+}
+
+TEST_CASE("States without the hook are saved as full copies", "[state][incremental]") {
+    warped::TimeWarpIncrementalStateManager sm(1);
+    sm.initialize(1);
+
+    test_LogicalProcess lp("test_lp", 50);
+    auto& state = static_cast<test_LPState&>(lp.getState());
+
+    sm.saveState(makeTestEvent(15), 0, &lp);
+    state.x = 60;
+    *state.y = 10;
+    sm.saveState(makeTestEvent(30), 0, &lp);
+    REQUIRE(sm.size(0) == 2);
+
+    auto restored_state_event = sm.restoreState(makeTestEvent(26), 0, &lp);
+    REQUIRE(sm.size(0) == 1);
+    REQUIRE(restored_state_event->timestamp() == 15);
+    CHECK(state.x == 50);
+    CHECK(*state.y == 0);
+}
@@ -0,0 +1,123 @@
+#define CATCH_CONFIG_MAIN  // This tells Catch to provide a main()
+#include "catch.hpp"
+
+#include "EventPool.hpp"
+#include "TimeWarpLazyOutputManager.hpp"
+#include "mocks.hpp"
+#include "utility/memory.hpp"
+
+TEST_CASE("Lazy output manager holds events back on rollback", "[output][queues][lazy]") {
+    unsigned int num_objects = 4;
+    warped::TimeWarpLazyOutputManager om;
+    om.initialize(num_objects);
+
+    auto input1 = std::make_shared<test_Event>("receiver_name", 33);
+    auto input2 = std::make_shared<test_Event>("receiver_name", 40);
+    auto input3 = std::make_shared<test_Event>("receiver_name", 45);
+
+    om.insertEvent(std::make_shared<test_Event>("receiver_name", 27), std::make_shared<test_Event>("receiver_name", 30), 2);
+    om.insertEvent(input1, std::make_shared<test_Event>("receiver_name", 35), 2);
+    om.insertEvent(input1, std::make_shared<test_Event>("receiver_name", 38), 2);
+    om.insertEvent(input2, std::make_shared<test_Event>("receiver_name", 43), 2);
+    om.insertEvent(input3, std::make_shared<test_Event>("receiver_name", 48), 2);
+    REQUIRE(om.size(2) == 5);
+
+    std::shared_ptr<warped::Event> straggler = std::make_shared<test_Event>("receiver_name", 32);
+    auto events_to_cancel = om.rollback(straggler, 2);
+    REQUIRE(events_to_cancel->empty());
+    CHECK(om.size(2) == 1);
+    CHECK(om.heldSize(2) == 4);
+
+    SECTION("Regenerated events are not sent again", "[output][queue][lazy]") {
+        std::shared_ptr<warped::Event> e = std::make_shared<test_Event>("receiver_name", 38);
+        CHECK(om.isRegenerated(input1, e, 2));
+        CHECK(om.size(2) == 2);
+        CHECK(om.heldSize(2) == 3);
+
+        // Already taken from the held events
+        CHECK_FALSE(om.isRegenerated(input1, e, 2));
+
+        // Different contents or input events are not regenerated
+        e = std::make_shared<test_Event>("other_name", 35);
+        CHECK_FALSE(om.isRegenerated(input1, e, 2));
+        e = std::make_shared<test_Event>("receiver_name", 43);
+        CHECK_FALSE(om.isRegenerated(input1, e, 2));
+        CHECK(om.heldSize(2) == 3);
+
+        SECTION("Events not regenerated are cancelled after their input event", "[output][queue][lazy]") {
+            auto events = om.eventsNotRegenerated(input1, 2);
+            REQUIRE(events != nullptr);
+            REQUIRE(events->size() == 1);
+            CHECK(events->front()->timestamp() == 35);
+            CHECK(om.heldSize(2) == 2);
+            CHECK(om.numComparedEvents(2) == 2);
+            CHECK(om.numRegeneratedEvents(2) == 1);
+
+            CHECK(om.eventsNotRegenerated(input1, 2) == nullptr);
+        }
+    }
+
+    SECTION("Events are cancelled up to the processed event", "[output][queue][lazy]") {
+        auto events = om.eventsNotRegenerated(input2, 2);
+        REQUIRE(events != nullptr);
+        REQUIRE(events->size() == 3);
+        CHECK(events->at(0)->timestamp() == 43);
+        CHECK(events->at(1)->timestamp() == 38);
+        CHECK(events->at(2)->timestamp() == 35);
+        CHECK(om.heldSize(2) == 1);
+    }
+
+    SECTION("A cancelled input event only cancels the events it sent", "[output][queue][lazy]") {
+        auto anti_message = warped::makeEvent<warped::NegativeEvent>(input2);
+        auto events = om.eventsSentByCancelledEvent(anti_message, 2);
+        REQUIRE(events != nullptr);
+        REQUIRE(events->size() == 1);
+        CHECK(events->front()->timestamp() == 43);
+        CHECK(om.heldSize(2) == 3);
+        CHECK(om.eventsSentByCancelledEvent(anti_message, 2) == nullptr);
+
+        // Never compared, so not a miss
+        CHECK(om.numComparedEvents(2) == 0);
+
+        // The events of the earlier input event can still be regenerated
+        std::shared_ptr<warped::Event> e = std::make_shared<test_Event>("receiver_name", 35);
+        CHECK(om.isRegenerated(input1, e, 2));
+
+        events = om.eventsSentByCancelledEvent(input1, 2);
+        REQUIRE(events != nullptr);
+        REQUIRE(events->size() == 1);
+        CHECK(events->front()->timestamp() == 38);
+        CHECK(om.heldSize(2) == 1);
+    }
+
+    SECTION("Events of the same size and timestamp are compared by their contents",
+            "[output][queue][lazy]") {
+        std::shared_ptr<warped::Event> e = std::make_shared<test_Event>("receiver_nama", 35);
+        CHECK_FALSE(om.isRegenerated(input1, e, 2));
+        e = std::make_shared<test_Event>("receiver_name", 35);
+        CHECK(om.isRegenerated(input1, e, 2));
+    }
+
+    SECTION("A second rollback holds events in front of those still held", "[output][queue][lazy]") {
+        std::shared_ptr<warped::Event> e = std::make_shared<test_Event>("receiver_name", 38);
+        CHECK(om.isRegenerated(input1, e, 2));
+        CHECK(om.size(2) == 2);
+
+        events_to_cancel = om.rollback(straggler, 2);
+        CHECK(events_to_cancel->empty());
+        CHECK(om.size(2) == 1);
+        CHECK(om.heldSize(2) == 4);
+
+        auto events = om.eventsNotRegenerated(input3, 2);
+        REQUIRE(events != nullptr);
+        CHECK(events->size() == 4);
+        CHECK(events->front()->timestamp() == 48);
+        CHECK(om.heldSize(2) == 0);
+    }
+
+    SECTION("Fossil collection leaves held events alone", "[output][queue][fossilCollection]") {
+        om.fossilCollect(35, 2);
+        CHECK(om.size(2) == 0);
+        CHECK(om.heldSize(2) == 4);
+    }
+}
@@ -27,6 +27,7 @@ TEST_CASE("States saved and restored correctly", "[state][queue]") {
         static_cast<test_LPState&>(lp->getState()).x++; // 51
         e = std::make_shared<test_Event>();
         dynamic_cast<test_Event*>(e.get())->receive_time_ = 15;
+        e->stampKey();
         sm.saveState(e, 3, lp); // timestamp 15
         REQUIRE(sm.size(3) == 1);   // Saved
 
@@ -34,48 +35,56 @@ TEST_CASE("States saved and restored correctly", "[state][queue]") {
             static_cast<test_LPState&>(lp->getState()).x++; // 52
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 20;
+            e->stampKey();
             sm.saveState(e, 3, lp); // timestamp 20
             REQUIRE(sm.size(3) == 1); // Not saved
 
             static_cast<test_LPState&>(lp->getState()).x++; // 53
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 25;
+            e->stampKey();
             sm.saveState(e, 3, lp); // timestamp 25
             REQUIRE(sm.size(3) == 2); // Saved
 
             static_cast<test_LPState&>(lp->getState()).x++; // 54
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 25;
+            e->stampKey();
             sm.saveState(e, 3, lp); // timestamp 25
             REQUIRE(sm.size(3) == 2); // Not saved
 
             static_cast<test_LPState&>(lp->getState()).x++; // 55
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 25;
+            e->stampKey();
             sm.saveState(e, 3, lp); // timestamp 25
             REQUIRE(sm.size(3) == 3); // Saved
 
             static_cast<test_LPState&>(lp->getState()).x++; // 56
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 30;
+            e->stampKey();
             sm.saveState(e, 3, lp); // timestamp 30
             REQUIRE(sm.size(3) == 3); // Not saved
 
             static_cast<test_LPState&>(lp->getState()).x++; // 57
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 33;
+            e->stampKey();
             sm.saveState(e, 3, lp); // timestamp 33
             REQUIRE(sm.size(3) == 4); // Saved
 
             static_cast<test_LPState&>(lp->getState()).x++; // 58
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 35;
+            e->stampKey();
             sm.saveState(e, 3, lp); // timestamp 35
             REQUIRE(sm.size(3) == 4); // Not saved
 
             static_cast<test_LPState&>(lp->getState()).x++; // 59
             e = std::make_shared<test_Event>();
             dynamic_cast<test_Event*>(e.get())->receive_time_ = 37;
+            e->stampKey();
             sm.saveState(e, 3, lp); // timestamp 37
             REQUIRE(sm.size(3) == 5); // Saved
 
@@ -88,6 +97,7 @@ TEST_CASE("States saved and restored correctly", "[state][queue]") {
                 REQUIRE(sm.size(3) == 5);
                 e = std::make_shared<test_Event>();
                 dynamic_cast<test_Event*>(e.get())->receive_time_ = 26;
+                e->stampKey();
                 std::shared_ptr<warped::Event> restored_state_event = sm.restoreState(e, 3, lp);
                 REQUIRE(sm.size(3) == 3);
                 REQUIRE(restored_state_event->timestamp() == 25);
@@ -110,12 +120,14 @@ TEST_CASE("States with shared_ptr saved and restored correctly", "[state][queue]
     *(static_cast<test_LPState&>(lp->getState()).y) = 5;
     e = std::make_shared<test_Event>();
     dynamic_cast<test_Event*>(e.get())->receive_time_ = 15;
+    e->stampKey();
     sm.saveState(e, 0, lp); // timestamp 15
     REQUIRE(sm.size(0) == 1);   // Saved
 
     *(static_cast<test_LPState&>(lp->getState()).y) = 10;
     e = std::make_shared<test_Event>();
     dynamic_cast<test_Event*>(e.get())->receive_time_ = 30;
+    e->stampKey();
     sm.saveState(e, 0, lp); // timestamp 30
     REQUIRE(sm.size(0) == 2);   // Saved
 
@@ -123,6 +135,7 @@ TEST_CASE("States with shared_ptr saved and restored correctly", "[state][queue]
         REQUIRE(sm.size(0) == 2);
         e = std::make_shared<test_Event>();
         dynamic_cast<test_Event*>(e.get())->receive_time_ = 26;
+        e->stampKey();
         std::shared_ptr<warped::Event> restored_state_event = sm.restoreState(e, 0, lp);
         REQUIRE(sm.size(0) == 1);
         REQUIRE(restored_state_event->timestamp() == 15);
@@ -144,6 +157,7 @@ TEST_CASE("States with maps saved and restored correctly", "[state][queue][map]"
     static_cast<test_LPState&>(lp->getState()).a_map->insert(std::pair<unsigned int, std::shared_ptr<enum_type>>(1, val1));
     e = std::make_shared<test_Event>();
     dynamic_cast<test_Event*>(e.get())->receive_time_ = 15;
+    e->stampKey();
     sm.saveState(e, 0, lp); // timestamp 15
     REQUIRE(sm.size(0) == 1);   // Saved
 
@@ -151,6 +165,7 @@ TEST_CASE("States with maps saved and restored correctly", "[state][queue][map]"
     static_cast<test_LPState&>(lp->getState()).a_map->insert(std::pair<unsigned int, std::shared_ptr<enum_type>>(2, val2));
     e = std::make_shared<test_Event>();
     dynamic_cast<test_Event*>(e.get())->receive_time_ = 30;
+    e->stampKey();
     sm.saveState(e, 0, lp); // timestamp 30
     REQUIRE(sm.size(0) == 2);   // Saved
 
@@ -162,6 +177,7 @@ TEST_CASE("States with maps saved and restored correctly", "[state][queue][map]"
 
         e = std::make_shared<test_Event>();
         dynamic_cast<test_Event*>(e.get())->receive_time_ = 26;
+        e->stampKey();
         std::shared_ptr<warped::Event> restored_state_event = sm.restoreState(e, 0, lp);
 
         REQUIRE(sm.size(0) == 1);
@@ -172,3 +188,49 @@ TEST_CASE("States with maps saved and restored correctly", "[state][queue][map]"
     }
 }
 
+
+TEST_CASE("Adaptive period follows the rollback behavior of the lp", "[state][adaptive]") {
+    unsigned int period = 2;
+    unsigned int max_period = 16;
+    warped::TimeWarpPeriodicStateManager sm(period, true, max_period);
+    sm.initialize(1);
+    warped::LogicalProcess *lp = new test_LogicalProcess("test_lp", 50);
+    unsigned int timestamp = 0;
+
+    auto processEvents = [&](unsigned int num_events, bool rollback) {
+        for (unsigned int i = 0; i < num_events; i++) {
+            auto e = std::make_shared<test_Event>("test_lp", ++timestamp);
+            sm.saveState(e, 0, lp);
+            if (rollback) {
+                // Coasting forward is far more expensive than saving a state
+                sm.coastForwardDone(0, 4, 1000000000);
+            }
+        }
+    };
+
+    REQUIRE(sm.checkpointInterval(0) == 2);
+
+    SECTION("Period grows while there are no rollbacks") {
+        processEvents(256, false);
+        REQUIRE(sm.checkpointInterval(0) == 4);
+        processEvents(128, false);
+        REQUIRE(sm.checkpointInterval(0) == 8);
+        processEvents(128*4, false);
+        REQUIRE(sm.checkpointInterval(0) == max_period);
+
+        SECTION("Period shrinks when coasting forward becomes expensive") {
+            processEvents(128, true);
+            REQUIRE(sm.checkpointInterval(0) == 8);
+            processEvents(128*8, true);
+            REQUIRE(sm.checkpointInterval(0) == 1);
+        }
+    }
+}
+
+TEST_CASE("Fixed period is reported as the checkpoint interval", "[state]") {
+    warped::TimeWarpPeriodicStateManager sm(7);
+    sm.initialize(2);
+    sm.coastForwardDone(1, 3, 1000);
+    REQUIRE(sm.checkpointInterval(0) == 7);
+    REQUIRE(sm.checkpointInterval(1) == 7);
+}
@@ -0,0 +1,113 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <memory>
+#include <vector>
+
+#include "TimeWarpCommunicationManager.hpp"
+#include "TimeWarpTerminationManager.hpp"
+#include "utility/memory.hpp"
+
+// Keeps the messages sent instead of sending them
+class TestCommunicationManager : public warped::TimeWarpCommunicationManager {
+public:
+    TestCommunicationManager(unsigned int num_processes, unsigned int id) :
+        num_processes_(num_processes), id_(id) {}
+
+    unsigned int initialize() override { return num_processes_; }
+    void finalize() override {}
+    unsigned int getNumProcesses() override { return num_processes_; }
+    unsigned int getID() override { return id_; }
+    int waitForAllProcesses() override { return 0; }
+    int sumReduceUint64(uint64_t*, uint64_t*) override { return 0; }
+    int gatherUint64(uint64_t*, uint64_t*) override { return 0; }
+    int sumAllReduceInt64(int64_t*, int64_t*) override { return 0; }
+    int minAllReduceUint(unsigned int*, unsigned int*) override { return 0; }
+    void startAllReduce(unsigned int*, unsigned int*, int64_t*, int64_t*) override {}
+    bool testAllReduce() override { return true; }
+    void insertMessage(std::unique_ptr<warped::TimeWarpKernelMessage> msg) override {
+        sent_.push_back(std::move(msg));
+    }
+    void handleMessages() override {}
+    void flushMessages() override {}
+    void startMessageThread(std::function<void()>) override {}
+    void stopMessageThread() override {}
+    void reportStraggler(unsigned int) override {}
+    uint64_t numAggregatesSent() override { return 0; }
+    uint64_t numAggregatedMessages() override { return 0; }
+
+    std::vector<std::unique_ptr<warped::TimeWarpKernelMessage>> sent_;
+
+private:
+    unsigned int num_processes_;
+    unsigned int id_;
+};
+
+// Token sent last, or nullptr if the last message sent is not a token
+warped::TerminationToken* lastToken(TestCommunicationManager& comm_manager) {
+    if (comm_manager.sent_.empty() ||
+            (comm_manager.sent_.back()->get_type() != warped::MessageType::TerminationToken)) {
+        return nullptr;
+    }
+    return static_cast<warped::TerminationToken*>(comm_manager.sent_.back().get());
+}
+
+unsigned int numTerminators(TestCommunicationManager& comm_manager) {
+    unsigned int count = 0;
+    for (auto& msg : comm_manager.sent_) {
+        count += (msg->get_type() == warped::MessageType::Terminator);
+    }
+    return count;
+}
+
+std::unique_ptr<warped::TimeWarpKernelMessage> token(unsigned int initiator, int count) {
+    return warped::make_unique<warped::TerminationToken>(1, 0, warped::State::PASSIVE, initiator,
+        count);
+}
+
+TEST_CASE("A token which arrives while a message is in transit does not terminate") {
+
+    auto comm_manager = std::make_shared<TestCommunicationManager>(2, 0);
+    warped::TimeWarpTerminationManager tm(comm_manager);
+    tm.initialize(1);
+
+    // The worker thread sent a message to the other node and became passive
+    tm.updateMsgCount(1);
+    tm.setThreadPassive(0, tm.numReceived());
+    REQUIRE(tm.nodePassive());
+
+    REQUIRE(tm.sendTerminationToken(warped::State::PASSIVE, 0, 0));
+    REQUIRE(lastToken(*comm_manager) != nullptr);
+    CHECK(lastToken(*comm_manager)->count_ == 1);
+
+    // The first round only makes the sticky state passive. The message is still in transit, so
+    // its count must be kept for the next token.
+    tm.receiveTerminationToken(token(0, 1));
+    REQUIRE(tm.sendTerminationToken(warped::State::PASSIVE, 0, 0));
+    CHECK(lastToken(*comm_manager)->count_ == 1);
+
+    // The token has circulated twice, but the message has not been received yet
+    tm.receiveTerminationToken(token(0, 1));
+    CHECK(numTerminators(*comm_manager) == 0);
+
+    // Once the other node has received the message, the counts add up to zero
+    REQUIRE(tm.sendTerminationToken(warped::State::PASSIVE, 0, 0));
+    CHECK(lastToken(*comm_manager)->count_ == 1);
+    tm.receiveTerminationToken(token(0, 0));
+    CHECK(numTerminators(*comm_manager) == 2);
+}
+
+TEST_CASE("A message received after a thread looked for events keeps the node active") {
+
+    auto comm_manager = std::make_shared<TestCommunicationManager>(1, 0);
+    warped::TimeWarpTerminationManager tm(comm_manager);
+    tm.initialize(1);
+
+    auto num_received = tm.numReceived();
+    tm.updateMsgCount(-1);
+    tm.setThreadPassive(0, num_received);
+    CHECK(!tm.nodePassive());
+
+    tm.setThreadPassive(0, tm.numReceived());
+    CHECK(tm.nodePassive());
+}
@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "serialization.hpp"
+#include "utility/streambuf.hpp"
 
 struct Class1 {
     Class1(int x=1, int y=2): x(x), y(y) {}
@@ -63,4 +64,47 @@ TEST_CASE("Polymorphic Objects can be serialized", "[serialization]") {
         iarchive(c2);
     }
     REQUIRE(c2->f() == 2);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Objects can be serialized in place in a memory buffer", "[serialization]") {
+    char buffer[64];
+    Class1 c1 {3, 4};
+    Class1 c2 {5, 6};
+    Class1 c3;
+
+    warped::MemoryOutputBuffer output(buffer, sizeof(buffer));
+    {
+        std::ostream os(&output);
+        cereal::BinaryOutputArchive oarchive(os);
+        oarchive(c1, c2);
+        REQUIRE(os);
+    }
+    REQUIRE(output.size() == 4*sizeof(int));
+
+    warped::MemoryInputBuffer input(buffer, output.size());
+    {
+        std::istream is(&input);
+        cereal::BinaryInputArchive iarchive(is);
+        iarchive(c3);
+        REQUIRE(c3.x == 3);
+        REQUIRE(c3.y == 4);
+        REQUIRE(input.position() == 2*sizeof(int));
+        iarchive(c3);
+        REQUIRE(c3.x == 5);
+        REQUIRE(c3.y == 6);
+    }
+
+    SECTION("Writes past the end of the buffer are counted but dropped") {
+        int x[2] = {0, 0};
+        warped::MemoryOutputBuffer small(reinterpret_cast<char*>(x), sizeof(int));
+        std::ostream os(&small);
+        os.write(reinterpret_cast<const char*>(&c1.x), sizeof(int));
+        REQUIRE(!small.overflowed());
+        os.write(reinterpret_cast<const char*>(&c1.y), sizeof(int));
+        REQUIRE(os);
+        REQUIRE(small.overflowed());
+        REQUIRE(small.size() == 2*sizeof(int));
+        REQUIRE(x[0] == 3);
+        REQUIRE(x[1] == 0);
+    }
+}